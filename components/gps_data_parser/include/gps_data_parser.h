@@ -13,10 +13,24 @@
 #ifndef GPS_DATA_PARSER_H
 #define GPS_DATA_PARSER_H
 
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Define USE_FEET_UNIT as 1 to convert altitude,Geoid separation to feet, or 0 to use meters
 #define USE_FEET_UNIT 0
+
+// Hours added to the UTC time of day in gps_time_t (Pakistan Time UTC +05), the hour wraps past 23.
+// utc_ms is always UTC.
+#ifndef TIME_ZONE
+#define TIME_ZONE 5
+#endif
+
+// Define GPS_PARSER_LOG_ENABLED as 1 to log rejected sentences (ESP_LOG on ESP-IDF, stderr on a host build),
+// 0 keeps all formatted I/O out of the parse path
+#ifndef GPS_PARSER_LOG_ENABLED
+#define GPS_PARSER_LOG_ENABLED 0
+#endif
  
 
 /**
@@ -29,6 +43,16 @@ typedef struct {
     uint16_t millisecond; // Thousandth's of a second (000-999) 
 } gps_time_t;
 
+/**
+ * @brief Local monotonic times at which the first ('$') and last (LF) bytes of a sentence were received.
+ *
+ * Microseconds on the caller's clock, e.g. esp_timer_get_time(), both 0 when unknown.
+ */
+typedef struct {
+    int64_t first_us;
+    int64_t last_us;
+} gps_rx_time_t;
+
 /**
  * @brief Structure to store parsed GPS data.
  *
@@ -82,6 +106,31 @@ typedef struct {
     // Differential reference station ID (numeric), range from 0 to 1023
     int dgps_station_id;
 
+    // Fixed-point values, decoded exactly from the ASCII digits when GPS_DECODE_FIXED_POINT is set.
+    // They always use metres, whatever USE_FEET_UNIT is.
+
+    // Latitude in 1e-7 degrees, negative south
+    int32_t latitude_e7;
+
+    // Longitude in 1e-7 degrees, negative west
+    int32_t longitude_e7;
+
+    // Altitude above sea level in millimetres
+    int32_t altitude_mm;
+
+    // Geoid separation in millimetres
+    int32_t geoid_height_mm;
+
+    // Horizontal Dilution of Precision in hundredths
+    uint16_t hdop_x100;
+
+    // UTC time in milliseconds since 1970-01-01, dated by the last RMC sentence decoded with the
+    // same parser context (DEFAULT_UTC_MS until one was decoded)
+    int64_t utc_ms;
+
+    // Receive times of the sentence, copied from gps_parser_ctx_t.rx_time
+    gps_rx_time_t rx_time;
+
 } gps_data_parse_t;
 
 // Set default values when correct data or invalid format or missing
@@ -102,16 +151,227 @@ typedef struct {
 #define DEFAULT_GEOID_HEIGHT_UNITS '-'
 #define DEFAULT_DGPS_AGE        -1
 #define DEFAULT_DGPS_STATION_ID -1
+#define DEFAULT_LATITUDE_E7     INT32_MAX
+#define DEFAULT_LONGITUDE_E7    INT32_MAX
+#define DEFAULT_ALTITUDE_MM     INT32_MIN
+#define DEFAULT_GEOID_HEIGHT_MM INT32_MIN
+#define DEFAULT_HDOP_X100       UINT16_MAX
+#define DEFAULT_UTC_MS          INT64_MIN
+
+// Decode modes of a parser context (gps_parser_ctx_t.decode_flags), they can be combined
+#define GPS_DECODE_FLOAT        (1u << 0)  // fill the float members using strtof (default)
+#define GPS_DECODE_FIXED_POINT  (1u << 1)  // fill the fixed-point members with integer arithmetic only
+
+// GGA field groups (gps_parser_ctx_t.gga_fields), each one decoded as a unit (a value together with its direction or unit field)
+#define GPS_GGA_FIELD_TIME          (1u << 0)  // time
+#define GPS_GGA_FIELD_LATITUDE      (1u << 1)  // latitude, lat_direction
+#define GPS_GGA_FIELD_LONGITUDE     (1u << 2)  // longitude, lon_direction
+#define GPS_GGA_FIELD_FIX_QUALITY   (1u << 3)  // fix_quality
+#define GPS_GGA_FIELD_SATELLITES    (1u << 4)  // num_satellites
+#define GPS_GGA_FIELD_HDOP          (1u << 5)  // hdop
+#define GPS_GGA_FIELD_ALTITUDE      (1u << 6)  // altitude, altitude_units
+#define GPS_GGA_FIELD_GEOID_HEIGHT  (1u << 7)  // geoid_height, geoid_height_units
+#define GPS_GGA_FIELD_DGPS          (1u << 8)  // dgps_age, dgps_station_id
+#define GPS_GGA_FIELD_ALL           ((1u << 9) - 1)
 
 typedef gps_data_parse_t*  gps_gga_handle_t;// create gps handle variable for gga sentence
 
+// Longest NMEA sentence accepted, from '$' up to the checksum digits (excluding CRLF).
+// NMEA 0183 allows 82 characters, some high precision receivers emit longer GGA sentences.
+#ifndef GPS_NMEA_MAX_SENTENCE_LEN
+#define GPS_NMEA_MAX_SENTENCE_LEN 128
+#endif
+#if GPS_NMEA_MAX_SENTENCE_LEN > 255
+#error "GPS_NMEA_MAX_SENTENCE_LEN must fit the 8-bit field offsets of gps_parser_ctx_t"
+#endif
+
+#define GGA_FIELD_COUNT 15 // Number of fields in a GGA sentence including the sentence identifier
+#define GPS_NMEA_MAX_FIELDS 24 // Most fields stored for one sentence (GSV and GSA have up to 21)
+
+/**
+ * @brief Counters of a parser context, see gps_parser_stats_snapshot().
+ */
+typedef enum {
+    GPS_STAT_BYTES = 0,             // raw bytes consumed: gps_data_parse(), gps_nmea_parse_next() / _batch() and attached streams
+    GPS_STAT_UNSUPPORTED,           // sentences with a valid checksum and an unsupported talker or type
+    GPS_STAT_GGA,                   // sentences with a valid checksum, per type in gps_sentence_type_t order
+    GPS_STAT_RMC,
+    GPS_STAT_GSA,
+    GPS_STAT_GSV,
+    GPS_STAT_VTG,
+    GPS_STAT_GLL,
+    GPS_STAT_CHECKSUM_ERRORS,       // missing or wrong checksum
+    GPS_STAT_FORMAT_ERRORS,         // no sentence start, missing CRLF, broken framing or sentence too long
+    GPS_STAT_FIELD_COUNT_ERRORS,    // wrong number of fields for the sentence type
+    GPS_STAT_FIELD_ERRORS,          // fields present but rejected by their validator, set to their default
+    GPS_STAT_COUNT,
+} gps_stat_t;
+
+/**
+ * @brief Snapshot of the counters of a parser context, indexed by gps_stat_t.
+ */
+typedef struct {
+    uint32_t value[GPS_STAT_COUNT];
+} gps_parser_stats_t;
+
+/**
+ * @brief Parser context holding all working state of one parse.
+ *
+ * The context is owned by the caller (stack, static or embedded in another structure),
+ * so parsing needs no heap memory and separate contexts can be used from separate tasks
+ * at the same time.
+ */
+typedef struct {
+    // Sentence being decoded, in the caller's buffer: it is never copied, terminated or modified
+    const char *sentence;
+
+    // Start (from '$') and length of each field inside sentence
+    uint8_t field_offset[GPS_NMEA_MAX_FIELDS];
+    uint8_t field_length[GPS_NMEA_MAX_FIELDS];
+
+    // Number of fields found in sentence
+    int field_count;
+
+    // Contiguous copy of a sentence wrapping the end of a ring buffer, the only case where bytes are copied
+    char wrapped[GPS_NMEA_MAX_SENTENCE_LEN];
+
+    // GPS_DECODE_FLOAT and/or GPS_DECODE_FIXED_POINT, may be changed after gps_parser_init()
+    uint32_t decode_flags;
+
+    // GPS_GGA_FIELD_* groups decoded from GGA sentences, the others keep their DEFAULT_* values.
+    // GPS_GGA_FIELD_ALL after gps_parser_init(), may be changed afterwards
+    uint32_t gga_fields;
+
+    // Bit n is set when field n of the last decoded sentence was present but invalid
+    uint32_t invalid_fields;
+
+    // Receive times of the next sentence to parse, set by the caller (e.g. from gps_nmea_stream_t.rx_time)
+    // and copied to the results
+    gps_rx_time_t rx_time;
+
+    // Date of the last RMC sentence as (year << 9 | month << 5 | day), 0 while none was decoded,
+    // the UTC start of that day in milliseconds since 1970-01-01 and the UTC time of day of the sentence
+    uint32_t utc_date;
+    uint32_t utc_date_time_ms;
+    int64_t utc_day_start_ms;
+
+    // Counters indexed by gps_stat_t, only written by the parse calls on this context. They wrap
+    // at 2^32 and are read from any task with gps_parser_stats_snapshot()
+    atomic_uint stats[GPS_STAT_COUNT];
+
+    // Counter values at the last gps_parser_stats_reset()
+    uint32_t stats_base[GPS_STAT_COUNT];
+
+} gps_parser_ctx_t;
+
+/**
+ * @brief Outcome of parsing a sentence.
+ *
+ * Negative values mean the sentence was rejected and the output holds default values,
+ * non negative values mean it was decoded.
+ */
+typedef enum {
+    GPS_PARSE_OK = 0,                   // decoded, every present field is valid
+    GPS_PARSE_INVALID_FIELD = 1,        // decoded, the fields flagged in ctx->invalid_fields were set to their defaults
+    GPS_PARSE_ERR_FORMAT = -1,          // NULL or empty input, no sentence start, missing CRLF or sentence too long
+    GPS_PARSE_ERR_CHECKSUM = -2,        // missing or wrong checksum
+    GPS_PARSE_ERR_FIELD_COUNT = -3,     // wrong number of fields for the sentence type
+    GPS_PARSE_ERR_UNSUPPORTED = -4,     // talker or sentence type not supported
+    GPS_PARSE_INCOMPLETE = -5,          // no complete sentence left in the buffer (gps_nmea_parse_next)
+} gps_parse_result_t;
+
+/**
+ * @brief Initializes a caller-owned parser context.
+ *
+ * The context decodes float values (GPS_DECODE_FLOAT). Set ctx->decode_flags to
+ * GPS_DECODE_FIXED_POINT to decode latitude, longitude, altitude, geoid separation and
+ * HDOP as exact integers without any libc float parsing, which suits targets without
+ * an FPU; the float members (and dgps_age) are then left at their default values.
+ *
+ * Every GGA field is decoded (GPS_GGA_FIELD_ALL). Set ctx->gga_fields to a subset, e.g.
+ * GPS_GGA_FIELD_LATITUDE | GPS_GGA_FIELD_LONGITUDE, to skip the validation and conversion
+ * of the other fields, whose members are then left at their default values.
+ *
+ * @param ctx The parser context to initialize.
+ */
+void gps_parser_init(gps_parser_ctx_t *ctx);
+
+/**
+ * @brief Copies the counters of a parser context, counted since gps_parser_init() or the last gps_parser_stats_reset().
+ *
+ * May be called from another task while ctx is parsing: the parse calls update each counter with
+ * a plain relaxed store and take no lock. Each value is exact, counters read while a sentence is
+ * being counted may differ by that one sentence.
+ */
+void gps_parser_stats_snapshot(const gps_parser_ctx_t *ctx, gps_parser_stats_t *stats);
+
+/**
+ * @brief Restarts the counters of a parser context from zero.
+ *
+ * Only the snapshot base is written, so the parsing task is not disturbed; call it from the
+ * task taking the snapshots.
+ */
+void gps_parser_stats_reset(gps_parser_ctx_t *ctx);
+
+/**
+ * @brief Returns the name of a counter for export to monitoring, e.g. "checksum_errors", or "" if stat is out of range.
+ */
+const char *gps_parser_stat_name(gps_stat_t stat);
+
+/**
+ * @brief Parses the first GGA sentence of a UART stream into caller-owned storage.
+ *
+ * Reentrant and allocation free: all working state lives in ctx and the result is
+ * written to gps_data. Invalid or missing data is reported with the DEFAULT_* values.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param uart_stream The input UART stream from GPS module as NMEA sentences.
+ * @param gps_data The structure that receives the parsed GPS data.
+ *
+ * @return GPS_PARSE_OK or GPS_PARSE_INVALID_FIELD if a GGA sentence was decoded, otherwise
+ *         GPS_PARSE_ERR_FORMAT, GPS_PARSE_ERR_CHECKSUM or GPS_PARSE_ERR_FIELD_COUNT.
+ */
+gps_parse_result_t gps_data_parse(gps_parser_ctx_t *ctx, const char *uart_stream, gps_data_parse_t *gps_data);
+
+/**
+ * @brief Same as gps_data_parse() on a buffer of known length, e.g. a DMA or memory mapped buffer.
+ *
+ * The buffer need not be NUL-terminated and may be of any size. It is only read: the GGA
+ * sentence is decoded in place, its fields referred to by offset and length, without copying it.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param buffer The bytes received from the GPS module, NMEA sentences.
+ * @param length Length of buffer in bytes.
+ * @param gps_data The structure that receives the parsed GPS data.
+ *
+ * @return As gps_data_parse(), GPS_PARSE_ERR_FORMAT if buffer is NULL or length is 0.
+ */
+gps_parse_result_t gps_data_parse_buffer(gps_parser_ctx_t *ctx, const char *buffer, size_t length, gps_data_parse_t *gps_data);
+
+/**
+ * @brief Parses one framed GGA sentence whose checksum has already been verified.
+ *
+ * Intended for sentences emitted by the streaming parser (gps_nmea_stream.h), which
+ * checks framing and checksum while the bytes arrive.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param sentence The sentence from '$' up to the checksum digits, without CRLF.
+ * @param length Length of sentence in bytes.
+ * @param gps_data The structure that receives the parsed GPS data.
+ *
+ * @return GPS_PARSE_OK or GPS_PARSE_INVALID_FIELD if the GGA sentence was decoded, otherwise
+ *         GPS_PARSE_ERR_FORMAT, GPS_PARSE_ERR_UNSUPPORTED or GPS_PARSE_ERR_FIELD_COUNT.
+ */
+gps_parse_result_t gps_gga_sentence_parse(gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_data_parse_t *gps_data);
+
 
 /**
  * @brief  Declaration of function to Parse GPS data from a UART stream.
  *
  * This function takes a UART stream containing GPS data in a specific format
  * and parses it to populate the gps_data_parse_t structure. It returns the parsed
- * data structure.
+ * data structure. It is a compatibility wrapper around gps_data_parse() and the
+ * returned structure must be released with free().
  *
  * @param uart_stream The input UART stream from GPS module as NMEA sentences.
  *
@@ -140,5 +400,7 @@ PUBLIC_FOR_TESTING int is_valid_time_public(const char *time);
 PUBLIC_FOR_TESTING int is_valid_numeric_public(const char *str, int expected_length);
 PUBLIC_FOR_TESTING int is_valid_number_public(const char *str);
 PUBLIC_FOR_TESTING float longitude_latitude_parser_public(const char *str);
+PUBLIC_FOR_TESTING int32_t longitude_latitude_fixed_point_parser_public(const char *str);
+PUBLIC_FOR_TESTING int decimal_fixed_point_parser_public(const char *str, int scale_digits, int allow_negative, int32_t *value);
 
 #endif  // GPS_DATA_PARSER_H
@@ -0,0 +1,120 @@
+/**
+ * @file gps_fix_history.h
+ * @brief Fixed-capacity, allocation-free history of fixes with delta-encoded storage.
+ *
+ * Fixes are stored as gps_fix_record_t values in caller-provided storage, for example a static
+ * array in internal or RTC memory. The storage is split into equal blocks. Each block starts
+ * with one full record, every following fix is stored as the zigzag varint differences of its
+ * fields from a prediction based on the fixes before it:
+ *
+ *  - time, latitude and longitude are predicted to change by as much as they did last time,
+ *    so a receiver moving at a steady speed at a steady rate stores almost nothing for them;
+ *  - altitude, fix quality, satellite count and HDOP are predicted to stay unchanged.
+ *
+ * A fix is one mask byte telling which fields differ from their prediction, followed by the
+ * varint residual of each of them. A stationary 1 Hz receiver stores one byte per fix and a
+ * moving one typically three, so an hour of 1 Hz track fits in about 12 KB.
+ *
+ * When every block is in use, appending drops the oldest block, so the history always holds
+ * the most recent fixes. Append and the step of an iteration take constant time.
+ */
+#ifndef GPS_FIX_HISTORY_H
+#define GPS_FIX_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_fix_record.h"
+
+#define GPS_FIX_HISTORY_FIELDS          7       // time, latitude, longitude, altitude, fix quality, satellites, HDOP
+#define GPS_FIX_HISTORY_MIN_BLOCK_SIZE  64      // block header, full record and the largest delta-encoded fix
+#define GPS_FIX_HISTORY_MAX_BLOCK_SIZE  65535
+#define GPS_FIX_HISTORY_DEFAULT_BLOCK_SIZE 512
+
+/**
+ * @brief Last fields and their last change, the prediction state of the delta encoding.
+ */
+typedef struct {
+    uint32_t value[GPS_FIX_HISTORY_FIELDS];
+    uint32_t delta[GPS_FIX_HISTORY_FIELDS];
+} gps_fix_history_state_t;
+
+/**
+ * @brief History of fixes, owned by the caller.
+ */
+typedef struct {
+    // Caller-provided storage, block_count blocks of block_size bytes
+    uint8_t *storage;
+    size_t block_size;
+    size_t block_count;
+
+    // Index of the oldest block and number of blocks holding fixes
+    size_t first_block;
+    size_t used_blocks;
+
+    // Number of fixes held
+    size_t count;
+
+    // Prediction state after the newest fix
+    gps_fix_history_state_t last;
+
+} gps_fix_history_t;
+
+/**
+ * @brief Position of an iteration over a history, from the oldest fix to the newest.
+ *
+ * The history must not be appended to while it is iterated.
+ */
+typedef struct {
+    const gps_fix_history_t *history;
+    size_t block;       // blocks visited before the current one
+    size_t offset;      // offset of the next fix in the current block, 0 before its first fix
+    gps_fix_history_state_t state;
+} gps_fix_history_iter_t;
+
+/**
+ * @brief Initializes an empty history over caller-provided storage.
+ *
+ * @param history The history to initialize.
+ * @param storage Storage for the fixes, used until the history is no longer needed.
+ * @param size Size of storage in bytes, the bytes after the last whole block are not used.
+ * @param block_size Size of a block, GPS_FIX_HISTORY_DEFAULT_BLOCK_SIZE suits most uses. Appending
+ *        to a full history drops the fixes of one block, smaller blocks drop fewer at a time but
+ *        spend more bytes on full records.
+ *
+ * @return 0 on success, -1 if block_size is outside GPS_FIX_HISTORY_MIN_BLOCK_SIZE to
+ *         GPS_FIX_HISTORY_MAX_BLOCK_SIZE or storage holds fewer than two blocks.
+ */
+int gps_fix_history_init(gps_fix_history_t *history, void *storage, size_t size, size_t block_size);
+
+/**
+ * @brief Drops every fix of the history.
+ */
+void gps_fix_history_clear(gps_fix_history_t *history);
+
+/**
+ * @brief Appends a fix, dropping the oldest block of fixes if the history is full.
+ */
+void gps_fix_history_append(gps_fix_history_t *history, const gps_fix_record_t *record);
+
+/**
+ * @brief Returns the number of storage bytes holding fixes.
+ */
+size_t gps_fix_history_bytes_used(const gps_fix_history_t *history);
+
+/**
+ * @brief Starts an iteration at the oldest fix of the history.
+ */
+void gps_fix_history_iter_init(gps_fix_history_iter_t *iter, const gps_fix_history_t *history);
+
+/**
+ * @brief Returns the next fix of an iteration.
+ *
+ * @param iter The iteration.
+ * @param record The record that receives the fix.
+ *
+ * @return 1 if a fix was returned, 0 when the iteration has passed the newest fix.
+ */
+int gps_fix_history_iter_next(gps_fix_history_iter_t *iter, gps_fix_record_t *record);
+
+#endif  // GPS_FIX_HISTORY_H
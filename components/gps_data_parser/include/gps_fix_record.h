@@ -0,0 +1,73 @@
+/**
+ * @file gps_fix_record.h
+ * @brief Packed 18-byte binary fix record for storage and radio uplink.
+ *
+ * A record holds the GGA members a tracker usually keeps: position in 1e-7 degrees, altitude in
+ * decimetres, UTC time of day in milliseconds, fix quality, satellite count and HDOP in tenths.
+ * The time of day is stored in UTC whatever TIME_ZONE is: encoding takes TIME_ZONE out of the
+ * hour of gps_data_parse_t.time and decoding adds it back.
+ * It is a byte array with a fixed little-endian layout, so records can be stored, sent and read
+ * back on any host without padding or byte order concerns:
+ *
+ *  offset  size  content
+ *  0       4     latitude, int32 1e-7 degrees, negative south
+ *  4       4     longitude, int32 1e-7 degrees, negative west
+ *  8       4     bits 0-26 UTC time of day in ms, bits 27-30 fix quality, bit 31 reserved (0)
+ *  12      3     altitude above sea level, int24 decimetres
+ *  15      1     number of satellites
+ *  16      2     HDOP, uint16 tenths
+ *
+ * Missing values are stored as the GPS_FIX_RECORD_NO_* sentinels and decode to the DEFAULT_*
+ * values of gps_data_parse_t.
+ */
+#ifndef GPS_FIX_RECORD_H
+#define GPS_FIX_RECORD_H
+
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+
+#define GPS_FIX_RECORD_SIZE 18
+
+// Sentinels of the packed fields that have no value
+#define GPS_FIX_RECORD_NO_COORDINATE    INT32_MAX
+#define GPS_FIX_RECORD_NO_TIME          0x7FFFFFFu
+#define GPS_FIX_RECORD_NO_FIX_QUALITY   0xFu
+#define GPS_FIX_RECORD_NO_ALTITUDE      (-8388608)
+#define GPS_FIX_RECORD_NO_SATELLITES    0xFFu
+#define GPS_FIX_RECORD_NO_HDOP          0xFFFFu
+
+/**
+ * @brief One packed fix, see the layout above. sizeof() is GPS_FIX_RECORD_SIZE and the
+ * alignment is 1, so arrays of records are dense.
+ */
+typedef struct {
+    uint8_t bytes[GPS_FIX_RECORD_SIZE];
+} gps_fix_record_t;
+
+/**
+ * @brief Packs the members of a decoded GGA sentence into a record.
+ *
+ * The fixed-point members are used when they hold a value, the float members otherwise, so
+ * results of either decode mode can be packed. Values are rounded to the record's units;
+ * values out of the record's range and fix qualities above 14 are stored as missing.
+ * Altitudes in feet (USE_FEET_UNIT) are converted to metres.
+ *
+ * @param data The decoded sentence.
+ * @param record The record that receives the packed fix.
+ */
+void gps_fix_record_encode(const gps_data_parse_t *data, gps_fix_record_t *record);
+
+/**
+ * @brief Unpacks a record into both the float and the fixed-point members of a gps_data_parse_t.
+ *
+ * Members not held by a record (geoid separation, DGPS age and station) and the members of
+ * missing values are set to their DEFAULT_* values. Float altitudes follow USE_FEET_UNIT as
+ * in gps_data_parse().
+ *
+ * @param record The packed fix.
+ * @param data The structure that receives the unpacked fix.
+ */
+void gps_fix_record_decode(const gps_fix_record_t *record, gps_data_parse_t *data);
+
+#endif  // GPS_FIX_RECORD_H
@@ -0,0 +1,85 @@
+/**
+ * @file gps_geo.h
+ * @brief Batch geodesic kernels: distance, initial bearing, cumulative track length and speed.
+ *
+ * The kernels work on arrays of coordinates (struct of arrays), the layout that lets the host
+ * build process four fixes per instruction with the compiler's vector extensions. On the ESP32
+ * the same code runs one fix at a time in single precision. Trigonometric functions are replaced
+ * by branch-free polynomials accurate to a few float ulps. The only libm call left is sqrtf() on
+ * the scalar path; the vector path refines a reciprocal square root instead.
+ *
+ * Distances use the haversine formula on a sphere of radius GPS_GEO_EARTH_RADIUS. Compared with
+ * the WGS-84 ellipsoid this is within 0.5 %; the float computation adds a relative error below
+ * 1e-5 for distances from a few centimetres up to several thousand kilometres.
+ */
+#ifndef GPS_GEO_H
+#define GPS_GEO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GPS_GEO_EARTH_RADIUS    6371008.8f      // mean earth radius in metres
+#define GPS_GEO_NO_SPEED        -1.0f           // speed between fixes without a positive time difference
+
+/**
+ * @brief A track as parallel arrays, fix i is latitude[i], longitude[i], time_ms[i].
+ */
+typedef struct {
+    const float *latitude;      // degrees, negative south
+    const float *longitude;     // degrees, negative west
+    const int64_t *time_ms;     // milliseconds on any monotonic scale, may be NULL if no speed is computed
+    size_t count;
+} gps_geo_track_t;
+
+/**
+ * @brief Great-circle distances in metres from point i of the first arrays to point i of the second ones.
+ *
+ * The output may be one of the inputs.
+ */
+void gps_geo_distance(const float *latitude1, const float *longitude1, const float *latitude2, const float *longitude2,
+                      float *distance, size_t count);
+
+/**
+ * @brief Initial bearings in degrees (0 to 360, clockwise from north) from point i of the first
+ * arrays to point i of the second ones, 0 between identical points.
+ */
+void gps_geo_bearing(const float *latitude1, const float *longitude1, const float *latitude2, const float *longitude2,
+                     float *bearing, size_t count);
+
+/**
+ * @brief Distances in metres between consecutive fixes, segment[i] from fix i to fix i + 1.
+ *
+ * @param segment Array of track->count - 1 values.
+ */
+void gps_geo_track_segments(const gps_geo_track_t *track, float *segment);
+
+/**
+ * @brief Bearings in degrees between consecutive fixes, bearing[i] from fix i to fix i + 1.
+ *
+ * @param bearing Array of track->count - 1 values.
+ */
+void gps_geo_track_bearings(const gps_geo_track_t *track, float *bearing);
+
+/**
+ * @brief Length of a track in metres, optionally the length up to every fix.
+ *
+ * Lengths are accumulated in double precision, so long tracks do not lose their short segments.
+ *
+ * @param track The track.
+ * @param cumulative Array of track->count values, cumulative[i] is the length from fix 0 to fix i, or NULL.
+ *
+ * @return The length of the whole track.
+ */
+double gps_geo_track_length(const gps_geo_track_t *track, double *cumulative);
+
+/**
+ * @brief Speeds in metres per second between consecutive fixes, speed[i] from fix i to fix i + 1.
+ *
+ * Pairs of fixes whose time does not increase get GPS_GEO_NO_SPEED.
+ *
+ * @param track The track, time_ms must be set.
+ * @param speed Array of track->count - 1 values.
+ */
+void gps_geo_track_speeds(const gps_geo_track_t *track, float *speed);
+
+#endif  // GPS_GEO_H
@@ -0,0 +1,166 @@
+/**
+ * @file gps_geofence.h
+ * @brief Geofences (polygons and circles) behind a uniform grid index, with enter / exit events.
+ *
+ * Fences are added once, then gps_geofence_build() lays a grid over their bounding boxes. Each
+ * cell lists the fences whose bounding box overlaps it. The grid has about as many cells as
+ * there are fences, so a fix is only tested against the few fences of its cell, plus the fences
+ * it was inside at the previous fix. The cost per fix does not grow with the number of fences as
+ * long as they do not pile up on the same spot.
+ *
+ * Everything lives in caller-provided storage, e.g. a static buffer: fence descriptors at the
+ * start, the grid and the inside state after them. Polygon vertices are not copied and must stay
+ * valid, typically a const table in flash. Polygons are tested exactly in integer arithmetic on
+ * 1e-7 degrees. Circles are tested on a local flat projection, accurate to well under a metre
+ * for radii up to tens of kilometres. Fences must not cross the 180th meridian.
+ */
+#ifndef GPS_GEOFENCE_H
+#define GPS_GEOFENCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+
+#define GPS_GEOFENCE_MAX_FENCES     65535
+
+// Storage for max_fences fences of up to a few grid cells each
+#define GPS_GEOFENCE_STORAGE_SIZE(max_fences)   (64 + (max_fences) * (sizeof(gps_geofence_shape_t) + 32))
+
+typedef enum {
+    GPS_GEOFENCE_ENTER,
+    GPS_GEOFENCE_EXIT,
+} gps_geofence_event_t;
+
+typedef struct {
+    int32_t latitude_e7;
+    int32_t longitude_e7;
+} gps_geofence_point_t;
+
+/**
+ * @brief A fence as kept in the storage.
+ */
+typedef struct {
+    // Bounding box in 1e-7 degrees
+    int32_t min_latitude_e7;
+    int32_t max_latitude_e7;
+    int32_t min_longitude_e7;
+    int32_t max_longitude_e7;
+
+    union {
+        struct {
+            const gps_geofence_point_t *vertices;
+            uint32_t vertex_count;
+        } polygon;
+        struct {
+            gps_geofence_point_t center;
+            float radius_squared;       // square metres
+            float longitude_scale;      // metres per 1e-7 degree of longitude at the center
+        } circle;
+    };
+
+    uint8_t is_circle;
+    uint8_t inside;                     // the last fix was inside the fence
+
+} gps_geofence_shape_t;
+
+/**
+ * @brief Called for every fence entered or left.
+ *
+ * @param fence Index of the fence, as returned by gps_geofence_add_polygon() / gps_geofence_add_circle().
+ * @param event GPS_GEOFENCE_ENTER or GPS_GEOFENCE_EXIT.
+ * @param fix The fix, only valid during the call.
+ * @param user_ctx The user_ctx given to gps_geofence_init().
+ */
+typedef void (*gps_geofence_event_cb_t)(int fence, gps_geofence_event_t event, const gps_data_parse_t *fix, void *user_ctx);
+
+/**
+ * @brief Geofence set, owned by the caller.
+ */
+typedef struct {
+    gps_geofence_event_cb_t callback;
+    void *user_ctx;
+
+    gps_geofence_shape_t *shapes;
+    size_t count;
+    size_t max_fences;
+    uint8_t *index_storage;             // storage after the shapes
+    size_t index_size;
+    int built;
+
+    // Grid over the bounding box of all fences, cell (row, column) lists
+    // cell_fences[cell_start[row * columns + column]] up to the start of the next cell
+    int32_t grid_latitude_e7;
+    int32_t grid_longitude_e7;
+    uint32_t cell_height_e7;
+    uint32_t cell_width_e7;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t *cell_start;
+    uint16_t *cell_fences;
+
+    // Fences the last fix was inside
+    uint16_t *inside;
+    size_t inside_count;
+
+    // Fences tested against the last fix
+    size_t tested;
+
+} gps_geofence_t;
+
+/**
+ * @brief Initializes an empty geofence set.
+ *
+ * @param geofence The set to initialize.
+ * @param storage Storage for the fences and the index, see GPS_GEOFENCE_STORAGE_SIZE().
+ * @param size Size of storage in bytes.
+ * @param max_fences Largest number of fences that will be added, at most GPS_GEOFENCE_MAX_FENCES.
+ * @param callback Called for every fence entered or left, may be NULL.
+ * @param user_ctx Passed to callback.
+ *
+ * @return 0 on success, -1 if storage is NULL or too small for max_fences.
+ */
+int gps_geofence_init(gps_geofence_t *geofence, void *storage, size_t size, size_t max_fences,
+                      gps_geofence_event_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Adds a simple polygon (edges do not cross), in either winding order.
+ *
+ * @param vertices At least 3 vertices, not copied: they must stay valid while the set is used.
+ *
+ * @return Index of the fence, -1 if the set is full or already built, or the polygon is invalid.
+ */
+int gps_geofence_add_polygon(gps_geofence_t *geofence, const gps_geofence_point_t *vertices, size_t vertex_count);
+
+/**
+ * @brief Adds a circle of radius metres.
+ *
+ * @return Index of the fence, -1 if the set is full or already built, or the circle is invalid.
+ */
+int gps_geofence_add_circle(gps_geofence_t *geofence, int32_t latitude_e7, int32_t longitude_e7, float radius);
+
+/**
+ * @brief Builds the grid index once all fences are added.
+ *
+ * The finest grid of up to one cell per fence that fits the storage is used.
+ *
+ * @return 0 on success, -1 if the index does not fit the storage even as a single cell.
+ */
+int gps_geofence_build(gps_geofence_t *geofence);
+
+/**
+ * @brief Tests a fix against the fences and reports the fences entered and left since the previous fix.
+ *
+ * The position is taken from latitude_e7 / longitude_e7 when they hold a value, from the float
+ * members otherwise. Fixes without a position are ignored and change no state.
+ *
+ * @return Number of events reported, -1 if the index is not built.
+ */
+int gps_geofence_update(gps_geofence_t *geofence, const gps_data_parse_t *fix);
+
+/**
+ * @brief Returns 1 if the last fix given to gps_geofence_update() was inside the fence, otherwise 0.
+ */
+int gps_geofence_is_inside(const gps_geofence_t *geofence, int fence);
+
+#endif  // GPS_GEOFENCE_H
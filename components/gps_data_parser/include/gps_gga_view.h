@@ -0,0 +1,81 @@
+/**
+ * @file gps_gga_view.h
+ * @brief Tokenized view of a GGA sentence with lazily decoded fields.
+ *
+ * gps_gga_view_init() checks the framing and checksum of a sentence and records where each
+ * field starts and ends, without copying the sentence or converting anything. The typed
+ * accessors convert the field group they need on first access and cache the result, so a
+ * caller reading only position and fix quality never pays for the time, DOP, altitude,
+ * geoid and DGPS conversions.
+ *
+ */
+#ifndef GPS_GGA_VIEW_H
+#define GPS_GGA_VIEW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+
+/**
+ * @brief A tokenized GGA sentence, owned by the caller.
+ *
+ * The view refers to the caller's sentence buffer, which must stay unchanged while the view is used.
+ */
+typedef struct {
+    // Sentence the offsets refer to
+    const char *sentence;
+
+    // Start (from '$') and length of each field, field 0 is the address field "$--GGA"
+    uint8_t field_offset[GGA_FIELD_COUNT];
+    uint8_t field_length[GGA_FIELD_COUNT];
+
+    // GPS_GGA_FIELD_* groups already converted in float and in fixed-point mode
+    uint32_t decoded_float;
+    uint32_t decoded_fixed_point;
+
+    // Bit n is set when field n was converted and found present but invalid
+    uint32_t invalid_fields;
+
+    // Converted values, members of groups not converted yet hold their DEFAULT_* values
+    gps_data_parse_t data;
+
+} gps_gga_view_t;
+
+/**
+ * @brief Checks a GGA sentence and tokenizes it into a view, no field is converted.
+ *
+ * @param view The view to initialize.
+ * @param sentence The sentence from '$' up to the checksum digits, optionally followed by CRLF.
+ * @param length Length of sentence in bytes.
+ *
+ * @return GPS_PARSE_OK, or GPS_PARSE_ERR_FORMAT, GPS_PARSE_ERR_CHECKSUM, GPS_PARSE_ERR_UNSUPPORTED
+ *         (not a GGA sentence) or GPS_PARSE_ERR_FIELD_COUNT. The accessors must not be used after
+ *         an error.
+ */
+gps_parse_result_t gps_gga_view_init(gps_gga_view_t *view, const char *sentence, size_t length);
+
+/**
+ * @brief Converts the given GPS_GGA_FIELD_* groups in the given GPS_DECODE_* modes, once.
+ *
+ * @return The cached values, see gps_gga_view_t.data.
+ */
+const gps_data_parse_t *gps_gga_view_decode(gps_gga_view_t *view, uint32_t fields, uint32_t decode_flags);
+
+/**
+ * @brief Typed accessors, each converts its field group on first access and then returns the cached value.
+ *
+ * Empty or invalid fields read as their DEFAULT_* value, invalid ones are flagged in view->invalid_fields.
+ */
+const gps_time_t *gps_gga_view_time(gps_gga_view_t *view);
+float gps_gga_view_latitude(gps_gga_view_t *view);
+float gps_gga_view_longitude(gps_gga_view_t *view);
+int32_t gps_gga_view_latitude_e7(gps_gga_view_t *view);
+int32_t gps_gga_view_longitude_e7(gps_gga_view_t *view);
+int gps_gga_view_fix_quality(gps_gga_view_t *view);
+int gps_gga_view_num_satellites(gps_gga_view_t *view);
+float gps_gga_view_hdop(gps_gga_view_t *view);
+float gps_gga_view_altitude(gps_gga_view_t *view);
+int32_t gps_gga_view_altitude_mm(gps_gga_view_t *view);
+
+#endif  // GPS_GGA_VIEW_H
@@ -0,0 +1,123 @@
+/**
+ * @file gps_nmea_epoch.h
+ * @brief Merges the sentences of one receiver epoch into a single fix record.
+ *
+ * A receiver outputs its solution as a burst of sentences sharing one UTC time (e.g. RMC, VTG,
+ * GGA and GSA every second). The aggregator collects the decoded sentences of a burst into a
+ * fixed-size gps_fix_t and hands it to a callback once per epoch: as soon as every required
+ * sentence type has been merged, or when a sentence with a different time starts the next epoch.
+ *
+ */
+#ifndef GPS_NMEA_EPOCH_H
+#define GPS_NMEA_EPOCH_H
+
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+#include "gps_nmea_sentence.h"
+
+// Bit of a gps_sentence_type_t in gps_fix_t.sources and in the required mask
+#define GPS_FIX_SOURCE(type)        (1u << (type))
+
+// Sentence types completing an epoch by default
+#define GPS_EPOCH_DEFAULT_REQUIRED  (GPS_FIX_SOURCE (GPS_SENTENCE_GGA) | GPS_FIX_SOURCE (GPS_SENTENCE_RMC) | \
+                                     GPS_FIX_SOURCE (GPS_SENTENCE_GSA) | GPS_FIX_SOURCE (GPS_SENTENCE_VTG))
+
+/**
+ * @brief Navigation solution of one epoch.
+ *
+ * A member provided by several sentence types takes the first valid value of the epoch,
+ * members no merged sentence provided keep their DEFAULT_* value.
+ */
+typedef struct {
+    gps_time_t time;                // local time (UTC + TIME_ZONE, hour wrapped to 0-23) shared by the timed sentences (GGA, RMC, GLL), see utc_ms for UTC
+    gps_date_t date;                // UTC date (RMC), not moved by TIME_ZONE
+    int64_t utc_ms;                 // milliseconds since 1970-01-01 (GGA, RMC), DEFAULT_UTC_MS until an RMC dated the parser context
+    gps_rx_time_t rx_time;          // first byte of the first sentence merged, last byte of the last one
+    uint32_t sources;               // GPS_FIX_SOURCE() of every sentence type merged
+
+    float latitude;                 // degrees, negative south (GGA, RMC, GLL)
+    float longitude;                // degrees, negative west (GGA, RMC, GLL)
+    float altitude;                 // GGA, meters or feet as selected by USE_FEET_UNIT
+    float geoid_height;             // GGA
+    int32_t latitude_e7;            // GGA decoded with GPS_DECODE_FIXED_POINT
+    int32_t longitude_e7;
+    int32_t altitude_mm;
+
+    int fix_quality;                // GGA
+    int num_satellites;             // GGA
+    int fix_type;                   // GSA: 1 = no fix, 2 = 2D, 3 = 3D
+    float hdop;                     // GGA, GSA
+    float pdop;                     // GSA
+    float vdop;                     // GSA
+
+    float speed_knots;              // RMC, VTG
+    float speed_kmh;                // VTG
+    float course;                   // degrees true (RMC, VTG)
+    char status;                    // RMC, GLL: A = data valid, V = invalid
+    char mode;                      // RMC, VTG, GLL mode indicator
+} gps_fix_t;
+
+/**
+ * @brief Callback receiving each completed epoch.
+ *
+ * @param fix The merged solution, only valid for the duration of the call.
+ * @param user_ctx The pointer given to gps_nmea_epoch_init().
+ */
+typedef void (*gps_fix_cb_t)(const gps_fix_t *fix, void *user_ctx);
+
+/**
+ * @brief State of the epoch aggregator, owned by the caller.
+ */
+typedef struct {
+    // Epoch being assembled
+    gps_fix_t fix;
+
+    // Non zero while fix holds an epoch that has not been published
+    int open;
+
+    // Time of the last published epoch, sentences repeating it are ignored
+    gps_time_t published_time;
+
+    // GPS_FIX_SOURCE() mask completing an epoch
+    uint32_t required;
+
+    // Fix consumer
+    gps_fix_cb_t callback;
+    void *user_ctx;
+
+} gps_nmea_epoch_t;
+
+/**
+ * @brief Initializes an epoch aggregator.
+ *
+ * @param epoch The aggregator to initialize.
+ * @param required Sentence types whose arrival completes an epoch, e.g. GPS_EPOCH_DEFAULT_REQUIRED.
+ * @param callback Function called once per epoch.
+ * @param user_ctx Pointer passed back to callback.
+ */
+void gps_nmea_epoch_init(gps_nmea_epoch_t *epoch, uint32_t required, gps_fix_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Merges a decoded sentence into the current epoch.
+ *
+ * A timed sentence (GGA, RMC, GLL) with a new UTC time publishes the open epoch and starts the
+ * next one. GSA and VTG carry no time and are merged into the open epoch, they are ignored when
+ * no epoch is open, e.g. the extra GSA sentences of a multi-constellation receiver that arrive
+ * after their epoch was completed. GSV sentences are ignored.
+ *
+ * @param epoch The aggregator.
+ * @param msg A sentence decoded with a non negative gps_parse_result_t.
+ *
+ * @return Number of epochs published by this call.
+ */
+int gps_nmea_epoch_add(gps_nmea_epoch_t *epoch, const gps_nmea_msg_t *msg);
+
+/**
+ * @brief Publishes the open epoch even if it is incomplete, e.g. when the receiver goes silent.
+ *
+ * @return 1 if an epoch was published, 0 if none was open.
+ */
+int gps_nmea_epoch_flush(gps_nmea_epoch_t *epoch);
+
+#endif  // GPS_NMEA_EPOCH_H
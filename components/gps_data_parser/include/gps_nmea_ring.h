@@ -0,0 +1,113 @@
+/**
+ * @file gps_nmea_ring.h
+ * @brief Lock-free single-producer/single-consumer byte ring between UART RX and the parser.
+ *
+ * The producer (UART RX task or ISR) appends received bytes, the consumer (parser task) takes
+ * complete sentences out of the ring in place. Producer and consumer each own one index and
+ * publish it with a release store, so no lock is needed and either side may run on either core.
+ * A sentence that wraps the end of the storage is returned as a two segment gps_nmea_view_t
+ * instead of being copied into a linear buffer by the ring. gps_nmea_sentence_parse_view()
+ * gathers such a sentence into the wrapped buffer of the parser context to tokenize it, which
+ * is the only copy between the ring and the decoded fields.
+ *
+ */
+#ifndef GPS_NMEA_RING_H
+#define GPS_NMEA_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+#include "gps_nmea_sentence.h"
+
+/**
+ * @brief State of a byte ring, owned by the caller.
+ */
+typedef struct {
+    // Caller provided storage, capacity is a power of two
+    char *buffer;
+    size_t capacity;
+
+    // Total number of bytes written, only stored by the producer
+    atomic_size_t head;
+
+    // Total number of bytes consumed, only stored by the consumer
+    atomic_size_t tail;
+
+    // Consumer side: how far the sentence at the tail has already been scanned (0 if not
+    // scanned) and the checksum of that part, so an incomplete sentence is never rescanned
+    size_t resume_offset;
+    uint8_t resume_checksum;
+
+} gps_nmea_ring_t;
+
+/**
+ * @brief Initializes an empty ring over caller provided storage.
+ *
+ * @param ring The ring to initialize.
+ * @param storage Byte storage, at least 2 * GPS_NMEA_MAX_SENTENCE_LEN bytes is recommended.
+ * @param capacity Size of storage in bytes, a power of two of at least
+ *                 GPS_NMEA_MAX_SENTENCE_LEN + 2 so a full ring holds the longest sentence and its CRLF.
+ *
+ * @return 0 on success, -1 if capacity is not a power of two or is too small.
+ */
+int gps_nmea_ring_init(gps_nmea_ring_t *ring, char *storage, size_t capacity);
+
+/**
+ * @brief Producer: copies received bytes into the ring.
+ *
+ * @return Number of bytes written, less than length if the ring is full.
+ */
+size_t gps_nmea_ring_write(gps_nmea_ring_t *ring, const char *data, size_t length);
+
+/**
+ * @brief Producer: returns the contiguous free region at the write position.
+ *
+ * Lets a driver read straight into the ring, e.g. uart_read_bytes(port, region, size, 0),
+ * followed by gps_nmea_ring_write_commit() with the number of bytes read.
+ *
+ * @param region Receives the start of the free region.
+ *
+ * @return Size of the region, 0 if the ring is full.
+ */
+size_t gps_nmea_ring_write_reserve(gps_nmea_ring_t *ring, char **region);
+
+/**
+ * @brief Producer: publishes length bytes written to the region returned by gps_nmea_ring_write_reserve().
+ */
+void gps_nmea_ring_write_commit(gps_nmea_ring_t *ring, size_t length);
+
+/**
+ * @brief Consumer: returns every readable byte as up to two segments.
+ *
+ * @return Number of readable bytes.
+ */
+size_t gps_nmea_ring_peek(gps_nmea_ring_t *ring, gps_nmea_view_t *view);
+
+/**
+ * @brief Consumer: releases length bytes at the read position to the producer.
+ */
+void gps_nmea_ring_consume(gps_nmea_ring_t *ring, size_t length);
+
+/**
+ * @brief Consumer: finds the next complete sentence at the read position, in place.
+ *
+ * Framing and checksum are checked across the wrap point. Nothing is consumed by this
+ * function: after using sentence the caller releases the examined bytes with
+ * gps_nmea_ring_consume(ring, *advance), whatever the result.
+ *
+ * @param ring The ring.
+ * @param sentence Receives the sentence from '$' up to the checksum digits, without CRLF,
+ *                 when the result is GPS_PARSE_OK.
+ * @param advance Receives the number of bytes to consume: noise before the sentence, the
+ *                sentence and its CRLF.
+ *
+ * @return GPS_PARSE_OK for a sentence with a valid checksum, GPS_PARSE_ERR_FORMAT for a sentence
+ *         without checksum, CRLF or longer than GPS_NMEA_MAX_SENTENCE_LEN, GPS_PARSE_ERR_CHECKSUM,
+ *         or GPS_PARSE_INCOMPLETE if more bytes are needed (advance then skips the noise before
+ *         the incomplete sentence).
+ */
+gps_parse_result_t gps_nmea_ring_next_sentence(gps_nmea_ring_t *ring, gps_nmea_view_t *sentence, size_t *advance);
+
+#endif  // GPS_NMEA_RING_H
@@ -0,0 +1,56 @@
+/**
+ * @file gps_nmea_scan.h
+ * @brief Word-at-a-time delimiter search and checksum kernels used by the framers and the tokenizer.
+ *
+ * The kernels look at 16 bytes per step with SSE2 or NEON on a host build and at one machine
+ * word per step (4 bytes on Xtensa and RISC-V) elsewhere, using SWAR bit tricks. The last
+ * partial block is finished byte by byte, so results are identical to a plain scalar loop.
+ *
+ */
+#ifndef GPS_NMEA_SCAN_H
+#define GPS_NMEA_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Set to 1 to compile the kernels as plain byte loops (reference implementation)
+#ifndef GPS_NMEA_SCAN_SCALAR
+#define GPS_NMEA_SCAN_SCALAR 0
+#endif
+
+/**
+ * @brief Finds the end of a field.
+ *
+ * @param data Bytes to search, not necessarily NUL-terminated.
+ * @param length Number of bytes in data.
+ *
+ * @return Offset of the first ',' or '*', length if there is none.
+ */
+size_t gps_nmea_scan_field(const char *data, size_t length);
+
+/**
+ * @brief Finds the end of a sentence body and computes its checksum in the same pass.
+ *
+ * @param data Bytes following the '$' of a sentence, not necessarily NUL-terminated.
+ * @param length Number of bytes in data.
+ * @param checksum Receives the XOR of the bytes before the returned offset.
+ *
+ * @return Offset of the first '*', '$', '\r' or '\n', length if there is none.
+ */
+size_t gps_nmea_scan_checksum(const char *data, size_t length, uint8_t *checksum);
+
+/**
+ * @brief Returns the value of a hexadecimal digit (upper or lower case), or -1 if c is not one.
+ */
+int gps_nmea_hex_digit(char c);
+
+/**
+ * @brief Decodes the two hexadecimal digits of a checksum.
+ *
+ * The second digit is not read if the first one is invalid, so digits may point at a NUL.
+ *
+ * @return The byte value (0-255), or -1 if either digit is invalid.
+ */
+int gps_nmea_hex_byte(const char *digits);
+
+#endif  // GPS_NMEA_SCAN_H
@@ -0,0 +1,251 @@
+/**
+ * @file gps_nmea_sentence.h
+ * @brief Sentence type dispatch and typed results for GGA, RMC, GSA, GSV, VTG and GLL.
+ *
+ * The 5 character address field of a sentence (talker ID + sentence type, e.g. "GNRMC")
+ * is resolved with one table lookup, any of the GP, GN, GL, GA and GB talkers is accepted
+ * and each sentence type is decoded into its own structure.
+ *
+ */
+#ifndef GPS_NMEA_SENTENCE_H
+#define GPS_NMEA_SENTENCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+
+/**
+ * @brief Talker ID, the constellation that produced a sentence.
+ */
+typedef enum {
+    GPS_TALKER_UNKNOWN = 0,
+    GPS_TALKER_GP,          // GPS
+    GPS_TALKER_GN,          // combined multi-GNSS solution
+    GPS_TALKER_GL,          // GLONASS
+    GPS_TALKER_GA,          // Galileo
+    GPS_TALKER_GB,          // BeiDou
+} gps_talker_t;
+
+/**
+ * @brief Supported sentence types.
+ */
+typedef enum {
+    GPS_SENTENCE_UNKNOWN = 0,
+    GPS_SENTENCE_GGA,       // fix data
+    GPS_SENTENCE_RMC,       // recommended minimum data
+    GPS_SENTENCE_GSA,       // DOP and active satellites
+    GPS_SENTENCE_GSV,       // satellites in view
+    GPS_SENTENCE_VTG,       // course and speed over ground
+    GPS_SENTENCE_GLL,       // geographic position
+    GPS_SENTENCE_TYPE_COUNT,
+} gps_sentence_type_t;
+
+// Default values of the fields introduced by RMC, GSA, GSV, VTG and GLL sentences
+#define DEFAULT_STATUS      '-'
+#define DEFAULT_MODE        '-'
+#define DEFAULT_SPEED       -1
+#define DEFAULT_COURSE      -1
+#define DEFAULT_DOP         -1
+#define DEFAULT_DATE        0
+#define DEFAULT_MAGNETIC_VARIATION -9999
+#define DEFAULT_SATELLITE_VALUE    -1
+
+#define GSA_MAX_SATELLITES  12  // Satellite PRN slots in a GSA sentence
+#define GSV_MAX_SATELLITES  4   // Satellites described by one GSV sentence
+
+/**
+ * @brief Structure to store a GPS date.
+ */
+typedef struct {
+    uint8_t day;        // Day (01-31), 0 if unknown
+    uint8_t month;      // Month (01-12), 0 if unknown
+    uint16_t year;      // Year (2000-2099), 0 if unknown
+} gps_date_t;
+
+/**
+ * @brief RMC sentence: time, date, position, speed and course.
+ */
+typedef struct {
+    gps_time_t time;
+    char status;                    // A = data valid, V = receiver warning
+    float latitude;                 // degrees, negative south
+    char lat_direction;
+    float longitude;                // degrees, negative west
+    char lon_direction;
+    float speed_knots;              // speed over ground
+    float course;                   // course over ground, degrees true
+    gps_date_t date;
+    float magnetic_variation;       // degrees, negative west
+    char magnetic_variation_direction;
+    char mode;                      // A = autonomous, D = differential, E = estimated, N = not valid
+    int64_t utc_ms;                 // milliseconds since 1970-01-01, DEFAULT_UTC_MS without a time or date
+} gps_rmc_t;
+
+/**
+ * @brief GSA sentence: fix mode, satellites used and dilution of precision.
+ */
+typedef struct {
+    char selection_mode;            // M = manual, A = automatic 2D/3D
+    int fix_type;                   // 1 = no fix, 2 = 2D, 3 = 3D
+    int satellite_prn[GSA_MAX_SATELLITES]; // PRN of satellites used, DEFAULT_SATELLITE_VALUE for empty slots
+    float pdop;
+    float hdop;
+    float vdop;
+} gps_gsa_t;
+
+/**
+ * @brief One satellite described by a GSV sentence.
+ */
+typedef struct {
+    int prn;
+    int elevation;                  // degrees, 0-90
+    int azimuth;                    // degrees true, 0-359
+    int snr;                        // dB-Hz, DEFAULT_SATELLITE_VALUE when not tracking
+} gps_satellite_t;
+
+/**
+ * @brief GSV sentence: one page of the satellites in view.
+ */
+typedef struct {
+    int total_messages;
+    int message_number;
+    int satellites_in_view;
+    int satellite_count;            // entries used in satellites
+    gps_satellite_t satellites[GSV_MAX_SATELLITES];
+} gps_gsv_t;
+
+/**
+ * @brief VTG sentence: course and speed over ground.
+ */
+typedef struct {
+    float course_true;              // degrees
+    float course_magnetic;          // degrees
+    float speed_knots;
+    float speed_kmh;
+    char mode;
+} gps_vtg_t;
+
+/**
+ * @brief GLL sentence: position and time.
+ */
+typedef struct {
+    float latitude;
+    char lat_direction;
+    float longitude;
+    char lon_direction;
+    gps_time_t time;
+    char status;                    // A = data valid, V = invalid
+    char mode;
+} gps_gll_t;
+
+/**
+ * @brief A decoded sentence of any supported type.
+ */
+typedef struct {
+    gps_sentence_type_t type;
+    gps_talker_t talker;
+    gps_rx_time_t rx_time;          // copied from gps_parser_ctx_t.rx_time
+    union {
+        gps_data_parse_t gga;
+        gps_rmc_t rmc;
+        gps_gsa_t gsa;
+        gps_gsv_t gsv;
+        gps_vtg_t vtg;
+        gps_gll_t gll;
+    } data;
+} gps_nmea_msg_t;
+
+/**
+ * @brief A contiguous run of bytes that is not NUL-terminated.
+ */
+typedef struct {
+    const char *data;
+    size_t length;
+} gps_nmea_span_t;
+
+/**
+ * @brief Bytes held in up to two segments, e.g. a sentence that wraps the end of a ring buffer.
+ *
+ * The content is segment[0] followed by segment[1], segment[1] is empty when the bytes are contiguous.
+ */
+typedef struct {
+    gps_nmea_span_t segment[2];
+} gps_nmea_view_t;
+
+/**
+ * @brief Resolves the address field of a sentence.
+ *
+ * @param address The 5 characters following '$' (e.g. "GNGGA"), reading stops at a NUL.
+ * @param talker Receives the talker ID, may be NULL.
+ *
+ * @return The sentence type, GPS_SENTENCE_UNKNOWN for an unknown talker or sentence.
+ */
+gps_sentence_type_t gps_nmea_sentence_identify(const char *address, gps_talker_t *talker);
+
+/**
+ * @brief Decodes one framed sentence whose checksum has already been verified.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param sentence The sentence from '$' up to the checksum digits, without CRLF.
+ * @param length Length of sentence in bytes.
+ * @param msg Receives the sentence type, talker and typed data.
+ *
+ * @return GPS_PARSE_OK or GPS_PARSE_INVALID_FIELD (see ctx->invalid_fields) if the sentence was decoded,
+ *         otherwise GPS_PARSE_ERR_FORMAT, GPS_PARSE_ERR_UNSUPPORTED or GPS_PARSE_ERR_FIELD_COUNT.
+ */
+gps_parse_result_t gps_nmea_sentence_parse(gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_nmea_msg_t *msg);
+
+/**
+ * @brief Decodes one framed sentence held in up to two segments, see gps_nmea_sentence_parse().
+ *
+ * @param ctx The parser context used as working storage.
+ * @param sentence The sentence from '$' up to the checksum digits, without CRLF.
+ * @param msg Receives the sentence type, talker and typed data.
+ *
+ * @return As gps_nmea_sentence_parse().
+ */
+gps_parse_result_t gps_nmea_sentence_parse_view(gps_parser_ctx_t *ctx, const gps_nmea_view_t *sentence, gps_nmea_msg_t *msg);
+
+/**
+ * @brief Frames, checks and decodes the next sentence of a buffer.
+ *
+ * Building block of gps_nmea_parse_batch() for callers that want the outcome of every sentence,
+ * e.g. to count rejections by class. Call it repeatedly until it returns GPS_PARSE_INCOMPLETE.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param buffer Received bytes, not necessarily NUL-terminated.
+ * @param length Number of bytes in buffer.
+ * @param offset Where to start scanning, advanced past the sentence that was examined. On
+ *               GPS_PARSE_INCOMPLETE it is set to the start of the incomplete trailing sentence,
+ *               or to length if no sentence start is left.
+ * @param msg Receives the sentence when the result is not negative.
+ *
+ * @return The gps_nmea_sentence_parse() result, GPS_PARSE_ERR_FORMAT for a sentence without
+ *         checksum or CRLF, GPS_PARSE_ERR_CHECKSUM, or GPS_PARSE_INCOMPLETE.
+ */
+gps_parse_result_t gps_nmea_parse_next(gps_parser_ctx_t *ctx, const char *buffer, size_t length,
+                                       size_t *offset, gps_nmea_msg_t *msg);
+
+/**
+ * @brief Decodes every supported sentence of a buffer in a single pass.
+ *
+ * The buffer is walked once: framing and checksum are evaluated while scanning and each valid
+ * sentence is decoded into the next entry of msgs. Sentences with a wrong checksum, a wrong field
+ * count or an unsupported type are skipped.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param buffer Received bytes, not necessarily NUL-terminated.
+ * @param length Number of bytes in buffer.
+ * @param msgs Array receiving the decoded sentences.
+ * @param max_msgs Number of entries in msgs.
+ * @param consumed Receives the offset at which parsing stopped: the start of an incomplete
+ *                 trailing sentence, the end of the last stored sentence when msgs is full,
+ *                 otherwise length. 0 when max_msgs is 0. May be NULL.
+ *
+ * @return Number of entries written to msgs.
+ */
+size_t gps_nmea_parse_batch(gps_parser_ctx_t *ctx, const char *buffer, size_t length,
+                            gps_nmea_msg_t *msgs, size_t max_msgs, size_t *consumed);
+
+#endif  // GPS_NMEA_SENTENCE_H
@@ -0,0 +1,108 @@
+/**
+ * @file gps_nmea_stream.h
+ * @brief Incremental (push style) NMEA 0183 sentence framer.
+ *
+ * Bytes are fed in chunks of any size, for example straight from uart_read_bytes(),
+ * and every complete sentence with a valid checksum is handed to a callback as soon
+ * as its terminating CRLF arrives. A sentence split across two reads is reassembled,
+ * the checksum is accumulated byte by byte so no byte is scanned twice.
+ *
+ */
+#ifndef GPS_NMEA_STREAM_H
+#define GPS_NMEA_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+
+/**
+ * @brief Callback receiving each complete sentence.
+ *
+ * @param sentence The sentence from '$' up to the checksum digits, NUL-terminated, without CRLF.
+ *                 It is only valid for the duration of the call.
+ * @param length Length of sentence in bytes.
+ * @param user_ctx The pointer given to gps_nmea_stream_init().
+ */
+typedef void (*gps_nmea_sentence_cb_t)(const char *sentence, size_t length, void *user_ctx);
+
+/**
+ * @brief State of the streaming framer, owned by the caller.
+ */
+typedef struct {
+    // Sentence being assembled, from '$' up to the checksum digits
+    char sentence[GPS_NMEA_MAX_SENTENCE_LEN + 1];
+
+    // Number of bytes held in sentence
+    size_t length;
+
+    // Running XOR of the bytes between '$' and '*'
+    uint8_t checksum;
+
+    // Checksum received after '*'
+    uint8_t expected_checksum;
+
+    // Current position inside the sentence (internal)
+    uint8_t state;
+
+    // Receive times of the sentence being assembled, complete during the callback (gps_nmea_stream_feed_at())
+    gps_rx_time_t rx_time;
+
+    // Receive time of the chunk being fed (internal)
+    int64_t chunk_time_us;
+
+    // Sentence consumer
+    gps_nmea_sentence_cb_t callback;
+    void *user_ctx;
+
+    // Context counting the bytes fed and the sentences dropped for their framing or checksum, NULL
+    // (the default) for none. Typically the context the callback parses with, set after gps_nmea_stream_init()
+    gps_parser_ctx_t *stats_ctx;
+
+} gps_nmea_stream_t;
+
+/**
+ * @brief Initializes a streaming framer.
+ *
+ * @param stream The framer to initialize.
+ * @param callback Function called for every complete sentence with a valid checksum.
+ * @param user_ctx Pointer passed back to callback.
+ */
+void gps_nmea_stream_init(gps_nmea_stream_t *stream, gps_nmea_sentence_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Drops any partially received sentence.
+ *
+ * @param stream The framer to reset.
+ */
+void gps_nmea_stream_reset(gps_nmea_stream_t *stream);
+
+/**
+ * @brief Feeds a chunk of received bytes to the framer.
+ *
+ * The callback is invoked from inside this function for every sentence completed by
+ * the chunk. Bytes outside of sentences, sentences without a checksum, with a wrong
+ * checksum or longer than GPS_NMEA_MAX_SENTENCE_LEN are discarded. A '$' inside a
+ * sentence starts a new sentence.
+ *
+ * @param stream The framer.
+ * @param data Received bytes, not necessarily NUL-terminated.
+ * @param length Number of bytes in data.
+ *
+ * @return Number of sentences passed to the callback.
+ */
+size_t gps_nmea_stream_feed(gps_nmea_stream_t *stream, const char *data, size_t length);
+
+/**
+ * @brief Same as gps_nmea_stream_feed(), also stamping the sentences with the time the chunk was received.
+ *
+ * stream->rx_time.first_us is the time of the chunk holding the '$' of the sentence and
+ * rx_time.last_us the time of the chunk holding its LF. They can be read in the callback, e.g.
+ * copied to gps_parser_ctx_t.rx_time before parsing so that the fix carries them. Taking the
+ * time right after each UART read keeps the error below the duration of one read.
+ *
+ * @param rx_time_us Local monotonic time of the chunk in microseconds, e.g. esp_timer_get_time().
+ */
+size_t gps_nmea_stream_feed_at(gps_nmea_stream_t *stream, const char *data, size_t length, int64_t rx_time_us);
+
+#endif  // GPS_NMEA_STREAM_H
@@ -0,0 +1,169 @@
+/**
+ * @file gps_receiver.h
+ * @brief Independent receiver instances and an optional worker pool parsing them in parallel.
+ *
+ * A receiver bundles everything needed to turn the bytes of one GNSS module into fixes: a
+ * gps_nmea_ring_t filled by the UART task, its own gps_parser_ctx_t and a gps_nmea_epoch_t.
+ * Receivers share no state, so each one can be parsed by its own task with gps_receiver_poll().
+ *
+ * Alternatively a gps_receiver_pool_t runs a few workers: FreeRTOS tasks pinned to the cores of
+ * the ESP32 in turn, POSIX threads on the host. Every receiver is bound to one worker when it is
+ * added, so its sentences are always parsed by the same worker, in arrival order, and its fix
+ * callback is never called concurrently with itself. Workers share no lock: the UART task only
+ * wakes the worker of its own receiver.
+ */
+#ifndef GPS_RECEIVER_H
+#define GPS_RECEIVER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "gps_data_parser.h"
+#include "gps_nmea_epoch.h"
+#include "gps_nmea_ring.h"
+#include "gps_nmea_sentence.h"
+
+#ifndef GPS_RECEIVER_MAX_WORKERS
+#define GPS_RECEIVER_MAX_WORKERS        4
+#endif
+
+// Worker task settings on the ESP32, the fix callbacks run on these tasks
+#ifndef GPS_RECEIVER_TASK_STACK
+#define GPS_RECEIVER_TASK_STACK         4096
+#endif
+#ifndef GPS_RECEIVER_TASK_PRIORITY
+#define GPS_RECEIVER_TASK_PRIORITY      5
+#endif
+
+struct gps_receiver_worker;
+
+/**
+ * @brief One GNSS module, owned by the caller.
+ */
+typedef struct gps_receiver {
+    // Parser state of this receiver only, its counters can be read from any task
+    gps_parser_ctx_t ctx;
+
+    // Bytes received, written by the UART task and read by the parsing task
+    gps_nmea_ring_t ring;
+
+    // Last sentence decoded and the epoch being assembled
+    gps_nmea_msg_t msg;
+    gps_nmea_epoch_t epoch;
+
+    // Pool the receiver was added to, NULL when the caller polls it (internal)
+    struct gps_receiver_pool *pool;
+    struct gps_receiver *next;
+
+    // Worker woken by gps_receiver_write(), only set while the pool is started (internal)
+    struct gps_receiver_worker *_Atomic worker;
+
+} gps_receiver_t;
+
+/**
+ * @brief A worker of a pool (internal).
+ */
+typedef struct gps_receiver_worker {
+    struct gps_receiver_pool *pool;
+
+    // Receivers bound to this worker, in the order they were added
+    gps_receiver_t *receivers;
+
+#ifdef ESP_PLATFORM
+    TaskHandle_t task;
+    atomic_int exited;
+#else
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int pending;
+#endif
+
+} gps_receiver_worker_t;
+
+/**
+ * @brief Pool of workers, owned by the caller.
+ */
+typedef struct gps_receiver_pool {
+    gps_receiver_worker_t worker[GPS_RECEIVER_MAX_WORKERS];
+    size_t worker_count;
+    size_t receiver_count;
+    atomic_int running;
+    int started;
+
+} gps_receiver_pool_t;
+
+/**
+ * @brief Initializes a receiver.
+ *
+ * @param rx The receiver to initialize.
+ * @param storage Ring storage, see gps_nmea_ring_init().
+ * @param capacity Size of storage in bytes, a power of two of at least GPS_NMEA_MAX_SENTENCE_LEN + 2.
+ * @param required Sentence types completing an epoch, e.g. GPS_EPOCH_DEFAULT_REQUIRED.
+ * @param callback Called for every fix of this receiver, from the task that parses it.
+ * @param user_ctx Passed to callback.
+ *
+ * @return 0 on success, -1 if capacity is not a power of two or is too small.
+ */
+int gps_receiver_init(gps_receiver_t *rx, char *storage, size_t capacity, uint32_t required,
+                      gps_fix_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Producer: queues received bytes and wakes the worker of the receiver, if it has one.
+ *
+ * Called from one task per receiver, not from an ISR.
+ *
+ * @return Number of bytes queued, less than length if the ring is full.
+ */
+size_t gps_receiver_write(gps_receiver_t *rx, const char *data, size_t length);
+
+/**
+ * @brief Parses every complete sentence queued for a receiver and feeds its epoch.
+ *
+ * For receivers that are not in a pool, called by the one task parsing the receiver.
+ *
+ * @return Number of sentences with a valid checksum parsed.
+ */
+size_t gps_receiver_poll(gps_receiver_t *rx);
+
+/**
+ * @brief Initializes a pool of worker_count workers, started by gps_receiver_pool_start().
+ *
+ * @return 0 on success, -1 if worker_count is 0 or above GPS_RECEIVER_MAX_WORKERS.
+ */
+int gps_receiver_pool_init(gps_receiver_pool_t *pool, size_t worker_count);
+
+/**
+ * @brief Binds a receiver to a worker of the pool, receivers are spread over the workers in turn.
+ *
+ * @return Index of the worker, -1 if the pool is started or the receiver is already in a pool.
+ */
+int gps_receiver_pool_add(gps_receiver_pool_t *pool, gps_receiver_t *rx);
+
+/**
+ * @brief Starts the workers. On the ESP32, worker i is pinned to core i % portNUM_PROCESSORS.
+ *
+ * Bytes written to the receivers before the start are parsed once the workers run.
+ *
+ * @return 0 on success, -1 if the pool is started or a worker could not be created. No worker is
+ *         then left running and the receivers leave the pool, as after gps_receiver_pool_stop().
+ */
+int gps_receiver_pool_start(gps_receiver_pool_t *pool);
+
+/**
+ * @brief Stops the workers once they have parsed the bytes already written, and waits for them.
+ *
+ * Call it once the UART tasks no longer write to the receivers of the pool. The receivers leave
+ * the pool: they can then be polled by the caller or added to a pool again.
+ */
+void gps_receiver_pool_stop(gps_receiver_pool_t *pool);
+
+#endif  // GPS_RECEIVER_H
@@ -0,0 +1,96 @@
+/**
+ * @file gps_track_simplify.h
+ * @brief Streaming track simplification with a bounded error in metres.
+ *
+ * Fixes are fed one at a time as they come out of the parser. Only the points needed to keep
+ * every dropped fix within the tolerance of the simplified track are passed on. The filter
+ * keeps the last passed point (the anchor) and the cone of directions from the anchor that pass
+ * within the tolerance of every fix seen since, and the distance of the farthest of them. A fix
+ * outside the cone, or more than the tolerance closer to the anchor than the farthest fix (a
+ * track doubling back), ends the segment: the fix before it is passed on and becomes the next
+ * anchor. Fixes within the tolerance of the anchor (a receiver standing still) never end a segment.
+ *
+ * Each fix takes constant time and the state is a few floats and one gps_data_parse_t, so the
+ * filter can run on the MCU right after parsing. Distances are computed on a local flat
+ * projection around the anchor, which is accurate for segments up to tens of kilometres.
+ */
+#ifndef GPS_TRACK_SIMPLIFY_H
+#define GPS_TRACK_SIMPLIFY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+
+/**
+ * @brief Called for every point of the simplified track.
+ *
+ * @param fix The fix, only valid during the call.
+ * @param user_ctx The user_ctx given to gps_track_simplify_init().
+ */
+typedef void (*gps_track_point_cb_t)(const gps_data_parse_t *fix, void *user_ctx);
+
+/**
+ * @brief Simplification state, owned by the caller.
+ */
+typedef struct {
+    // Largest distance in metres between a dropped fix and the simplified track
+    float tolerance;
+
+    gps_track_point_cb_t callback;
+    void *user_ctx;
+
+    // Last point passed on and the scale of its local projection, in metres per 1e-7 degree
+    int has_anchor;
+    int32_t anchor_latitude_e7;
+    int32_t anchor_longitude_e7;
+    float longitude_scale;
+
+    // Cone of directions from the anchor, from the clockwise to the counter-clockwise edge (unit vectors)
+    int has_cone;
+    float cone_cw[2];
+    float cone_ccw[2];
+
+    // Farthest distance in metres from the anchor of the fixes accepted in the segment
+    float max_distance;
+
+    // Last accepted fix and its position, not passed on yet
+    int has_pending;
+    gps_data_parse_t pending;
+    int32_t pending_latitude_e7;
+    int32_t pending_longitude_e7;
+
+    // Fixes with a position fed to the filter, and points passed on
+    size_t fixes_in;
+    size_t points_out;
+
+} gps_track_simplify_t;
+
+/**
+ * @brief Initializes a filter.
+ *
+ * @param simplify The filter to initialize.
+ * @param tolerance Largest distance in metres between a dropped fix and the simplified track.
+ * @param callback Called for every point of the simplified track.
+ * @param user_ctx Passed to callback.
+ */
+void gps_track_simplify_init(gps_track_simplify_t *simplify, float tolerance, gps_track_point_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Feeds one fix to the filter.
+ *
+ * The position is taken from latitude_e7 / longitude_e7 when they hold a value, from the float
+ * members otherwise. Fixes without a position are ignored. The first fix is always passed on.
+ *
+ * @return Number of points passed on (0 or 1).
+ */
+int gps_track_simplify_add(gps_track_simplify_t *simplify, const gps_data_parse_t *fix);
+
+/**
+ * @brief Passes on the last fix if it was not passed on yet, e.g. at the end of a track or before an upload.
+ *
+ * @return Number of points passed on (0 or 1).
+ */
+int gps_track_simplify_flush(gps_track_simplify_t *simplify);
+
+#endif  // GPS_TRACK_SIMPLIFY_H
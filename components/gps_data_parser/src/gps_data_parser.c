@@ -12,385 +12,518 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <float.h>
+#include <math.h>
   
-#include <esp_log.h>
 #include "gps_data_parser.h"
-  
-#define TAG "ERROR"
-#define TIME_ZONE 5			 //Pakistan Time UTC +05
-#define Buffer_size 2048
-
+#include "gps_nmea_scan.h"
+#include "gps_nmea_sentence.h"
+#include "gps_parser_private.h"
 
-static int s_crfl = 0;			// static variable to hold index of \r\n in valid GPGGA sentence
-static char* fields[15];	// Array to hold pointers to each field
 
 static int check_stream_NULL_Empty(const char * uart_stream);
-static int gga_sentence_format_validity_check (const char *uart_stream);
+static int gga_sentence_format_validity_check (const char *uart_stream, int *crlf_index);
+static gps_parse_result_t gga_sentence_resync (const char *stream, size_t stream_length, size_t *start, size_t *length);
 static int check_sum_evaluation (const char *sentence);
-static int is_valid_time (const char *time);
-static int is_valid_numeric (const char *str, int expected_length);
-static int is_valid_number (const char *str);
-static void print_default_value (gps_data_parse_t * data);	// function to print default values in case there are issues in uart stream
-static void utc_time_parser (gps_data_parse_t * gps_time);	// function to parse time in utc format 
-static float longitude_latitude_parser (const char *str);	// function to parse latitude and longitude in degrees
+// A DDMM.MMMM or DDDMM.MMMM field split by coordinate_field_parser(): whole is DDMM or DDDMM, fraction
+// the decimal digits of the minutes kept and scale 10 ^ their number
+typedef struct {
+    int64_t whole;
+    int64_t fraction;
+    int64_t scale;
+} coordinate_parts_t;
+
+static int is_valid_time (const char *time, size_t length);
+static int is_valid_numeric (const char *str, size_t length, int expected_length);
+static int is_valid_number (const char *str, size_t length, int allow_negative);
+static int utc_time_parser (gps_time_t * gps_time, const char *time_str, size_t length);	// function to validate and parse time in utc format 
+static int coordinate_field_parser (const char *str, size_t length, int expected_length, coordinate_parts_t *parts);	// function to validate and split latitude and longitude
+static float coordinate_degrees (const coordinate_parts_t *parts);	// function to convert split latitude and longitude in degrees
+static int32_t coordinate_e7 (const coordinate_parts_t *parts);	// function to convert split latitude and longitude in 1e-7 degrees
+static float longitude_latitude_parser (const char *str, size_t length);	// function to parse latitude and longitude in degrees
+static int32_t longitude_latitude_fixed_point_parser (const char *str, size_t length);	// function to parse latitude and longitude in 1e-7 degrees
+static int decimal_fixed_point_parser (const char *str, size_t length, int scale_digits, int allow_negative, int32_t *value);
+static int decimal_float_parser (const char *str, size_t length, int allow_negative, float *value);	// function to validate and parse a real number field
+static int decimal_int_parser (const char *str, size_t length, int *value);	// function to validate and parse an integer field
+static int coordinate_direction (gps_nmea_span_t direction, int is_longitude, char *hemisphere);
+static gps_parse_result_t gga_sentence_decode (gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_data_parse_t *gps_data);
 void gps_fix_quality_description (int gps_quality_fix);	//public function to tell GPS fix quality
+
+/**
+ * @brief Initializes a caller-owned parser context.
+ *
+ * @param ctx The parser context to initialize.
+ */ 
+void gps_parser_init (gps_parser_ctx_t *ctx)
+{
+    memset (ctx, 0, sizeof (*ctx));
+    ctx->decode_flags = GPS_DECODE_FLOAT;
+    ctx->gga_fields = GPS_GGA_FIELD_ALL;
+}
+
+/**
+ * @brief Parses the first GGA sentence of a UART stream into caller-owned storage.
+ *
+ * No heap memory is used and all working state lives in ctx, so any number of tasks
+ * can parse concurrently as long as each one uses its own context. Nothing is printed,
+ * the outcome is reported by the return value (see GPS_PARSER_LOG_ENABLED for diagnostics).
+ *
+ * @param ctx The parser context used as working storage.
+ * @param uart_stream The input string containing GPS data.
+ * @param gps_data The structure that receives the parsed GPS data.
+ * @return Returns GPS_PARSE_OK or GPS_PARSE_INVALID_FIELD if a GGA sentence was decoded, otherwise a
+ *         negative gps_parse_result_t (gps_data is set to default values).
+ */ 
+gps_parse_result_t gps_data_parse (gps_parser_ctx_t *ctx, const char *uart_stream, gps_data_parse_t *gps_data)
+{ 
+    // A NULL or empty stream is rejected by gps_data_parse_buffer()
+    size_t stream_length = check_stream_NULL_Empty (uart_stream) ? 0 : strlen (uart_stream);
+    return gps_data_parse_buffer (ctx, uart_stream, stream_length, gps_data);
+}
+
+/**
+ * @brief Parses the first GGA sentence of a buffer of known length, without copying or modifying it.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param buffer The bytes received from the GPS module, not necessarily NUL-terminated.
+ * @param stream_length Length of buffer in bytes.
+ * @param gps_data The structure that receives the parsed GPS data.
+ * @return As gps_data_parse().
+ */
+gps_parse_result_t gps_data_parse_buffer (gps_parser_ctx_t *ctx, const char *buffer, size_t stream_length, gps_data_parse_t *gps_data)
+{
+    ctx->invalid_fields = 0;
+
+    // Check if the UART stream is NOT empty or Not NULL
+    if (buffer == NULL || stream_length == 0){
+        GPS_PARSER_LOGE ("Invalid Input String");
+        // The stream is invalid (either NULL or empty), so return default GPS data
+        gps_gga_set_defaults (gps_data);
+        gps_stats_count (ctx, 0, -1, GPS_PARSE_ERR_FORMAT);
+        return GPS_PARSE_ERR_FORMAT;
+    }
+
+    // process stream if it is not null or empty: find the first GGA with a valid checksum in one pass
+    size_t index = 0, length = 0;
+    gps_parse_result_t found = gga_sentence_resync (buffer, stream_length, &index, &length);
+    if (found != GPS_PARSE_OK){
+        GPS_PARSER_LOGE ("%s", (found == GPS_PARSE_ERR_CHECKSUM) ? "Invalid CheckSum" : "Invalid NMEA 0183 Sentence");
+        // No intact GGA sentence in the stream, so return default GPS data
+        gps_gga_set_defaults (gps_data);
+        gps_stats_count (ctx, stream_length, -1, found);
+        return found;
+    }
+
+    // The stream is consumed up to the CRLF of the GGA sentence, which is decoded where it lies
+    size_t consumed = index + length + 2;
+    gps_parse_result_t result = gga_sentence_decode (ctx, buffer + index, length, gps_data);
+    gps_stats_count (ctx, consumed, GPS_SENTENCE_GGA, result);
+    return result;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Counters
+//====================================================================================================================================================================================================================================================================
+
+static const char *const s_stat_names[GPS_STAT_COUNT] = {
+    [GPS_STAT_BYTES] = "bytes",
+    [GPS_STAT_UNSUPPORTED] = "unsupported",
+    [GPS_STAT_GGA] = "gga",
+    [GPS_STAT_RMC] = "rmc",
+    [GPS_STAT_GSA] = "gsa",
+    [GPS_STAT_GSV] = "gsv",
+    [GPS_STAT_VTG] = "vtg",
+    [GPS_STAT_GLL] = "gll",
+    [GPS_STAT_CHECKSUM_ERRORS] = "checksum_errors",
+    [GPS_STAT_FORMAT_ERRORS] = "format_errors",
+    [GPS_STAT_FIELD_COUNT_ERRORS] = "field_count_errors",
+    [GPS_STAT_FIELD_ERRORS] = "field_errors",
+};
+
+// The per-type counters follow gps_sentence_type_t, GPS_SENTENCE_UNKNOWN counting as unsupported
+_Static_assert (GPS_STAT_GLL - GPS_STAT_UNSUPPORTED == GPS_SENTENCE_GLL && GPS_SENTENCE_GLL + 1 == GPS_SENTENCE_TYPE_COUNT,
+                "gps_stat_t and gps_sentence_type_t are out of step");
+
+void gps_stats_count (gps_parser_ctx_t *ctx, size_t bytes, int type, gps_parse_result_t result)
+{
+    if (bytes != 0)
+        gps_stat_add (ctx, GPS_STAT_BYTES, (uint32_t) bytes);
+    if (type >= 0)
+        gps_stat_add (ctx, (gps_stat_t) (GPS_STAT_UNSUPPORTED + type), 1);
+
+    switch (result){
+        case GPS_PARSE_INVALID_FIELD:{
+            uint32_t fields = 0;
+            for (uint32_t mask = ctx->invalid_fields; mask != 0; mask &= mask - 1)
+                fields++;
+            gps_stat_add (ctx, GPS_STAT_FIELD_ERRORS, fields);
+            break;
+        }
+        case GPS_PARSE_ERR_FORMAT: gps_stat_add (ctx, GPS_STAT_FORMAT_ERRORS, 1); break;
+        case GPS_PARSE_ERR_CHECKSUM: gps_stat_add (ctx, GPS_STAT_CHECKSUM_ERRORS, 1); break;
+        case GPS_PARSE_ERR_FIELD_COUNT: gps_stat_add (ctx, GPS_STAT_FIELD_COUNT_ERRORS, 1); break;
+        default: break;
+    }
+}
+
+void gps_parser_stats_snapshot (const gps_parser_ctx_t *ctx, gps_parser_stats_t *stats)
+{
+    for (int i = 0; i < GPS_STAT_COUNT; i++)
+        stats->value[i] = atomic_load_explicit (&ctx->stats[i], memory_order_relaxed) - ctx->stats_base[i];
+}
+
+void gps_parser_stats_reset (gps_parser_ctx_t *ctx)
+{
+    for (int i = 0; i < GPS_STAT_COUNT; i++)
+        ctx->stats_base[i] = atomic_load_explicit (&ctx->stats[i], memory_order_relaxed);
+}
+
+const char * gps_parser_stat_name (gps_stat_t stat)
+{
+    return ((unsigned) stat < GPS_STAT_COUNT) ? s_stat_names[stat] : "";
+}
+
+/**
+ * @brief Parses one framed GGA sentence whose checksum has already been verified.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param sentence The sentence from '$' up to the checksum digits, without CRLF.
+ * @param length Length of sentence in bytes.
+ * @param gps_data The structure that receives the parsed GPS data.
+ * @return Returns GPS_PARSE_OK or GPS_PARSE_INVALID_FIELD if the GGA sentence was decoded, otherwise a
+ *         negative gps_parse_result_t (gps_data is set to default values).
+ */ 
+gps_parse_result_t gps_gga_sentence_parse (gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_data_parse_t *gps_data)
+{
+    ctx->invalid_fields = 0;
+
+    // framed sentences: their bytes were counted by the framer
+    if (sentence == NULL || length < 7 || sentence[0] != '$' || sentence[6] != ','){
+        gps_gga_set_defaults (gps_data);
+        gps_stats_count (ctx, 0, -1, GPS_PARSE_ERR_FORMAT);
+        return GPS_PARSE_ERR_FORMAT;
+    }
+    gps_sentence_type_t type = gps_nmea_sentence_identify (sentence + 1, NULL);
+    if (type != GPS_SENTENCE_GGA){
+        gps_gga_set_defaults (gps_data);
+        gps_stats_count (ctx, 0, type, GPS_PARSE_ERR_UNSUPPORTED);
+        return GPS_PARSE_ERR_UNSUPPORTED;
+    }
+
+    gps_parse_result_t result = gga_sentence_decode (ctx, sentence, length, gps_data);
+    gps_stats_count (ctx, 0, GPS_SENTENCE_GGA, result);
+    return result;
+}
+
 /**
  * @brief Parses a UART stream to extract GPS data.
  *
+ * Compatibility wrapper around gps_data_parse(); the returned structure is heap allocated
+ * and must be released by the caller with free().
+ *
  * @param uart_stream The input string containing GPS data.
- * @return A structure containing parsed GPS data.
+ * @return A structure containing parsed GPS data, NULL if it could not be allocated.
  */ 
 gps_data_parse_t * gps_data_parser (const char *uart_stream)
 { 
     gps_data_parse_t * gps_data = (gps_data_parse_t *) malloc (sizeof(gps_data_parse_t)); //dynamic memory allocation for structure members
     if(gps_data == NULL){
-        printf("\nMemory Allocation for gps_data_parse_t structure failed\n");
-    return NULL;
+        GPS_PARSER_LOGE ("Memory Allocation for gps_data_parse_t structure failed");
+        return NULL;
     }
-    else
-     printf("\nMemory allocated successfully\n");
     
-	// Check if the UART stream is NOT empty or Not NULL
-	if (!(check_stream_NULL_Empty (uart_stream))){
-	    
-		// Allocate memory for the UART stream buffer
-	    char *temp_buffer = (char *) malloc (Buffer_size * sizeof (char));
-	  
- 
-        if (temp_buffer != NULL){
-            // Copy the UART stream to the temporary buffer
-			strcpy (temp_buffer, uart_stream); 
-            
-        }
-	  
-	    else{
-		    fprintf (stderr, "Memory allocation failed for buffer\n");
-		    print_default_value(gps_data);
-		    return gps_data;
-		}
-	  
-	   	// process stream if it is not null or empty
-	     int index = gga_sentence_format_validity_check (temp_buffer);
-	  
- 
-        if (index != -1)
-		{   // if NMEA sentence is a valid GPGGA sentence then execute this if block code
-		    unsigned int length = s_crfl - index;	// Calculate the length of the substring
-		  memmove(temp_buffer, temp_buffer + index, length);            // Shift the substring to the start of the buffer
-            temp_buffer[length] = '\0';  
-    	    // calling checksum function to check integrity of data in GPGGA sentence
-    			
-    		if (check_sum_evaluation (temp_buffer)){
-    			  
-                int field_count = 0; // Counter for number of fields found
-    			  
-    	    	// Initialize pointers for the start and end of each field
-    	    	char *start = temp_buffer;
-    			  
-                char *end = temp_buffer;
-    			  
-            	// Iterate through the string and find each field
-    	    	while (*end != '\0')
-    				{
-    				  if (*end == ',' || *end == '*'){
-    					  
-    					    // Terminate the current field with a null character
-    						*end = '\0';
-    					    // Store the start of the field in the fields array
-    						fields[field_count] = start;
-    					    field_count++;
-    					  	// Move the start pointer to the character after the comma or asterisk
-    						start = end + 1;
-    				}   
-    				  
-                     end++;		// Move to the next character
-    				}
-    			  
-                	//check if total fields in GGA sentence are 15 either empty or populated
-    				if (field_count == 15){
-    				  
-        				  // Extract and format the time
-        			    if (!(is_valid_time (fields[1]))){
-        				      
-        					    // If the time field is invalid,empty set time to 255 or any default value
-        						gps_data->time.hour = DEFAULT_GPS_TIME_HR;
-        					  
-                                gps_data->time.minute = DEFAULT_GPS_TIME_MIN;
-        					  
-                                gps_data->time.second = DEFAULT_GPS_TIME_SEC;
-        					  
-                                gps_data->time.millisecond = DEFAULT_GPS_TIME_MS;
-        					
-                        }
-        				  
-        			    else{
-        					  // Format the time as HH:MM:SS.SSS using UTC time parser
-        					  utc_time_parser (gps_data);
-        				}
-    				  
-     
-                        if (!(is_valid_numeric (fields[2], 4)))	{
-    					  
-    						// If the latitude field is invalid,empty set latitude to -9999 or any default
-    						gps_data->latitude = DEFAULT_LATITUDE;
-    					}
-    					
-    				    else{
-    					  
-    					    // Process the altitude into degrees
-    						gps_data->latitude = longitude_latitude_parser (fields[2]);
-    					}
-    				  
-     
-                        if (fields[3] == NULL || strlen (fields[3]) == 0
-    						 || !(fields[3][0] == 'N' || fields[3][0] == 'n'
-    							  || fields[3][0] == 'S' || fields[3][0] == 's')){
-    					    // If the latitude direction field is invalid, set direction to any default character
-    						gps_data->lat_direction = DEFAULT_LAT_DIRECTION;
-    					}
-    				  
-                        else{
-    					  
-                            if (fields[3][0] == 'S' || fields[3][0] == 's'){
-    						  
-     
-                                gps_data->lat_direction = fields[3][0];
-                                
-    						    if(gps_data->latitude != DEFAULT_LATITUDE)
-                                    gps_data->latitude *= -1;
-    						}
-    					  
-     
-    					    else{
-    						      gps_data->lat_direction = fields[3][0];
-    						}
-                       }
-    				  
-                        if (!(is_valid_numeric (fields[4], 5))){
-    					  
-    						// If the longtude field is invalid,empty set longitude  to zero or any default
-    						gps_data->longitude = DEFAULT_LONGITUDE;
-    					}
-    				    else{
-    					    // Process the altitude into degrees
-    						gps_data->longitude = longitude_latitude_parser (fields[4]);
-    					}
-    				  
-     
-                        if (fields[5] == NULL || strlen (fields[5]) == 0
-    						 || !(fields[5][0] == 'E' || fields[5][0] == 'e'
-    							  || fields[5][0] == 'W' || fields[5][0] == 'w'))
-    					{
-    					  
-    						// If the longitude direction field is invalid,empty set direction to '-'  or any default character
-    						gps_data->lon_direction = DEFAULT_LON_DIRECTION;
-    					
-                        }
-    				  
-    				    else
-    					{
-    					    if (fields[5][0] == 'W' || fields[5][0] == 'w')
-    						{
-    						  gps_data->lon_direction = fields[5][0];
-    						  
-    						  if(gps_data -> longitude != DEFAULT_LONGITUDE)
-                                gps_data->longitude *= -1;
-    						}
-    					    else{
-    						  gps_data->lon_direction = fields[5][0];
-    						}
-    					
-                        }
-    				  
-     
-                        if (fields[6] == NULL || strlen (fields[6]) == 0
-    						 || !(is_valid_number (fields[6]))){
-    					  
-                            gps_data->fix_quality = DEFAULT_FIX_QUALITY;
-    					
-                        }
-    				  
-    				    else{
-    					   gps_data->fix_quality = atoi (fields[6]);
-    					
-                        }
-                        
-    				    if (fields[7] == NULL || strlen (fields[7]) == 0
-    						 || !(is_valid_number (fields[7]))){
-    					  
-    						// If the number of satellites field is invalid,empty set to -1  or any default character
-    						
-                            gps_data->num_satellites = DEFAULT_NUM_SATELLITES;
-    					}
-    				  
-                        else{
-    					    gps_data->num_satellites = atoi (fields[7]);
-    					}
-    				  
-                        if (fields[8] == NULL || strlen (fields[8]) == 0
-    						 || !(is_valid_number (fields[8])))
-    					{
-    					  
-    						// If the Horizontal Dilution of Precision field is invalid,empty then set to -1  or any default value
-    						gps_data->hdop = DEFAULT_HDOP;
-    					}
-    				  
-                        else{
-    					
-    					  gps_data->hdop = strtof (fields[8], NULL);
-    					
-                        }
-    				  
-     
-                        if (fields[9] == NULL || strlen (fields[9]) == 0
-    						 || !(is_valid_number (fields[9])))
-    					{
-    					  
-    						// If the Mean Sea Level Altitude field is invalid,empty then set to -999999  or any default value
-    						gps_data->altitude = DEFAULT_ALTITUDE;
-    					}
-    				  
-     
-    				    else{
-    					
-    					    gps_data->altitude = strtof (fields[9], NULL);
-    					
-                        }
-    				  
-     
-                        if (fields[10] == NULL || strlen (fields[10]) == 0
-    						 || (fields[10][0] != 'M'))
-    					{
-    					    // If the Mean Sea Level Altitude unit  field is invalid,empty then set to -  or any default character
-    						gps_data->altitude_units = DEFAULT_ALTITUDE_UNITS;
-    					}
-    				  
-     
-    				    else{
-    					    gps_data->altitude_units = fields[10][0];	// meter 
-    					  
-                            #if USE_FEET_UNIT
-    						gps_data->altitude_units = 'F';	//set feet as unit
-    					    float data = gps_data->altitude;
-    					  
-                            gps_data->altitude = data * (3.28084);	// convert altitude from meters to feet
-                            #else
-    						gps_data->altitude *= 1;
-    					    #endif
-    					}
-    				  
-     
-                        if (fields[11] == NULL || strlen (fields[11]) == 0
-    						 || !(is_valid_number (fields[11])))
-    					{
-    					    // If geoid height  field is invalid,empty then set any default value
-    						gps_data->geoid_height = DEFAULT_GEOID_HEIGHT;
-    						//printf("GEOIDAL SEPARATION field is invalid ,setting to default value of 0\n");
-    					}
-    				  
-                        else{
-    					  
-                            gps_data->geoid_height = strtof (fields[11], NULL);
-    					}
-    				  
-     
-                        if (fields[12] == NULL || strlen (fields[12]) == 0
-    						 || (fields[12][0] != 'M'))
-    					{
-    					    // If the Mean Sea Level Altitude unit  field is invalid,empty then set to -  or any default character
-    						gps_data->geoid_height_units = DEFAULT_GEOID_HEIGHT_UNITS;
-     
-    						
-    					}
-    				  
-                        else{
-    					  
-                            gps_data->geoid_height_units = fields[12][0];	// meter 
-    					  
-                            #if USE_FEET_UNIT
-    						gps_data->geoid_height_units = 'F';	// set feet as unit
-    					    float data = gps_data->geoid_height;
-    					    gps_data->geoid_height = data * (3.28084);	// convert geoid height from meters to feet
-                            #else 
-    						gps_data->geoid_height *= 1;
-    					    #endif 
-     
-    					}
-    				  
-     
-                        if (fields[13] == NULL || strlen (fields[13]) == 0
-    						 || !(is_valid_number (fields[13])))
-    					{
-    					  
-     
-    						// If the differential gps age  field is invalid,empty then set to any default value
-    						gps_data->dgps_age = DEFAULT_DGPS_AGE;
-    					}
-    				  
-    				    else{
-    					  
-                            gps_data->dgps_age = strtof (fields[13], NULL);	// age in seconds
-    					}
-    				  
-                        if (fields[14] == NULL || strlen (fields[14]) == 0
-    						 || !(is_valid_number (fields[14])))
-    					{
-    					    // If the Station ID   field is invalid,empty then set to any default value
-    						gps_data->dgps_station_id = DEFAULT_DGPS_STATION_ID;
-    						
-    					}
-    				  
-    				    else{
-    					  
-                            gps_data->dgps_station_id = atoi(fields[14]);	// ID in numbers from 0 to 1023
-    				        
-    				   
-    				    } 
-     
-                    }
-    			  
-                	// if field count is invalid then print default values
-    		    	else{
-    				     printf("GGA sentence has an invalid number of fields. Resetting to default values.\n");
-    					 print_default_value (gps_data);
-    					 
-    		    	}
-			
-            }
-		  
-            else{
-			        ESP_LOGE (TAG, "Invalid CheckSum");
-			    	// The checksum is invalid, so return default GPS data
-				    print_default_value (gps_data);
-				    
-			}
-		
-        }
-	  
-        else{
-    		  ESP_LOGE (TAG, "Invalid NMEA 0183 Sentence");
-    		  // The sentence format is not according to GPGGA sentence, so return default GPS data
-    		  print_default_value (gps_data);
-    		  
-    		}
-	free(temp_buffer); // release allocated dynamic memory to avoid memory leaks 
-	temp_buffer = NULL;
-	
-	
-	}
-  
-    else{
-	       ESP_LOGE (TAG, "Invalid Input String");
-	  
-		// The stream is invalid (either NULL or empty), so return default GPS data
-		print_default_value (gps_data);
-		
-	}
+    gps_parser_ctx_t ctx;
+    gps_parser_init (&ctx);
+    gps_data_parse (&ctx, uart_stream, gps_data);
   
     // Return the GPS data structure (either populated or default)
 	return gps_data;
+}
 
- 
+/**
+ * @brief Tokenizes a GGA sentence into ctx and decodes its fields.
+ *
+ * @param ctx The parser context used as working storage.
+ * @param sentence The GGA sentence, only read.
+ * @param length Length of sentence in bytes.
+ * @param gps_data The structure that receives the parsed GPS data.
+ * @return Returns GPS_PARSE_OK or GPS_PARSE_INVALID_FIELD if the sentence has 15 fields and was decoded,
+ *         GPS_PARSE_ERR_FORMAT if it is too long, otherwise GPS_PARSE_ERR_FIELD_COUNT.
+ */ 
+static gps_parse_result_t gga_sentence_decode (gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_data_parse_t *gps_data)
+{
+    //check if total fields in GGA sentence are 15 either empty or populated
+    int field_count = gps_nmea_tokenize (ctx, sentence, length);
+    if (field_count != GGA_FIELD_COUNT){
+        GPS_PARSER_LOGE ("GGA sentence has %d fields instead of %d", field_count, GGA_FIELD_COUNT);
+        gps_gga_set_defaults (gps_data);
+        return (field_count < 0) ? GPS_PARSE_ERR_FORMAT : GPS_PARSE_ERR_FIELD_COUNT;
+    }
+
+    ctx->invalid_fields = gps_gga_fields_decode (ctx, gps_data);
+    return (ctx->invalid_fields != 0) ? GPS_PARSE_INVALID_FIELD : GPS_PARSE_OK;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Field Decoders shared with the other sentence types (gps_parser_private.h)
+//====================================================================================================================================================================================================================================================================
+
+int gps_nmea_tokenize (gps_parser_ctx_t *ctx, const char *sentence, size_t length)
+{
+    if (length > GPS_NMEA_MAX_SENTENCE_LEN)
+        return -1;
+
+    // The sentence is not copied: fields are recorded as spans of the caller's buffer
+    ctx->sentence = sentence;
+
+    int field_count = 0; // Counter for number of fields found
+    size_t start = 0;
+    size_t end = 0;
+
+    // Jump from delimiter to delimiter, every delimiter ends a field (the checksum digits are not one)
+    while ((end += gps_nmea_scan_field (sentence + end, length - end)) != length)
+    {
+        // Extra fields are counted but not stored so field count checks reject them
+        if (field_count < GPS_NMEA_MAX_FIELDS){
+            ctx->field_offset[field_count] = (uint8_t) start;
+            ctx->field_length[field_count] = (uint8_t) (end - start);
+        }
+        field_count++;
+        // Move the start to the character after the comma or asterisk
+        start = ++end;
+    }
+
+    ctx->field_count = field_count;
+    return field_count;
+}
+
+gps_nmea_span_t gps_nmea_field (const gps_parser_ctx_t *ctx, int index)
+{
+    gps_nmea_span_t field = { "", 0 };
+
+    if (index < ctx->field_count && index < GPS_NMEA_MAX_FIELDS){
+        field.data = ctx->sentence + ctx->field_offset[index];
+        field.length = ctx->field_length[index];
+    }
+    return field;
+}
+
+int gps_field_decode_time (gps_nmea_span_t field, gps_time_t *time)
+{
+    // The field is validated and converted in one pass
+    if (!(utc_time_parser (time, field.data, field.length))){
+        // If the time field is invalid,empty set time to 255 or any default value
+        time->hour = DEFAULT_GPS_TIME_HR;
+        time->minute = DEFAULT_GPS_TIME_MIN;
+        time->second = DEFAULT_GPS_TIME_SEC;
+        time->millisecond = DEFAULT_GPS_TIME_MS;
+        return 0;
+    }
+    return 1;
+}
+
+int gps_field_decode_coordinate (gps_nmea_span_t value, gps_nmea_span_t direction, int is_longitude, float *coordinate, char *hemisphere)
+{
+    coordinate_parts_t parts;
+    int valid = coordinate_field_parser (value.data, value.length, is_longitude ? 5 : 4, &parts);
+
+    // Process the latitude or longitude into degrees, invalid or empty values are set to the default
+    *coordinate = valid ? coordinate_degrees (&parts) : (is_longitude ? DEFAULT_LONGITUDE : DEFAULT_LATITUDE);
+
+    if (coordinate_direction (direction, is_longitude, hemisphere) < 0 && valid)
+        *coordinate *= -1;
+
+    return valid;
+}
+
+int gps_field_decode_coordinate_e7 (gps_nmea_span_t value, gps_nmea_span_t direction, int is_longitude, int32_t *coordinate, char *hemisphere)
+{
+    coordinate_parts_t parts;
+    int valid = coordinate_field_parser (value.data, value.length, is_longitude ? 5 : 4, &parts);
+
+    *coordinate = valid ? coordinate_e7 (&parts) : (is_longitude ? DEFAULT_LONGITUDE_E7 : DEFAULT_LATITUDE_E7);
+
+    if (coordinate_direction (direction, is_longitude, hemisphere) < 0 && valid)
+        *coordinate *= -1;
+
+    return valid;
+}
+
+int gps_field_decode_fixed_point (gps_nmea_span_t field, int scale_digits, int allow_negative, int32_t default_value, int32_t *value)
+{
+    if (!(decimal_fixed_point_parser (field.data, field.length, scale_digits, allow_negative, value))){
+        *value = default_value;
+        return 0;
+    }
+    return 1;
+}
+
+int gps_field_decode_float (gps_nmea_span_t field, int allow_negative, float default_value, float *value)
+{
+    if (field.length == 0 || !(decimal_float_parser (field.data, field.length, allow_negative, value))){
+        *value = default_value;
+        return 0;
+    }
+    return 1;
+}
+
+int gps_field_decode_int (gps_nmea_span_t field, int default_value, int *value)
+{
+    if (field.length == 0 || !(decimal_int_parser (field.data, field.length, value))){
+        *value = default_value;
+        return 0;
+    }
+    return 1;
+}
+
+uint32_t gps_gga_field_decode (const gps_nmea_span_t *fields, uint32_t field, uint32_t decode_flags, gps_data_parse_t *gps_data)
+{
+    uint32_t invalid = 0;
+
+    switch (field){
+        case GPS_GGA_FIELD_TIME:
+            invalid |= gps_field_invalid (fields[1], 1, gps_field_decode_time (fields[1], &gps_data->time));
+            break;
+
+        case GPS_GGA_FIELD_LATITUDE:
+            if (decode_flags & GPS_DECODE_FLOAT)
+                invalid |= gps_field_invalid (fields[2], 2, gps_field_decode_coordinate (fields[2], fields[3], 0, &gps_data->latitude, &gps_data->lat_direction));
+            if (decode_flags & GPS_DECODE_FIXED_POINT)
+                invalid |= gps_field_invalid (fields[2], 2, gps_field_decode_coordinate_e7 (fields[2], fields[3], 0, &gps_data->latitude_e7, &gps_data->lat_direction));
+            // An unrecognised hemisphere leaves the direction at its default character
+            invalid |= gps_field_invalid (fields[3], 3, gps_data->lat_direction != DEFAULT_LAT_DIRECTION);
+            break;
+
+        case GPS_GGA_FIELD_LONGITUDE:
+            if (decode_flags & GPS_DECODE_FLOAT)
+                invalid |= gps_field_invalid (fields[4], 4, gps_field_decode_coordinate (fields[4], fields[5], 1, &gps_data->longitude, &gps_data->lon_direction));
+            if (decode_flags & GPS_DECODE_FIXED_POINT)
+                invalid |= gps_field_invalid (fields[4], 4, gps_field_decode_coordinate_e7 (fields[4], fields[5], 1, &gps_data->longitude_e7, &gps_data->lon_direction));
+            invalid |= gps_field_invalid (fields[5], 5, gps_data->lon_direction != DEFAULT_LON_DIRECTION);
+            break;
+
+        case GPS_GGA_FIELD_FIX_QUALITY:
+            invalid |= gps_field_invalid (fields[6], 6, gps_field_decode_int (fields[6], DEFAULT_FIX_QUALITY, &gps_data->fix_quality));
+            break;
+
+        case GPS_GGA_FIELD_SATELLITES:
+            invalid |= gps_field_invalid (fields[7], 7, gps_field_decode_int (fields[7], DEFAULT_NUM_SATELLITES, &gps_data->num_satellites));
+            break;
+
+        case GPS_GGA_FIELD_HDOP:
+            if (decode_flags & GPS_DECODE_FLOAT)
+                invalid |= gps_field_invalid (fields[8], 8, gps_field_decode_float (fields[8], 0, DEFAULT_HDOP, &gps_data->hdop));
+            if (decode_flags & GPS_DECODE_FIXED_POINT){
+                int32_t hdop_x100;
+                int hdop_valid = gps_field_decode_fixed_point (fields[8], 2, 0, DEFAULT_HDOP_X100, &hdop_x100) && hdop_x100 < DEFAULT_HDOP_X100;
+                if (hdop_valid)
+                    gps_data->hdop_x100 = (uint16_t) hdop_x100;
+                invalid |= gps_field_invalid (fields[8], 8, hdop_valid);
+            }
+            break;
+
+        case GPS_GGA_FIELD_ALTITUDE:
+            if (decode_flags & GPS_DECODE_FLOAT)
+                invalid |= gps_field_invalid (fields[9], 9, gps_field_decode_float (fields[9], 1, DEFAULT_ALTITUDE, &gps_data->altitude));	// altitude may be negative
+            if (decode_flags & GPS_DECODE_FIXED_POINT)
+                invalid |= gps_field_invalid (fields[9], 9, gps_field_decode_fixed_point (fields[9], 3, 1, DEFAULT_ALTITUDE_MM, &gps_data->altitude_mm));
+            if (gps_field_char (fields[10]) == 'M'){
+                gps_data->altitude_units = 'M';	// meter 
+                #if USE_FEET_UNIT
+                gps_data->altitude_units = 'F';	//set feet as unit
+                if ((decode_flags & GPS_DECODE_FLOAT) && gps_data->altitude != DEFAULT_ALTITUDE)
+                    gps_data->altitude = gps_data->altitude * (3.28084);	// convert altitude from meters to feet
+                #endif
+            }
+            invalid |= gps_field_invalid (fields[10], 10, gps_field_char (fields[10]) == 'M');
+            break;
+
+        case GPS_GGA_FIELD_GEOID_HEIGHT:
+            if (decode_flags & GPS_DECODE_FLOAT)
+                invalid |= gps_field_invalid (fields[11], 11, gps_field_decode_float (fields[11], 1, DEFAULT_GEOID_HEIGHT, &gps_data->geoid_height));	// geoid separation may be negative
+            if (decode_flags & GPS_DECODE_FIXED_POINT)
+                invalid |= gps_field_invalid (fields[11], 11, gps_field_decode_fixed_point (fields[11], 3, 1, DEFAULT_GEOID_HEIGHT_MM, &gps_data->geoid_height_mm));
+            if (gps_field_char (fields[12]) == 'M'){
+                gps_data->geoid_height_units = 'M';	// meter 
+                #if USE_FEET_UNIT
+                gps_data->geoid_height_units = 'F';	// set feet as unit
+                if ((decode_flags & GPS_DECODE_FLOAT) && gps_data->geoid_height != DEFAULT_GEOID_HEIGHT)
+                    gps_data->geoid_height = gps_data->geoid_height * (3.28084);	// convert geoid height from meters to feet
+                #endif 
+            }
+            invalid |= gps_field_invalid (fields[12], 12, gps_field_char (fields[12]) == 'M');
+            break;
+
+        case GPS_GGA_FIELD_DGPS:
+            if (decode_flags & GPS_DECODE_FLOAT)
+                invalid |= gps_field_invalid (fields[13], 13, gps_field_decode_float (fields[13], 0, DEFAULT_DGPS_AGE, &gps_data->dgps_age));	// age in seconds
+            invalid |= gps_field_invalid (fields[14], 14, gps_field_decode_int (fields[14], DEFAULT_DGPS_STATION_ID, &gps_data->dgps_station_id));	// ID in numbers from 0 to 1023
+            break;
+
+        default:
+            break;
+    }
+    return invalid;
+}
+
+uint32_t gps_gga_fields_decode (const gps_parser_ctx_t *ctx, gps_data_parse_t *gps_data)
+{
+    gps_nmea_span_t fields[GGA_FIELD_COUNT];
+    uint32_t invalid = 0;
+
+    for (int i = 0; i < GGA_FIELD_COUNT; i++)
+        fields[i] = gps_nmea_field (ctx, i);
+
+    // Members of a decode mode or field group that is not selected keep their default values
+    gps_gga_set_defaults (gps_data);
+
+    for (uint32_t field = GPS_GGA_FIELD_TIME; field & GPS_GGA_FIELD_ALL; field <<= 1){
+        if (ctx->gga_fields & field)
+            invalid |= gps_gga_field_decode (fields, field, ctx->decode_flags, gps_data);
+    }
+    gps_data->utc_ms = gps_utc_ms (ctx, &gps_data->time);
+    gps_data->rx_time = ctx->rx_time;
+
+    return invalid;
+}
+
+// Days from 1970-01-01 to a date of the proleptic Gregorian calendar
+static int64_t days_from_civil (int year, int month, int day)
+{
+    year -= (month <= 2);
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return (int64_t) era * 146097 + day_of_era - 719468;
+}
+
+void gps_utc_date_update (gps_parser_ctx_t *ctx, int year, int month, int day, const gps_time_t *time)
+{
+    uint32_t date = ((uint32_t) year << 9) | ((uint32_t) month << 5) | (uint32_t) day;
+
+    // the calendar conversion only runs when the date changes, once a day
+    if (date != ctx->utc_date){
+        ctx->utc_date = date;
+        ctx->utc_day_start_ms = days_from_civil (year, month, day) * GPS_MS_PER_DAY;
+    }
+    ctx->utc_date_time_ms = gps_time_utc_ms (time);
+}
+
+int64_t gps_utc_ms (const gps_parser_ctx_t *ctx, const gps_time_t *time)
+{
+    if (ctx->utc_date == 0 || time->hour == DEFAULT_GPS_TIME_HR)
+        return DEFAULT_UTC_MS;
+
+    // a time of day more than 12 hours before the dated one is past the next midnight, e.g. a GGA
+    // at 00:00:00 before the first RMC of the day, one more than 12 hours after it is before the last one
+    int64_t time_ms = gps_time_utc_ms (time);
+    int64_t elapsed = time_ms - ctx->utc_date_time_ms;
+    if (elapsed < -GPS_MS_PER_DAY / 2)
+        time_ms += GPS_MS_PER_DAY;
+    else if (elapsed > GPS_MS_PER_DAY / 2)
+        time_ms -= GPS_MS_PER_DAY;
+    return ctx->utc_day_start_ms + time_ms;
 }
 
 //====================================================================================================================================================================================================================================================================
@@ -412,17 +545,23 @@ int check_stream_NULL_Empty (const char *uart_stream)
  * @brief Checks the validity of format of NMEA string.
  *
  * @param uart_stream The UART stream to check.
+ * @param crlf_index Receives the index at which the \r\n terminating the GGA sentence starts.
  * @return Returns starting index of $GPGGA sentence if it finds GGA sentence and also it finds CRLF at end of GGA sentence and no $ in between which can occurs if there is power instability to GPS module,otherwise it returns -1 if not valid GGA sentence format.
  */ 
   
  
-int gga_sentence_format_validity_check (const char *uart_stream)
+int gga_sentence_format_validity_check (const char *uart_stream, int *crlf_index)
 {
-
-  const char *substring_gga = strstr (uart_stream, "$GPGGA,");	// Check if the substring "$GPGGA," is found
+  // Look for a '$' followed by a GGA address of any supported talker (GPGGA, GNGGA, GLGGA, ...)
+  const char *substring_gga = strchr (uart_stream, '$');
+  while (substring_gga != NULL
+         && !(gps_nmea_sentence_identify (substring_gga + 1, NULL) == GPS_SENTENCE_GGA && substring_gga[6] == ','))
+	{
+	  substring_gga = strchr (substring_gga + 1, '$');
+	}
   if (substring_gga == NULL)
 	{
-	  printf ("Error: GGA sentence not found in uart_stream.\n");
+	  GPS_PARSER_LOGD ("GGA sentence not found in uart_stream");
 	  return -1;
 	}
   
@@ -430,20 +569,71 @@ int gga_sentence_format_validity_check (const char *uart_stream)
   const char *rn_string = strstr (substring_gga, "\r\n");
   if (rn_string == NULL)
 	{
-	  printf ("Error: Expected \\r\\n not found after GGA sentence.\n");
+	  GPS_PARSER_LOGD ("Expected \\r\\n not found after GGA sentence");
 	  return -1;
 	}
   
     int gga_pos = (substring_gga - uart_stream);
-    s_crfl = (rn_string - uart_stream);	//position at which \r\n starts
-    // Print the GGA sentence
-    printf ("GGA sentence found: %.*s\n", (int) (rn_string - substring_gga + 2),substring_gga);
-    
-    // printf ("length of gga sentence is: %d\n", (rn_string - substring_gga));
+    *crlf_index = (rn_string - uart_stream);	//position at which \r\n starts
+    GPS_PARSER_LOGD ("GGA sentence found: %.*s", (int) (rn_string - substring_gga), substring_gga);
     
 	return gga_pos;	// Return index at which $GPGGA starts
 }
 
+/**
+ * @brief Finds the first GGA sentence of a stream with a valid checksum and CRLF, skipping corrupted ones.
+ *
+ * The stream is walked once: memchr() jumps to the next '$' and, behind a GGA address, the body
+ * is scanned up to its '*' while the checksum is accumulated. A rejected candidate resumes the
+ * search at the byte that ended its body, so a '$' interrupting a sentence cut by a power glitch
+ * starts the next candidate, and no byte is scanned twice. Only the 6 byte address after a '$'
+ * is looked at ahead of the scan, so the work is O(n) on any input.
+ *
+ * @param stream The stream, not necessarily NUL-terminated.
+ * @param stream_length Length of stream in bytes.
+ * @param start Receives the index of the '$' of the sentence.
+ * @param length Receives the length of the sentence up to its checksum digits, without CRLF.
+ * @return GPS_PARSE_OK if a sentence was found, otherwise the rejection of the first GGA sentence
+ *         (GPS_PARSE_ERR_CHECKSUM or GPS_PARSE_ERR_FORMAT), GPS_PARSE_ERR_FORMAT if there is none.
+ */
+gps_parse_result_t gga_sentence_resync (const char *stream, size_t stream_length, size_t *start, size_t *length)
+{
+    gps_parse_result_t rejection = GPS_PARSE_INCOMPLETE;
+    size_t i = 0;
+
+    while (i < stream_length)
+    {
+        const char *dollar = memchr (stream + i, '$', stream_length - i);
+        if (dollar == NULL)
+            break;
+        size_t begin = (size_t) (dollar - stream);
+        i = begin + 1;
+        if (stream_length - begin < 7 || dollar[6] != ',' || gps_nmea_sentence_identify (dollar + 1, NULL) != GPS_SENTENCE_GGA)
+            continue;
+
+        // body up to '*', or up to the '$', CR or LF that cut it short
+        uint8_t checksum;
+        size_t end = i + gps_nmea_scan_checksum (stream + i, stream_length - i, &checksum);
+        i = end;
+        gps_parse_result_t result = GPS_PARSE_ERR_FORMAT;
+        if (end + 4 < stream_length && stream[end] == '*' && end + 3 - begin <= GPS_NMEA_MAX_SENTENCE_LEN){
+            i = end + 1;
+            if (gps_nmea_hex_byte (stream + end + 1) != checksum)
+                result = GPS_PARSE_ERR_CHECKSUM;
+            else if (stream[end + 3] == '\r' && stream[end + 4] == '\n'){
+                *start = begin;
+                *length = end + 3 - begin;
+                return GPS_PARSE_OK;
+            }
+        }
+        GPS_PARSER_LOGD ("GGA sentence at %u rejected, resynchronizing at %u", (unsigned) begin, (unsigned) i);
+        if (rejection == GPS_PARSE_INCOMPLETE)
+            rejection = result;
+    }
+
+    return (rejection == GPS_PARSE_INCOMPLETE) ? GPS_PARSE_ERR_FORMAT : rejection;
+}
+
 /**
  * @brief Evaluates the checksum of an NMEA sentence.
  *
@@ -453,16 +643,16 @@ int gga_sentence_format_validity_check (const char *uart_stream)
 int check_sum_evaluation (const char *sentence)
 {
     // Initialize the calculated checksum variable
-    unsigned char calculated_checksum = 0;
-    int index = 0;
-  
-    // Iterate over the sentence starting after '$' until '*' or end of string
-    // Calculate the checksum using XOR operation
-    for (index = 1; sentence[index] != '*' && sentence[index] != '\0';
-		 index++)
-	{
-	  calculated_checksum ^= sentence[index];
-	}
+    uint8_t calculated_checksum = 0;
+    size_t length = strlen (sentence);
+
+    if (length == 0){
+        return 0;
+    }
+
+    // Scan the sentence starting after '$' until '*' (or a line or sentence break),
+    // calculating the XOR checksum a block of bytes at a time
+    size_t index = 1 + gps_nmea_scan_checksum (sentence + 1, length - 1, &calculated_checksum);
   
     // Check if we reached the end of the sentence without finding '*'
 	// Return 0 if '*' was not found, indicating invalid checksum
@@ -470,13 +660,10 @@ int check_sum_evaluation (const char *sentence)
 	  return 0;
 	}
   
-    // Move past the asterisk to the expected checksum part of the sentence
-    const char *checksum_ptr = sentence + index + 1;
-  
-    // Parse the expected checksum from the sentence (2 hex digits)
-    unsigned int expected_checksum;
+    // Parse the expected checksum following the asterisk (2 hex digits)
+    int expected_checksum = gps_nmea_hex_byte (sentence + index + 1);
     
-    if (sscanf (checksum_ptr, "%2X", &expected_checksum) != 1){
+    if (expected_checksum < 0){
 	  
 		// Return 0 if the expected checksum could not be parsed successfully
 		return 0;
@@ -488,246 +675,179 @@ int check_sum_evaluation (const char *sentence)
 
 }
 
+/**
+ * @brief Validates a DDMM.MMMM (latitude) or DDDMM.MMMM (longitude) field and splits it in the same pass.
+ *
+ * The string must consist of digits and one decimal point, with expected_length digits before the
+ * point, and the degrees (first 2 or 3 digits) must not exceed 90 or 180.
+ *
+ * @param str The string to validate, not necessarily NUL-terminated.
+ * @param length Length of the string in bytes.
+ * @param expected_length The expected length of the string up to the decimal point.
+ * @param parts Receives DDMM or DDDMM and the first 9 decimal digits of the minutes, only meaningful if valid.
+ * @return int Returns 1 if the string is valid, otherwise returns 0.
+ */ 
+int coordinate_field_parser (const char *str, size_t length, int expected_length, coordinate_parts_t *parts)
+{
+    if (str == NULL || length == 0) // return 0 if string is empty or NULL
+        return 0;
+    const char *end = str + length;
+    int digits = 0;
+
+    parts->whole = 0;
+    parts->fraction = 0;
+    parts->scale = 1;
+
+    // digits before the decimal point, no more than expected
+    for (; str < end && *str >= '0' && *str <= '9'; str++){
+        if (++digits > expected_length)
+            return 0;
+        parts->whole = parts->whole * 10 + (*str - '0');
+    }
+    if (digits != expected_length || str == end || *str != '.')
+        return 0;
+
+    // decimal digits of the minutes, past the 9th they are below 1e-9 minute and cannot change the result
+    for (str++; str < end; str++){
+        if (*str < '0' || *str > '9')
+            return 0;
+        if (parts->scale < 1000000000){
+            parts->fraction = parts->fraction * 10 + (*str - '0');
+            parts->scale *= 10;
+        }
+    }
+
+    return (parts->whole / 100 <= ((expected_length == 5) ? 180 : 90)) ? 1 : 0;
+}
+
 /**
  * @brief Validates a string to ensure it consists of digits and a decimal point.
  *
  * This function checks whether a given string contains only digits and at most one decimal point.
  * It also ensures that the length of the string up to the first decimal point matches the expected length.
  *
- * @param str The string to validate.
+ * @param str The string to validate, not necessarily NUL-terminated.
+ * @param str_length Length of the string in bytes.
  * @param expected_length The expected length of the string up to the first decimal point.
  * @return int Returns 1 if the string is valid, otherwise returns 0.
  */ 
-int is_valid_numeric (const char *str, int expected_length)
+int is_valid_numeric (const char *str, size_t str_length, int expected_length)
 {
-    if (str == NULL || str[0] == '\0') // return 0 if string is empty or NULL
-	    return 0;
-    // Initialize variables to track the number of dots and the length of the string
-    int dot_count = 0;
-  
-    int length = 0;
-    int d_length = 0;
-    char output1[4] = { 0 };
-    char output2[3] = { 0 };
-    int value = 0;
-  
-    if (expected_length == 5){
-	  
-        sprintf (output1, "%.3s", str);
-	    value = atoi (output1);
-	}
-  
-    if (expected_length == 4){
-	    sprintf (output2, "%.2s", str);
-	    value = atoi (output2);
-	}
-  
-    // Iterate through the string
-	while (*str)
-	{
-	  
-		// Check if the current character is not a digit
-		if (!isdigit ((int) *str))
-		{
-		  
-			// Check if the character is a dot and if no dot has been found yet
-			if (*str == '.' && dot_count == 0)
-			{
-			    d_length = length;
-			    dot_count++;
-			}
-		    else{
-			    // If the character is neither a digit nor a valid dot, return 0 (invalid)
-				return 0;
-			}
-		}
-	  
-	// Increment the length counter
-	length++;
-	  
-	// Move to the next character
-	str++;
-	
-    }
-    
-    // Check if the length of the numeric string matches the expected length
-	if (d_length != expected_length){
-	 
-	    return 0; // Invalid length
-	}
-  
-    if ((value > 180) && (expected_length == 5)){
-	  
-	    return 0;
-	}
-  
-    if ((value > 90) && (expected_length == 4)){
-	  
-        return 0;
-	}
-  
- 
-	// Return 1 if all characters are valid and length is correct
-	return 1;
+    coordinate_parts_t parts;
+    return coordinate_field_parser (str, str_length, expected_length, &parts);
 }
 
 // Function to validate a time field in HHMMSS.SSS format
   
-int is_valid_time (const char *time)
+int is_valid_time (const char *time, size_t length)
 {
-    if (time == NULL)
-	    return 0;
-    // First, check if the time format is valid and all characters are digits
-	for (int i = 0; i < 7; i++)
-	{
-	    if (i == 6)
-		{
-		    if (time[i] != '.')
-		    {
-			  
-                return 0;// Time should have a decimal point at position 6
-			}
-		
-        }
-	    else if (!isdigit ((int) time[i])){
-		    
-		    return 0;	// Invalid character found
-		}
-	
-    }
-  
-    // Parse hours, minutes, seconds from the time string
-    char hr_str[3], min_str[3], sec_str[3];
-  
-    strncpy (hr_str, time, 2);
-    strncpy (min_str, time + 2, 2);
-    strncpy (sec_str, time + 4, 2);
-      
-    hr_str[2] = min_str[2] = sec_str[2] = '\0';
-      
-    int hr = atoi (hr_str);
-    int min = atoi (min_str);
-    int sec = atoi (sec_str);
-  
-    // Validate the parsed values
-	if (hr > 23 || min > 59 || sec > 59 )
-	    
-	    return 0;
-    // All checks passed, return 1 indicating the time is valid
-	return 1;
-
+    gps_time_t parsed;
+    return utc_time_parser (&parsed, time, length);
 }
 
 // To check if given string is a number 
  
-int is_valid_number(const char *str)
+int is_valid_number(const char *str, size_t length, int allow_negative)
 {   
-    if(str == NULL)
-        return 0;
-    int decimal_point_count = 0; // To count the number of decimal points
-    int is_negative_allowed = (str == fields[9] || str == fields[11]); // Check if the field is altitude or geoid height
-
-    // Check for a negative sign at the beginning of the string if allowed
-    if (is_negative_allowed && *str == '-')
-    {
-        str++;
-    }
-
-    // Iterate through each character in the string
-    while (*str)
-    {
-        // If the character is a decimal point, increment the count
-        if (*str == '.')
-        {
-            decimal_point_count++;
-            // If more than one decimal point is found, return 0 (false)
-            if (decimal_point_count > 1)
-            {
-                return 0;
-            }
-        }
-        // If any character is not a digit or a decimal point, return 0 (false)
-        else if (!isdigit((unsigned char)*str))
-        {
-            return 0;
-        }
-        str++;
-    }
-
-    // If all characters are digits or there is a single decimal point, return 1 (true)
-    return 1;
+    float value;
+    return decimal_float_parser (str, length, allow_negative, &value);
 }
 // Function to set default values for gps_data_parse_t structure
-void print_default_value (gps_data_parse_t * data)
+void gps_gga_set_defaults (gps_data_parse_t * data)
 {
-    printf("\n_____INVALID DATA STREAM______\n setting all parameters to their default values\n");
-	
     data->time.hour = DEFAULT_GPS_TIME_HR;
-      
     data->time.minute = DEFAULT_GPS_TIME_MIN;
-      
     data->time.second = DEFAULT_GPS_TIME_SEC;
-      
     data->time.millisecond = DEFAULT_GPS_TIME_MS;
-      
     data->latitude = DEFAULT_LATITUDE;
-      
     data->longitude = DEFAULT_LONGITUDE;
-      
     data->lat_direction = DEFAULT_LAT_DIRECTION;
-      
     data->lon_direction = DEFAULT_LON_DIRECTION;
-      
     data->fix_quality = DEFAULT_FIX_QUALITY;
-      
     data->num_satellites = DEFAULT_NUM_SATELLITES;
-      
     data->hdop = DEFAULT_HDOP;
-      
     data->altitude = DEFAULT_ALTITUDE;
-      
     data->altitude_units = DEFAULT_ALTITUDE_UNITS;
-      
     data->geoid_height = DEFAULT_GEOID_HEIGHT;
-      
     data->geoid_height_units = DEFAULT_GEOID_HEIGHT_UNITS;
-      
     data->dgps_age = DEFAULT_DGPS_AGE;
-      
     data->dgps_station_id = DEFAULT_DGPS_STATION_ID;
+    data->latitude_e7 = DEFAULT_LATITUDE_E7;
+    data->longitude_e7 = DEFAULT_LONGITUDE_E7;
+    data->altitude_mm = DEFAULT_ALTITUDE_MM;
+    data->geoid_height_mm = DEFAULT_GEOID_HEIGHT_MM;
+    data->hdop_x100 = DEFAULT_HDOP_X100;
+    data->utc_ms = DEFAULT_UTC_MS;
+    data->rx_time.first_us = 0;
+    data->rx_time.last_us = 0;
 } 
  
-void utc_time_parser (gps_data_parse_t * gps_time) 
+//Function to validate a time field in HHMMSS.SSS format and convert it in the same pass,
+//returns 1 if it is valid, otherwise 0 and gps_time is left unchanged
+
+int utc_time_parser (gps_time_t * gps_time, const char *time_str, size_t length) 
 { 
-    const char *time_str = fields[1];
-  
-    // Extract and convert hour
-	gps_time->time.hour = TIME_ZONE + (10 * (time_str[0] - '0') + (time_str[1] - '0'));
-  
-    // Extract and convert minute
-	gps_time->time.minute = 10 * (time_str[2] - '0') + (time_str[3] - '0');
-  
-    // Extract and convert second
-	gps_time->time.second = 10 * (time_str[4] - '0') + (time_str[5] - '0');
-    
+    static const int limit[3] = { 23, 59, 59 };	// hours, minutes, seconds
+    int value[3];
+
+    // Time should have a decimal point at position 6
+    if (time_str == NULL || length < 7 || time_str[6] != '.')
+        return 0;
+
+    // Each pair of digits is checked against its range as it is read
+    for (int i = 0; i < 3; i++){
+        char tens = time_str[2 * i];
+        char units = time_str[2 * i + 1];
+        if (tens < '0' || tens > '9' || units < '0' || units > '9')
+            return 0;
+        value[i] = 10 * (tens - '0') + (units - '0');
+        if (value[i] > limit[i])
+            return 0;
+    }
+
+    gps_time->hour = (24 + TIME_ZONE % 24 + value[0]) % 24;
+    gps_time->minute = value[1];
+    gps_time->second = value[2];
+
     // Extract and convert milliseconds
-     gps_time->time.millisecond = 0; // Initialize to 0
-     int factor = 100; // Start with the highest place value
-     for (int i = 7; i <= 9 && time_str[i] != '\0'; i++) {
-            gps_time->time.millisecond += (time_str[i] - '0') * factor;
-            factor /= 10;
-        }
-    
-    
-    
+    gps_time->millisecond = 0; // Initialize to 0
+    int factor = 100; // Start with the highest place value
+    for (size_t i = 7; i <= 9 && i < length && time_str[i] >= '0' && time_str[i] <= '9'; i++){
+        gps_time->millisecond += (time_str[i] - '0') * factor;
+        factor /= 10;
+    }
+    return 1;
 } 
 
+//Function to convert longitude and latitude split by coordinate_field_parser() into degrees
+
+float coordinate_degrees (const coordinate_parts_t *parts)
+{
+    float x = (float) ((double) parts->whole + (double) parts->fraction / (double) parts->scale);
+    int deg = ((int) x) / 100;
+    float min = x - (deg * 100);
+    return deg + min / 60.0f;
+}
+
+//Function to convert longitude and latitude split by coordinate_field_parser() into 1e-7 degrees using integer arithmetic only
+
+int32_t coordinate_e7 (const coordinate_parts_t *parts)
+{
+    int64_t degrees = parts->whole / 100;
+    int64_t minutes = (parts->whole % 100) * parts->scale + parts->fraction;	// minutes * scale, below 1e11
+
+    // degrees * 1e7 + minutes * 1e7 / 60, rounded to the nearest unit
+    int64_t divisor = 60 * parts->scale;
+    return (int32_t) (degrees * 10000000 + (minutes * 10000000 + divisor / 2) / divisor);
+}
+
 //Function to convert longitude and latitude into degrees 
  
-float longitude_latitude_parser (const char *str) 
-{   if (str == NULL || str[0] == '\0' )
+float longitude_latitude_parser (const char *str, size_t length) 
+{   if (str == NULL || length == 0)
         return 0.0;
-    float x = strtof (str, NULL);
+    float x = 0.0f;
+    decimal_float_parser (str, length, 1, &x);
     int deg = ((int) x) / 100;
     float min = x - (deg * 100);
     x = deg + min / 60.0f;
@@ -736,6 +856,182 @@ float longitude_latitude_parser (const char *str)
     
 }
 
+//Function to convert longitude and latitude into 1e-7 degrees using integer arithmetic only,
+//the input must have been validated by is_valid_numeric()
+ 
+int32_t longitude_latitude_fixed_point_parser (const char *str, size_t length) 
+{
+    coordinate_parts_t parts = { 0, 0, 1 };
+
+    if (str == NULL)
+        return 0;
+    const char *end = str + length;
+    while (str < end && *str >= '0' && *str <= '9')
+        parts.whole = parts.whole * 10 + (*str++ - '0');
+    if (str < end && *str == '.'){
+        str++;
+        for (; str < end && *str >= '0' && *str <= '9' && parts.scale < 1000000000; str++){
+            parts.fraction = parts.fraction * 10 + (*str - '0');
+            parts.scale *= 10;
+        }
+    }
+    return coordinate_e7 (&parts);
+}
+
+//Function to convert a decimal string into an integer in units of 10^-scale_digits, rounded to the nearest unit
+ 
+int decimal_fixed_point_parser (const char *str, size_t length, int scale_digits, int allow_negative, int32_t *value)
+{
+    int negative = 0;
+    int digits = 0;
+    int64_t result = 0;
+
+    if (str == NULL)
+        return 0;
+    const char *end = str + length;
+    if (allow_negative && str < end && *str == '-'){
+        negative = 1;
+        str++;
+    }
+
+    for (; str < end && *str >= '0' && *str <= '9'; str++, digits++){
+        result = result * 10 + (*str - '0');
+        if (result > INT32_MAX)
+            return 0;	// too large for the fixed-point range
+    }
+
+    int kept = 0;
+    int round_up = 0;
+    if (str < end && *str == '.'){
+        str++;
+        for (; str < end && *str >= '0' && *str <= '9'; str++, digits++){
+            if (kept < scale_digits){
+                result = result * 10 + (*str - '0');
+                kept++;
+            }
+            else if (kept == scale_digits){
+                round_up = (*str >= '5');	// first dropped digit decides the rounding
+                kept++;
+            }
+        }
+    }
+
+    if (str != end || digits == 0)
+        return 0;	// not a number
+
+    for (; kept < scale_digits; kept++)
+        result *= 10;
+    result += round_up;
+    if (result > INT32_MAX)
+        return 0;
+
+    *value = (int32_t) (negative ? -result : result);
+    return 1;
+}
+
+//Function to validate a decimal string ([-]digits with at most one decimal point) and convert it into a float in the same pass,
+//the bounded counterpart of strtof(). Returns 1 if it is valid (an empty string is, and reads as 0), otherwise 0 and value is left unchanged
+ 
+int decimal_float_parser (const char *str, size_t length, int allow_negative, float *value)
+{
+    // powers of ten exactly representable as a double
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    int negative = 0;
+    int decimal_point = 0;
+    int64_t mantissa = 0;   // first 15 significant digits, exact in a double
+    int exponent = 0;       // power of ten applied to mantissa
+
+    if (str == NULL)
+        return 0;
+    const char *end = str + length;
+
+    // Check for a negative sign at the beginning of the string if allowed (altitude and geoid height)
+    if (allow_negative && str < end && *str == '-'){
+        negative = 1;
+        str++;
+    }
+
+    for (; str < end; str++){
+        if (*str == '.'){
+            // more than one decimal point is invalid
+            if (decimal_point++)
+                return 0;
+        }
+        else if (*str < '0' || *str > '9'){
+            return 0;
+        }
+        else if (mantissa < 100000000000000){
+            mantissa = mantissa * 10 + (*str - '0');
+            exponent -= decimal_point;
+        }
+        else{
+            exponent += !decimal_point;	// digits past the 15th only scale the integer part
+        }
+    }
+
+    double result = (double) mantissa;
+    for (; exponent < -22; exponent += 22)
+        result /= 1e22;
+    for (; exponent > 22; exponent -= 22)
+        result *= 1e22;
+    result = (exponent < 0) ? result / powers[-exponent] : result * powers[exponent];
+    if (result > FLT_MAX)
+        result = HUGE_VALF;
+
+    *value = (float) (negative ? -result : result);
+    return 1;
+}
+
+//Function to validate an unsigned decimal string and convert its integer part in the same pass, as atoi() would,
+//returns 1 if it is valid and fits an int, otherwise 0 and value is left unchanged
+
+int decimal_int_parser (const char *str, size_t length, int *value)
+{
+    int decimal_point = 0;
+    int64_t result = 0;
+
+    if (str == NULL)
+        return 0;
+    for (const char *end = str + length; str < end; str++){
+        if (*str == '.'){
+            if (decimal_point++)
+                return 0;
+        }
+        else if (*str < '0' || *str > '9'){
+            return 0;
+        }
+        else if (!decimal_point){
+            result = result * 10 + (*str - '0');
+            if (result > INT32_MAX)
+                return 0;
+        }
+    }
+
+    *value = (int) result;
+    return 1;
+}
+
+//Function to set the hemisphere from a direction field, returns -1 for south or west, 1 for north or east, 0 if invalid
+
+int coordinate_direction (gps_nmea_span_t direction, int is_longitude, char *hemisphere)
+{
+    char d = (char) toupper ((unsigned char) gps_field_char (direction));
+
+    if (d == (is_longitude ? 'E' : 'N')){
+        *hemisphere = direction.data[0];
+        return 1;
+    }
+    if (d == (is_longitude ? 'W' : 'S')){
+        *hemisphere = direction.data[0];
+        return -1;
+    }
+
+    // If the direction field is invalid, set direction to any default character
+    *hemisphere = is_longitude ? DEFAULT_LON_DIRECTION : DEFAULT_LAT_DIRECTION;
+    return 0;
+}
+
 //Function to describe fix quality value
 void gps_fix_quality_description (int gps_quality_fix)
 {
@@ -800,7 +1096,8 @@ int check_stream_NULL_Empty_public(const char *uart_stream)
 
 int gga_sentence_format_validity_check_public(const char *uart_stream)
 {
-    return gga_sentence_format_validity_check(uart_stream);
+    int crlf_index = 0;
+    return gga_sentence_format_validity_check(uart_stream, &crlf_index);
 }
  
  int check_sum_evaluation_public(const char *sentence)
@@ -812,7 +1109,7 @@ int gga_sentence_format_validity_check_public(const char *uart_stream)
  
  int is_valid_time_public(const char *time)
  {
-     return is_valid_time(time);
+     return is_valid_time(time, (time != NULL) ? strlen(time) : 0);
  }
  
  
@@ -821,7 +1118,7 @@ int gga_sentence_format_validity_check_public(const char *uart_stream)
      
      
      
-     return is_valid_numeric(str,expected_length);
+     return is_valid_numeric(str, (str != NULL) ? strlen(str) : 0, expected_length);
  }
 
  
@@ -830,7 +1127,7 @@ int gga_sentence_format_validity_check_public(const char *uart_stream)
      
      
      
-     return is_valid_number(str);
+     return is_valid_number(str, (str != NULL) ? strlen(str) : 0, 0);
  }
  
  
@@ -838,8 +1135,15 @@ int gga_sentence_format_validity_check_public(const char *uart_stream)
  {
      
      
-     return longitude_latitude_parser(str);
+     return longitude_latitude_parser(str, (str != NULL) ? strlen(str) : 0);
  }
  
+ int32_t longitude_latitude_fixed_point_parser_public(const char *str)
+ {
+     return longitude_latitude_fixed_point_parser(str, (str != NULL) ? strlen(str) : 0);
+ }
  
-
+ int decimal_fixed_point_parser_public(const char *str, int scale_digits, int allow_negative, int32_t *value)
+ {
+     return decimal_fixed_point_parser(str, (str != NULL) ? strlen(str) : 0, scale_digits, allow_negative, value);
+ }
@@ -0,0 +1,264 @@
+/**
+ * @file gps_fix_history.c
+ * @brief Block-structured, delta-encoded history of fixes.
+ *
+ * Block layout: used bytes (uint16), number of fixes (uint16), the first fix as a full
+ * gps_fix_record_t, then one delta-encoded fix after the other. A block is closed when the
+ * largest possible delta-encoded fix no longer fits in it.
+ */
+
+#include <string.h>
+
+#include "gps_fix_history.h"
+#include "gps_parser_private.h"
+
+#define BLOCK_HEADER_SIZE   4
+#define BLOCK_FIRST_FIX     (BLOCK_HEADER_SIZE + GPS_FIX_RECORD_SIZE)
+#define VARINT_MAX_SIZE     5
+#define FIX_MAX_SIZE        (1 + GPS_FIX_HISTORY_FIELDS * VARINT_MAX_SIZE)
+
+// Fields in mask bit order
+enum { FIELD_TIME, FIELD_LATITUDE, FIELD_LONGITUDE, FIELD_ALTITUDE, FIELD_FIX_QUALITY, FIELD_SATELLITES, FIELD_HDOP };
+
+// Fields predicted to keep changing at the same rate, the others are predicted to stay unchanged
+#define SECOND_ORDER_FIELDS ((1u << FIELD_TIME) | (1u << FIELD_LATITUDE) | (1u << FIELD_LONGITUDE))
+
+#define TIME_MASK           0x7FFFFFFu
+#define TIME_SHIFT_QUALITY  27
+
+static uint32_t get_u16 (const uint8_t *bytes)
+{
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8);
+}
+
+static void put_u16 (uint8_t *bytes, uint32_t value)
+{
+    bytes[0] = (uint8_t) value;
+    bytes[1] = (uint8_t) (value >> 8);
+}
+
+// Block at position ordinal from the oldest one
+static uint8_t * block_at (const gps_fix_history_t *history, size_t ordinal)
+{
+    return history->storage + ((history->first_block + ordinal) % history->block_count) * history->block_size;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Record fields
+//====================================================================================================================================================================================================================================================================
+
+static void record_unpack (const gps_fix_record_t *record, uint32_t *fields)
+{
+    const uint8_t *bytes = record->bytes;
+    uint32_t word = gps_get_le32 (bytes + 8);
+
+    fields[FIELD_TIME] = word & TIME_MASK;
+    fields[FIELD_LATITUDE] = gps_get_le32 (bytes);
+    fields[FIELD_LONGITUDE] = gps_get_le32 (bytes + 4);
+    // sign-extended so that small changes around zero stay small
+    fields[FIELD_ALTITUDE] = (uint32_t) ((int32_t) (((uint32_t) bytes[12] | ((uint32_t) bytes[13] << 8) | ((uint32_t) bytes[14] << 16)) << 8) >> 8);
+    fields[FIELD_FIX_QUALITY] = word >> TIME_SHIFT_QUALITY;
+    fields[FIELD_SATELLITES] = bytes[15];
+    fields[FIELD_HDOP] = get_u16 (bytes + 16);
+}
+
+static void record_pack (const uint32_t *fields, gps_fix_record_t *record)
+{
+    uint8_t *bytes = record->bytes;
+
+    gps_put_le32 (bytes, fields[FIELD_LATITUDE]);
+    gps_put_le32 (bytes + 4, fields[FIELD_LONGITUDE]);
+    gps_put_le32 (bytes + 8, (fields[FIELD_TIME] & TIME_MASK) | (fields[FIELD_FIX_QUALITY] << TIME_SHIFT_QUALITY));
+    bytes[12] = (uint8_t) fields[FIELD_ALTITUDE];
+    bytes[13] = (uint8_t) (fields[FIELD_ALTITUDE] >> 8);
+    bytes[14] = (uint8_t) (fields[FIELD_ALTITUDE] >> 16);
+    bytes[15] = (uint8_t) fields[FIELD_SATELLITES];
+    put_u16 (bytes + 16, fields[FIELD_HDOP]);
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Delta encoding
+//====================================================================================================================================================================================================================================================================
+
+static size_t put_varint (uint8_t *bytes, uint32_t value)
+{
+    size_t length = 0;
+    while (value >= 0x80){
+        bytes[length++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t) value;
+    return length;
+}
+
+static size_t get_varint (const uint8_t *bytes, uint32_t *value)
+{
+    size_t length = 0;
+    *value = 0;
+    do {
+        *value |= (uint32_t) (bytes[length] & 0x7F) << (7 * length);
+    } while (bytes[length++] & 0x80);
+    return length;
+}
+
+// Differences are taken modulo 2^32, zigzag maps small negative ones to small codes
+static uint32_t zigzag (uint32_t value)
+{
+    return (value << 1) ^ (0u - (value >> 31));
+}
+
+static uint32_t unzigzag (uint32_t code)
+{
+    return (code >> 1) ^ (0u - (code & 1));
+}
+
+static uint32_t predict (const gps_fix_history_state_t *state, int field)
+{
+    return state->value[field] + (((SECOND_ORDER_FIELDS >> field) & 1) ? state->delta[field] : 0);
+}
+
+static void state_update (gps_fix_history_state_t *state, int field, uint32_t value)
+{
+    state->delta[field] = value - state->value[field];
+    state->value[field] = value;
+}
+
+static void state_reset (gps_fix_history_state_t *state, const uint32_t *fields)
+{
+    for (int i = 0; i < GPS_FIX_HISTORY_FIELDS; i++){
+        state->value[i] = fields[i];
+        state->delta[i] = 0;
+    }
+}
+
+// Writes the mask byte and the residuals of the fields that differ from their prediction
+static size_t fix_encode (gps_fix_history_state_t *state, const uint32_t *fields, uint8_t *bytes)
+{
+    uint8_t mask = 0;
+    size_t length = 1;
+
+    for (int i = 0; i < GPS_FIX_HISTORY_FIELDS; i++){
+        uint32_t residual = fields[i] - predict (state, i);
+        if (residual != 0){
+            mask |= (uint8_t) (1u << i);
+            length += put_varint (bytes + length, zigzag (residual));
+        }
+        state_update (state, i, fields[i]);
+    }
+    bytes[0] = mask;
+    return length;
+}
+
+static size_t fix_decode (gps_fix_history_state_t *state, const uint8_t *bytes, uint32_t *fields)
+{
+    uint8_t mask = bytes[0];
+    size_t length = 1;
+
+    for (int i = 0; i < GPS_FIX_HISTORY_FIELDS; i++){
+        uint32_t residual = 0;
+        if (mask & (1u << i)){
+            length += get_varint (bytes + length, &residual);
+            residual = unzigzag (residual);
+        }
+        fields[i] = predict (state, i) + residual;
+        state_update (state, i, fields[i]);
+    }
+    return length;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         History
+//====================================================================================================================================================================================================================================================================
+
+int gps_fix_history_init (gps_fix_history_t *history, void *storage, size_t size, size_t block_size)
+{
+    if (storage == NULL || block_size < GPS_FIX_HISTORY_MIN_BLOCK_SIZE || block_size > GPS_FIX_HISTORY_MAX_BLOCK_SIZE
+        || size / block_size < 2)
+        return -1;
+
+    history->storage = (uint8_t *) storage;
+    history->block_size = block_size;
+    history->block_count = size / block_size;
+    gps_fix_history_clear (history);
+    return 0;
+}
+
+void gps_fix_history_clear (gps_fix_history_t *history)
+{
+    history->first_block = 0;
+    history->used_blocks = 0;
+    history->count = 0;
+}
+
+void gps_fix_history_append (gps_fix_history_t *history, const gps_fix_record_t *record)
+{
+    uint32_t fields[GPS_FIX_HISTORY_FIELDS];
+    record_unpack (record, fields);
+
+    if (history->used_blocks > 0){
+        uint8_t *block = block_at (history, history->used_blocks - 1);
+        uint32_t used = get_u16 (block);
+        if (used + FIX_MAX_SIZE <= history->block_size){
+            used += (uint32_t) fix_encode (&history->last, fields, block + used);
+            put_u16 (block, used);
+            put_u16 (block + 2, get_u16 (block + 2) + 1);
+            history->count++;
+            return;
+        }
+    }
+
+    // the newest block is full: start a new one, dropping the oldest one if there is no free block
+    if (history->used_blocks == history->block_count){
+        history->count -= get_u16 (block_at (history, 0) + 2);
+        history->first_block = (history->first_block + 1) % history->block_count;
+        history->used_blocks--;
+    }
+    uint8_t *block = block_at (history, history->used_blocks);
+    history->used_blocks++;
+    put_u16 (block, BLOCK_FIRST_FIX);
+    put_u16 (block + 2, 1);
+    memcpy (block + BLOCK_HEADER_SIZE, record->bytes, GPS_FIX_RECORD_SIZE);
+    state_reset (&history->last, fields);
+    history->count++;
+}
+
+size_t gps_fix_history_bytes_used (const gps_fix_history_t *history)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < history->used_blocks; i++)
+        bytes += get_u16 (block_at (history, i));
+    return bytes;
+}
+
+void gps_fix_history_iter_init (gps_fix_history_iter_t *iter, const gps_fix_history_t *history)
+{
+    iter->history = history;
+    iter->block = 0;
+    iter->offset = 0;
+}
+
+int gps_fix_history_iter_next (gps_fix_history_iter_t *iter, gps_fix_record_t *record)
+{
+    uint32_t fields[GPS_FIX_HISTORY_FIELDS];
+
+    if (iter->block >= iter->history->used_blocks)
+        return 0;
+
+    const uint8_t *block = block_at (iter->history, iter->block);
+    if (iter->offset == 0){
+        memcpy (record->bytes, block + BLOCK_HEADER_SIZE, GPS_FIX_RECORD_SIZE);
+        record_unpack (record, fields);
+        state_reset (&iter->state, fields);
+        iter->offset = BLOCK_FIRST_FIX;
+    }
+    else{
+        iter->offset += fix_decode (&iter->state, block + iter->offset, fields);
+        record_pack (fields, record);
+    }
+
+    if (iter->offset >= get_u16 (block)){
+        iter->block++;
+        iter->offset = 0;
+    }
+    return 1;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file gps_fix_record.c
+ * @brief Encoding and decoding of the packed binary fix record.
+ *
+ * Bytes are written and read one at a time, so the layout does not depend on the byte order,
+ * alignment rules or struct packing of the target.
+ */
+
+#include "gps_fix_record.h"
+#include "gps_parser_private.h"
+
+#define FEET_PER_METRE      3.28084
+#define ALTITUDE_DM_MAX     8388607
+#define TIME_SHIFT_QUALITY  27
+
+// Rounds half away from zero
+static int64_t round_scaled (double value)
+{
+    return (value >= 0) ? (int64_t) (value + 0.5) : -(int64_t) (-value + 0.5);
+}
+
+// Divides by divisor, rounding half away from zero
+static int64_t divide_rounded (int64_t value, int64_t divisor)
+{
+    return (value >= 0) ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor);
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Encoding
+//====================================================================================================================================================================================================================================================================
+
+// The _E7 defaults of latitude and longitude are the same value
+static int32_t encode_coordinate (int32_t value_e7, float value, float default_value, int32_t limit_e7)
+{
+    if (value_e7 == DEFAULT_LATITUDE_E7 && value != default_value)
+        value_e7 = (int32_t) round_scaled ((double) value * 1e7);
+    return (value_e7 >= -limit_e7 && value_e7 <= limit_e7) ? value_e7 : GPS_FIX_RECORD_NO_COORDINATE;
+}
+
+// The record holds UTC, the decoded hour has TIME_ZONE added
+static uint32_t encode_time (const gps_time_t *time)
+{
+    if (time->hour > 23 || time->minute > 59 || time->second > 59 || time->millisecond > 999)
+        return GPS_FIX_RECORD_NO_TIME;
+    return gps_time_utc_ms (time);
+}
+
+static int32_t encode_altitude (const gps_data_parse_t *data)
+{
+    int64_t altitude_dm;
+
+    if (data->altitude_mm != DEFAULT_ALTITUDE_MM){
+        altitude_dm = divide_rounded (data->altitude_mm, 100);
+    }
+    else if (data->altitude != DEFAULT_ALTITUDE){
+        double metres = (data->altitude_units == 'F') ? data->altitude / FEET_PER_METRE : data->altitude;
+        altitude_dm = round_scaled (metres * 10);
+    }
+    else{
+        return GPS_FIX_RECORD_NO_ALTITUDE;
+    }
+    return (altitude_dm >= -ALTITUDE_DM_MAX && altitude_dm <= ALTITUDE_DM_MAX) ? (int32_t) altitude_dm : GPS_FIX_RECORD_NO_ALTITUDE;
+}
+
+static uint32_t encode_hdop (const gps_data_parse_t *data)
+{
+    int64_t hdop_x10;
+
+    if (data->hdop_x100 != DEFAULT_HDOP_X100)
+        hdop_x10 = divide_rounded (data->hdop_x100, 10);
+    else if (data->hdop >= 0)
+        hdop_x10 = round_scaled (data->hdop * 10.0);
+    else
+        return GPS_FIX_RECORD_NO_HDOP;
+    return (hdop_x10 < GPS_FIX_RECORD_NO_HDOP) ? (uint32_t) hdop_x10 : GPS_FIX_RECORD_NO_HDOP;
+}
+
+void gps_fix_record_encode (const gps_data_parse_t *data, gps_fix_record_t *record)
+{
+    uint8_t *bytes = record->bytes;
+
+    int32_t latitude_e7 = encode_coordinate (data->latitude_e7, data->latitude, DEFAULT_LATITUDE, 900000000);
+    int32_t longitude_e7 = encode_coordinate (data->longitude_e7, data->longitude, DEFAULT_LONGITUDE, 1800000000);
+    gps_put_le32 (bytes, (uint32_t) latitude_e7);
+    gps_put_le32 (bytes + 4, (uint32_t) longitude_e7);
+
+    uint32_t fix_quality = (data->fix_quality >= 0 && data->fix_quality < (int) GPS_FIX_RECORD_NO_FIX_QUALITY)
+                         ? (uint32_t) data->fix_quality : GPS_FIX_RECORD_NO_FIX_QUALITY;
+    gps_put_le32 (bytes + 8, encode_time (&data->time) | (fix_quality << TIME_SHIFT_QUALITY));
+
+    uint32_t altitude_dm = (uint32_t) encode_altitude (data);
+    bytes[12] = (uint8_t) altitude_dm;
+    bytes[13] = (uint8_t) (altitude_dm >> 8);
+    bytes[14] = (uint8_t) (altitude_dm >> 16);
+
+    bytes[15] = (data->num_satellites >= 0 && data->num_satellites < (int) GPS_FIX_RECORD_NO_SATELLITES)
+              ? (uint8_t) data->num_satellites : GPS_FIX_RECORD_NO_SATELLITES;
+
+    uint32_t hdop_x10 = encode_hdop (data);
+    bytes[16] = (uint8_t) hdop_x10;
+    bytes[17] = (uint8_t) (hdop_x10 >> 8);
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Decoding
+//====================================================================================================================================================================================================================================================================
+
+void gps_fix_record_decode (const gps_fix_record_t *record, gps_data_parse_t *data)
+{
+    const uint8_t *bytes = record->bytes;
+
+    gps_gga_set_defaults (data);
+
+    int32_t latitude_e7 = (int32_t) gps_get_le32 (bytes);
+    if (latitude_e7 != GPS_FIX_RECORD_NO_COORDINATE){
+        data->latitude_e7 = latitude_e7;
+        data->latitude = (float) (latitude_e7 / 1e7);
+        data->lat_direction = (latitude_e7 < 0) ? 'S' : 'N';
+    }
+    int32_t longitude_e7 = (int32_t) gps_get_le32 (bytes + 4);
+    if (longitude_e7 != GPS_FIX_RECORD_NO_COORDINATE){
+        data->longitude_e7 = longitude_e7;
+        data->longitude = (float) (longitude_e7 / 1e7);
+        data->lon_direction = (longitude_e7 < 0) ? 'W' : 'E';
+    }
+
+    uint32_t word = gps_get_le32 (bytes + 8);
+    uint32_t time_ms = word & GPS_FIX_RECORD_NO_TIME;
+    if (time_ms != GPS_FIX_RECORD_NO_TIME){
+        data->time.millisecond = (uint16_t) (time_ms % 1000);
+        data->time.second = (uint8_t) (time_ms / 1000 % 60);
+        data->time.minute = (uint8_t) (time_ms / 60000 % 60);
+        data->time.hour = (uint8_t) ((24 + TIME_ZONE % 24 + time_ms / 3600000) % 24);
+    }
+    uint32_t fix_quality = (word >> TIME_SHIFT_QUALITY) & GPS_FIX_RECORD_NO_FIX_QUALITY;
+    if (fix_quality != GPS_FIX_RECORD_NO_FIX_QUALITY)
+        data->fix_quality = (int) fix_quality;
+
+    // sign-extend the 24-bit altitude
+    int32_t altitude_dm = (int32_t) (((uint32_t) bytes[12] | ((uint32_t) bytes[13] << 8) | ((uint32_t) bytes[14] << 16)) << 8) >> 8;
+    if (altitude_dm != GPS_FIX_RECORD_NO_ALTITUDE){
+        data->altitude_mm = altitude_dm * 100;
+        data->altitude = (float) (altitude_dm / 10.0);
+        data->altitude_units = 'M';
+        #if USE_FEET_UNIT
+        data->altitude_units = 'F';
+        data->altitude = (float) (altitude_dm / 10.0 * FEET_PER_METRE);
+        #endif
+    }
+
+    if (bytes[15] != GPS_FIX_RECORD_NO_SATELLITES)
+        data->num_satellites = bytes[15];
+
+    uint32_t hdop_x10 = (uint32_t) bytes[16] | ((uint32_t) bytes[17] << 8);
+    if (hdop_x10 != GPS_FIX_RECORD_NO_HDOP){
+        data->hdop = (float) (hdop_x10 / 10.0);
+        data->hdop_x100 = (hdop_x10 * 10 < DEFAULT_HDOP_X100) ? (uint16_t) (hdop_x10 * 10) : DEFAULT_HDOP_X100;
+    }
+}
@@ -0,0 +1,228 @@
+/**
+ * @file gps_geo.c
+ * @brief Haversine distance and initial bearing kernels over arrays of coordinates.
+ *
+ * The kernels are written once against geo_vf, which is a vector of four floats when the
+ * compiler has GCC vector extensions and the target is not an ESP chip, and a plain float
+ * otherwise. Every operation is branch-free: conditions are comparisons feeding GEO_SELECT,
+ * so all lanes follow the same instructions. sin and cos are Taylor series on |x| <= pi/2,
+ * asin and atan2 the Cephes single precision polynomials; the vector square root is a
+ * Newton-refined reciprocal square root and the scalar one is sqrtf().
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "gps_geo.h"
+
+#if defined(__GNUC__) && !defined(ESP_PLATFORM) && !defined(GPS_GEO_SCALAR)
+#define GEO_LANES   4
+typedef float geo_vf __attribute__ ((vector_size (16)));
+typedef int32_t geo_vi __attribute__ ((vector_size (16)));
+// comparisons of vectors give 0 or -1 per lane
+#define GEO_SELECT(mask, a, b)  ((geo_vf) (((geo_vi) (a) & (mask)) | ((geo_vi) (b) & ~(mask))))
+#define GEO_SPLAT(value)        ((geo_vf) { 0 } + (value))
+#else
+#define GEO_LANES   1
+typedef float geo_vf;
+#define GEO_SELECT(mask, a, b)  ((mask) ? (a) : (b))
+#define GEO_SPLAT(value)        (value)
+#endif
+
+#define GEO_PI              3.14159265358979f
+#define GEO_RADIANS         (GEO_PI / 180)
+#define GEO_DEGREES         (180 / GEO_PI)
+#define GEO_TINY            1e-30f
+#define GEO_CHUNK           64      // segments computed at a time by the track functions
+
+//====================================================================================================================================================================================================================================================================
+//                         Branch-free float math
+//====================================================================================================================================================================================================================================================================
+
+// sin(x) for |x| <= pi/2, Taylor series to x^11 (error below 6e-8)
+static inline geo_vf geo_sin (geo_vf x)
+{
+    geo_vf z = x * x;
+    return x + x * z * (-1.6666667e-1f + z * (8.3333333e-3f + z * (-1.9841270e-4f + z * (2.7557319e-6f + z * -2.5052108e-8f))));
+}
+
+// cos(x) for |x| <= pi/2, Taylor series to x^12 (error below 1e-8)
+static inline geo_vf geo_cos (geo_vf x)
+{
+    geo_vf z = x * x;
+    return 1.0f + z * (-0.5f + z * (4.1666667e-2f + z * (-1.3888889e-3f + z * (2.4801587e-5f + z * (-2.7557319e-7f + z * 2.0876757e-9f)))));
+}
+
+static inline geo_vf geo_sqrt (geo_vf x)
+{
+#if GEO_LANES > 1
+    // reciprocal square root from the exponent trick, three Newton steps reach float precision
+    geo_vf clamped = GEO_SELECT (x > GEO_TINY, x, GEO_SPLAT (GEO_TINY));
+    geo_vf r = (geo_vf) (0x5F375A86 - ((geo_vi) clamped >> 1));
+    geo_vf half = clamped * 0.5f;
+    r = r * (1.5f - half * r * r);
+    r = r * (1.5f - half * r * r);
+    r = r * (1.5f - half * r * r);
+    return x * r;
+#else
+    return sqrtf (x);
+#endif
+}
+
+// asin(x) for 0 <= x <= 1
+static inline geo_vf geo_asin (geo_vf x)
+{
+    geo_vf z_big = 0.5f * (1.0f - x);
+    geo_vf z = GEO_SELECT (x > 0.5f, z_big, x * x);
+    geo_vf s = GEO_SELECT (x > 0.5f, geo_sqrt (z_big), x);
+    geo_vf p = ((((4.2163199048E-2f * z + 2.4181311049E-2f) * z + 4.5470025998E-2f) * z + 7.4953002686E-2f) * z
+              + 1.6666752422E-1f) * z * s + s;
+    return GEO_SELECT (x > 0.5f, GEO_PI / 2 - 2.0f * p, p);
+}
+
+// atan2(y, x) in -pi to pi, 0 for atan2(0, 0)
+static inline geo_vf geo_atan2 (geo_vf y, geo_vf x)
+{
+    geo_vf ax = GEO_SELECT (x < 0.0f, -x, x);
+    geo_vf ay = GEO_SELECT (y < 0.0f, -y, y);
+    geo_vf high = GEO_SELECT (ay > ax, ay, ax);
+    geo_vf low = GEO_SELECT (ay > ax, ax, ay);
+    geo_vf t = low / GEO_SELECT (high > GEO_TINY, high, GEO_SPLAT (GEO_TINY));
+
+    // atan(t) = pi/4 + atan((t - 1) / (t + 1)) above tan(pi/8)
+    geo_vf reduced = GEO_SELECT (t > 0.41421356f, (t - 1.0f) / (t + 1.0f), t);
+    geo_vf z = reduced * reduced;
+    geo_vf r = (((8.05374449538E-2f * z - 1.38776856032E-1f) * z + 1.99777106478E-1f) * z - 3.33329491539E-1f) * z * reduced
+             + reduced + GEO_SELECT (t > 0.41421356f, GEO_SPLAT (GEO_PI / 4), GEO_SPLAT (0.0f));
+
+    r = GEO_SELECT (ay > ax, GEO_PI / 2 - r, r);
+    r = GEO_SELECT (x < 0.0f, GEO_PI - r, r);
+    return GEO_SELECT (y < 0.0f, -r, r);
+}
+
+// Longitude difference in radians, wrapped to -pi to pi
+static inline geo_vf geo_longitude_delta (geo_vf longitude1, geo_vf longitude2)
+{
+    geo_vf delta = longitude2 - longitude1;
+    delta = GEO_SELECT (delta > 180.0f, delta - 360.0f, delta);
+    delta = GEO_SELECT (delta < -180.0f, delta + 360.0f, delta);
+    return delta * GEO_RADIANS;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Kernels, one lane per pair of points
+//====================================================================================================================================================================================================================================================================
+
+static inline geo_vf geo_distance (geo_vf latitude1, geo_vf longitude1, geo_vf latitude2, geo_vf longitude2)
+{
+    geo_vf sin_half_latitude = geo_sin ((latitude2 - latitude1) * (GEO_RADIANS / 2));
+    geo_vf sin_half_longitude = geo_sin (geo_longitude_delta (longitude1, longitude2) * 0.5f);
+    geo_vf a = sin_half_latitude * sin_half_latitude
+             + geo_cos (latitude1 * GEO_RADIANS) * geo_cos (latitude2 * GEO_RADIANS) * sin_half_longitude * sin_half_longitude;
+    a = GEO_SELECT (a > 1.0f, GEO_SPLAT (1.0f), a);
+    return (2.0f * GPS_GEO_EARTH_RADIUS) * geo_asin (geo_sqrt (a));
+}
+
+static inline geo_vf geo_bearing (geo_vf latitude1, geo_vf longitude1, geo_vf latitude2, geo_vf longitude2)
+{
+    geo_vf half_longitude = geo_longitude_delta (longitude1, longitude2) * 0.5f;
+    geo_vf half_latitude = (latitude2 - latitude1) * (GEO_RADIANS / 2);
+    geo_vf sin_half = geo_sin (half_longitude);
+    geo_vf sin_longitude = 2.0f * sin_half * geo_cos (half_longitude);
+    geo_vf sin_latitude = 2.0f * geo_sin (half_latitude) * geo_cos (half_latitude);
+    geo_vf sin1 = geo_sin (latitude1 * GEO_RADIANS);
+    geo_vf cos2 = geo_cos (latitude2 * GEO_RADIANS);
+
+    // cos1 sin2 - sin1 cos2 cos(dlon) rewritten without the cancellation between nearby points
+    geo_vf north = sin_latitude + 2.0f * sin1 * cos2 * sin_half * sin_half;
+    geo_vf bearing = geo_atan2 (sin_longitude * cos2, north) * GEO_DEGREES;
+    return GEO_SELECT (bearing < 0.0f, bearing + 360.0f, bearing);
+}
+
+// Runs kernel over count pairs of points, the last partial vector through zero-padded copies
+#define GEO_APPLY(kernel, latitude1, longitude1, latitude2, longitude2, out, count)                         \
+    do {                                                                                                    \
+        size_t i_ = 0;                                                                                      \
+        geo_vf in_[4], out_;                                                                                \
+        for (; i_ + GEO_LANES <= (count); i_ += GEO_LANES){                                                 \
+            memcpy (&in_[0], (latitude1) + i_, sizeof (geo_vf));                                            \
+            memcpy (&in_[1], (longitude1) + i_, sizeof (geo_vf));                                           \
+            memcpy (&in_[2], (latitude2) + i_, sizeof (geo_vf));                                            \
+            memcpy (&in_[3], (longitude2) + i_, sizeof (geo_vf));                                           \
+            out_ = kernel (in_[0], in_[1], in_[2], in_[3]);                                                 \
+            memcpy ((out) + i_, &out_, sizeof (geo_vf));                                                    \
+        }                                                                                                   \
+        if (i_ < (count)){                                                                                  \
+            size_t rest_ = ((count) - i_) * sizeof (float);                                                 \
+            memset (in_, 0, sizeof (in_));                                                                  \
+            memcpy (&in_[0], (latitude1) + i_, rest_);                                                      \
+            memcpy (&in_[1], (longitude1) + i_, rest_);                                                     \
+            memcpy (&in_[2], (latitude2) + i_, rest_);                                                      \
+            memcpy (&in_[3], (longitude2) + i_, rest_);                                                     \
+            out_ = kernel (in_[0], in_[1], in_[2], in_[3]);                                                 \
+            memcpy ((out) + i_, &out_, rest_);                                                              \
+        }                                                                                                   \
+    } while (0)
+
+void gps_geo_distance (const float *latitude1, const float *longitude1, const float *latitude2, const float *longitude2,
+                       float *distance, size_t count)
+{
+    GEO_APPLY (geo_distance, latitude1, longitude1, latitude2, longitude2, distance, count);
+}
+
+void gps_geo_bearing (const float *latitude1, const float *longitude1, const float *latitude2, const float *longitude2,
+                      float *bearing, size_t count)
+{
+    GEO_APPLY (geo_bearing, latitude1, longitude1, latitude2, longitude2, bearing, count);
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Tracks, consecutive fixes are pairs of points one element apart
+//====================================================================================================================================================================================================================================================================
+
+void gps_geo_track_segments (const gps_geo_track_t *track, float *segment)
+{
+    if (track->count < 2)
+        return;
+    gps_geo_distance (track->latitude, track->longitude, track->latitude + 1, track->longitude + 1, segment, track->count - 1);
+}
+
+void gps_geo_track_bearings (const gps_geo_track_t *track, float *bearing)
+{
+    if (track->count < 2)
+        return;
+    gps_geo_bearing (track->latitude, track->longitude, track->latitude + 1, track->longitude + 1, bearing, track->count - 1);
+}
+
+double gps_geo_track_length (const gps_geo_track_t *track, double *cumulative)
+{
+    float segment[GEO_CHUNK];
+    double length = 0;
+
+    if (track->count == 0)
+        return 0;
+    if (cumulative != NULL)
+        cumulative[0] = 0;
+
+    for (size_t first = 0; first + 1 < track->count; first += GEO_CHUNK){
+        size_t count = track->count - 1 - first;
+        count = (count < GEO_CHUNK) ? count : GEO_CHUNK;
+        gps_geo_distance (track->latitude + first, track->longitude + first, track->latitude + first + 1,
+                          track->longitude + first + 1, segment, count);
+        for (size_t i = 0; i < count; i++){
+            length += segment[i];
+            if (cumulative != NULL)
+                cumulative[first + i + 1] = length;
+        }
+    }
+    return length;
+}
+
+void gps_geo_track_speeds (const gps_geo_track_t *track, float *speed)
+{
+    gps_geo_track_segments (track, speed);
+    for (size_t i = 0; i + 1 < track->count; i++){
+        int64_t elapsed_ms = track->time_ms[i + 1] - track->time_ms[i];
+        speed[i] = (elapsed_ms > 0) ? speed[i] * 1000.0f / (float) elapsed_ms : GPS_GEO_NO_SPEED;
+    }
+}
@@ -0,0 +1,331 @@
+/**
+ * @file gps_geofence.c
+ * @brief Uniform grid geofence index.
+ *
+ * The grid is stored like a compressed sparse row matrix: cell_start gives for every cell the
+ * first of its entries in cell_fences, and the entries of a cell are the fences whose bounding
+ * box overlaps it, in increasing order. It is filled by a counting sort over the fences, so
+ * building takes two passes and no temporary memory.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "gps_geofence.h"
+#include "gps_parser_private.h"
+
+#define METRES_PER_E7       0.0111194926f   // one 1e-7 degree of latitude on the mean earth radius
+#define RADIANS_PER_E7      1.74532925e-9f
+#define MAX_LATITUDE_E7     900000000
+#define MAX_LONGITUDE_E7    1800000000
+#define MAX_POLYGON_SPAN    1800000000LL    // keeps the crossing test products within int64_t
+
+static size_t align_up (size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static int bounds_contain (const gps_geofence_shape_t *shape, int32_t latitude_e7, int32_t longitude_e7)
+{
+    return latitude_e7 >= shape->min_latitude_e7 && latitude_e7 <= shape->max_latitude_e7
+        && longitude_e7 >= shape->min_longitude_e7 && longitude_e7 <= shape->max_longitude_e7;
+}
+
+// Crossing number test, on a ray from the point towards increasing longitude
+static int polygon_contains (const gps_geofence_shape_t *shape, int32_t latitude_e7, int32_t longitude_e7)
+{
+    const gps_geofence_point_t *vertices = shape->polygon.vertices;
+    uint32_t count = shape->polygon.vertex_count;
+    int inside = 0;
+
+    for (uint32_t i = 0, j = count - 1; i < count; j = i++){
+        int64_t ay = (int64_t) vertices[i].latitude_e7 - latitude_e7;
+        int64_t by = (int64_t) vertices[j].latitude_e7 - latitude_e7;
+        if ((ay > 0) == (by > 0))
+            continue;
+        int64_t ax = (int64_t) vertices[i].longitude_e7 - longitude_e7;
+        int64_t bx = (int64_t) vertices[j].longitude_e7 - longitude_e7;
+        // the edge crosses the ray where its longitude is positive
+        int64_t cross = ax * (by - ay) - ay * (bx - ax);
+        if ((cross > 0) == (by > ay))
+            inside ^= 1;
+    }
+    return inside;
+}
+
+static int circle_contains (const gps_geofence_shape_t *shape, int32_t latitude_e7, int32_t longitude_e7)
+{
+    float dx = (float) ((int64_t) longitude_e7 - shape->circle.center.longitude_e7) * shape->circle.longitude_scale;
+    float dy = (float) ((int64_t) latitude_e7 - shape->circle.center.latitude_e7) * METRES_PER_E7;
+    return dx * dx + dy * dy <= shape->circle.radius_squared;
+}
+
+static int shape_contains (const gps_geofence_shape_t *shape, int32_t latitude_e7, int32_t longitude_e7)
+{
+    if (!bounds_contain (shape, latitude_e7, longitude_e7))
+        return 0;
+    return shape->is_circle ? circle_contains (shape, latitude_e7, longitude_e7)
+                            : polygon_contains (shape, latitude_e7, longitude_e7);
+}
+
+static gps_geofence_shape_t *new_shape (gps_geofence_t *geofence)
+{
+    if (geofence->built || geofence->count >= geofence->max_fences)
+        return NULL;
+    gps_geofence_shape_t *shape = &geofence->shapes[geofence->count];
+    memset (shape, 0, sizeof (*shape));
+    return shape;
+}
+
+int gps_geofence_init (gps_geofence_t *geofence, void *storage, size_t size, size_t max_fences,
+                       gps_geofence_event_cb_t callback, void *user_ctx)
+{
+    if (storage == NULL || max_fences > GPS_GEOFENCE_MAX_FENCES)
+        return -1;
+
+    // shapes hold pointers and int32_t, align them for both
+    size_t skip = align_up ((uintptr_t) storage, sizeof (void *) > 4 ? sizeof (void *) : 4) - (uintptr_t) storage;
+    size_t shapes_size = max_fences * sizeof (gps_geofence_shape_t);
+    if (size < skip + shapes_size)
+        return -1;
+
+    memset (geofence, 0, sizeof (*geofence));
+    geofence->callback = callback;
+    geofence->user_ctx = user_ctx;
+    geofence->shapes = (gps_geofence_shape_t *) ((uint8_t *) storage + skip);
+    geofence->max_fences = max_fences;
+    geofence->index_storage = (uint8_t *) storage + skip + shapes_size;
+    geofence->index_size = size - skip - shapes_size;
+    return 0;
+}
+
+int gps_geofence_add_polygon (gps_geofence_t *geofence, const gps_geofence_point_t *vertices, size_t vertex_count)
+{
+    gps_geofence_shape_t *shape = new_shape (geofence);
+    if (shape == NULL || vertices == NULL || vertex_count < 3 || vertex_count > UINT32_MAX)
+        return -1;
+
+    shape->min_latitude_e7 = shape->max_latitude_e7 = vertices[0].latitude_e7;
+    shape->min_longitude_e7 = shape->max_longitude_e7 = vertices[0].longitude_e7;
+    for (size_t i = 0; i < vertex_count; i++){
+        const gps_geofence_point_t *vertex = &vertices[i];
+        if (vertex->latitude_e7 < -MAX_LATITUDE_E7 || vertex->latitude_e7 > MAX_LATITUDE_E7
+            || vertex->longitude_e7 < -MAX_LONGITUDE_E7 || vertex->longitude_e7 > MAX_LONGITUDE_E7)
+            return -1;
+        shape->min_latitude_e7 = (vertex->latitude_e7 < shape->min_latitude_e7) ? vertex->latitude_e7 : shape->min_latitude_e7;
+        shape->max_latitude_e7 = (vertex->latitude_e7 > shape->max_latitude_e7) ? vertex->latitude_e7 : shape->max_latitude_e7;
+        shape->min_longitude_e7 = (vertex->longitude_e7 < shape->min_longitude_e7) ? vertex->longitude_e7 : shape->min_longitude_e7;
+        shape->max_longitude_e7 = (vertex->longitude_e7 > shape->max_longitude_e7) ? vertex->longitude_e7 : shape->max_longitude_e7;
+    }
+    if ((int64_t) shape->max_longitude_e7 - shape->min_longitude_e7 > MAX_POLYGON_SPAN)
+        return -1;
+
+    shape->polygon.vertices = vertices;
+    shape->polygon.vertex_count = (uint32_t) vertex_count;
+    return (int) geofence->count++;
+}
+
+int gps_geofence_add_circle (gps_geofence_t *geofence, int32_t latitude_e7, int32_t longitude_e7, float radius)
+{
+    gps_geofence_shape_t *shape = new_shape (geofence);
+    if (shape == NULL || !(radius > 0) || isinf (radius)
+        || latitude_e7 < -MAX_LATITUDE_E7 || latitude_e7 > MAX_LATITUDE_E7
+        || longitude_e7 < -MAX_LONGITUDE_E7 || longitude_e7 > MAX_LONGITUDE_E7)
+        return -1;
+
+    shape->is_circle = 1;
+    shape->circle.center.latitude_e7 = latitude_e7;
+    shape->circle.center.longitude_e7 = longitude_e7;
+    shape->circle.radius_squared = radius * radius;
+    shape->circle.longitude_scale = METRES_PER_E7 * cosf ((float) latitude_e7 * RADIANS_PER_E7);
+
+    // the bounding box of the points passing circle_contains(), one unit larger for the float rounding
+    double half_height = (double) radius / METRES_PER_E7 + 1;
+    double half_width = (shape->circle.longitude_scale > 0) ? (double) radius / shape->circle.longitude_scale + 1 : MAX_LONGITUDE_E7;
+    half_height = (half_height < MAX_LATITUDE_E7) ? half_height : MAX_LATITUDE_E7;
+    half_width = (half_width < MAX_LONGITUDE_E7) ? half_width : MAX_LONGITUDE_E7;
+    shape->min_latitude_e7 = (latitude_e7 - half_height > -MAX_LATITUDE_E7) ? (int32_t) (latitude_e7 - half_height) : -MAX_LATITUDE_E7;
+    shape->max_latitude_e7 = (latitude_e7 + half_height < MAX_LATITUDE_E7) ? (int32_t) (latitude_e7 + half_height) : MAX_LATITUDE_E7;
+    shape->min_longitude_e7 = (longitude_e7 - half_width > -MAX_LONGITUDE_E7) ? (int32_t) (longitude_e7 - half_width) : -MAX_LONGITUDE_E7;
+    shape->max_longitude_e7 = (longitude_e7 + half_width < MAX_LONGITUDE_E7) ? (int32_t) (longitude_e7 + half_width) : MAX_LONGITUDE_E7;
+    return (int) geofence->count++;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Grid index
+//====================================================================================================================================================================================================================================================================
+
+// Range of cells covered by a bounding box, clamped to the grid
+static void cell_range (const gps_geofence_t *geofence, const gps_geofence_shape_t *shape,
+                        uint32_t *first_row, uint32_t *last_row, uint32_t *first_column, uint32_t *last_column)
+{
+    *first_row = (uint32_t) (((int64_t) shape->min_latitude_e7 - geofence->grid_latitude_e7) / geofence->cell_height_e7);
+    *last_row = (uint32_t) (((int64_t) shape->max_latitude_e7 - geofence->grid_latitude_e7) / geofence->cell_height_e7);
+    *first_column = (uint32_t) (((int64_t) shape->min_longitude_e7 - geofence->grid_longitude_e7) / geofence->cell_width_e7);
+    *last_column = (uint32_t) (((int64_t) shape->max_longitude_e7 - geofence->grid_longitude_e7) / geofence->cell_width_e7);
+    *last_row = (*last_row < geofence->rows) ? *last_row : geofence->rows - 1;
+    *last_column = (*last_column < geofence->columns) ? *last_column : geofence->columns - 1;
+}
+
+// Sets the grid to rows x columns over the bounding box, returns the number of cell entries it needs
+static size_t grid_layout (gps_geofence_t *geofence, int64_t height, int64_t width, uint32_t rows, uint32_t columns)
+{
+    size_t entries = 0;
+
+    geofence->rows = rows;
+    geofence->columns = columns;
+    geofence->cell_height_e7 = (uint32_t) ((height + rows - 1) / rows);
+    geofence->cell_width_e7 = (uint32_t) ((width + columns - 1) / columns);
+    for (size_t i = 0; i < geofence->count; i++){
+        uint32_t first_row, last_row, first_column, last_column;
+        cell_range (geofence, &geofence->shapes[i], &first_row, &last_row, &first_column, &last_column);
+        entries += (size_t) (last_row - first_row + 1) * (last_column - first_column + 1);
+    }
+    return entries;
+}
+
+int gps_geofence_build (gps_geofence_t *geofence)
+{
+    int32_t min_latitude = MAX_LATITUDE_E7, max_latitude = -MAX_LATITUDE_E7;
+    int32_t min_longitude = MAX_LONGITUDE_E7, max_longitude = -MAX_LONGITUDE_E7;
+    size_t count = geofence->count;
+
+    for (size_t i = 0; i < count; i++){
+        const gps_geofence_shape_t *shape = &geofence->shapes[i];
+        min_latitude = (shape->min_latitude_e7 < min_latitude) ? shape->min_latitude_e7 : min_latitude;
+        max_latitude = (shape->max_latitude_e7 > max_latitude) ? shape->max_latitude_e7 : max_latitude;
+        min_longitude = (shape->min_longitude_e7 < min_longitude) ? shape->min_longitude_e7 : min_longitude;
+        max_longitude = (shape->max_longitude_e7 > max_longitude) ? shape->max_longitude_e7 : max_longitude;
+    }
+    if (count == 0)
+        min_latitude = max_latitude = min_longitude = max_longitude = 0;
+    int64_t height = (int64_t) max_latitude - min_latitude + 1;
+    int64_t width = (int64_t) max_longitude - min_longitude + 1;
+    geofence->grid_latitude_e7 = min_latitude;
+    geofence->grid_longitude_e7 = min_longitude;
+
+    // about one cell per fence, with cells as square as the bounding box allows
+    uint32_t target = (count > 0) ? (uint32_t) count : 1;
+    uint32_t columns = (uint32_t) (sqrtf ((float) target * (float) width / (float) height) + 0.5f);
+    columns = (columns < 1) ? 1 : (columns > target) ? target : columns;
+    uint32_t rows = (target + columns - 1) / columns;
+
+    // coarser grids until the index fits: inside list, cell_start, then cell_fences
+    size_t inside_size = align_up (count * sizeof (uint16_t), sizeof (uint32_t));
+    size_t skip = align_up ((uintptr_t) geofence->index_storage, sizeof (uint32_t)) - (uintptr_t) geofence->index_storage;
+    size_t entries;
+    for (;;){
+        entries = grid_layout (geofence, height, width, rows, columns);
+        size_t cells_size = ((size_t) rows * columns + 1) * sizeof (uint32_t);
+        if (skip + inside_size + cells_size + entries * sizeof (uint16_t) <= geofence->index_size)
+            break;
+        if (rows == 1 && columns == 1)
+            return -1;
+        rows = (rows + 1) / 2;
+        columns = (columns + 1) / 2;
+    }
+
+    uint32_t cells = rows * columns;
+    geofence->inside = (uint16_t *) (geofence->index_storage + skip);
+    geofence->cell_start = (uint32_t *) (geofence->index_storage + skip + inside_size);
+    geofence->cell_fences = (uint16_t *) (geofence->cell_start + cells + 1);
+
+    // counting sort: sizes at cell + 1, starts by prefix sum, then each start moves up as entries are placed
+    memset (geofence->cell_start, 0, (cells + 1) * sizeof (uint32_t));
+    for (int pass = 0; pass < 2; pass++){
+        for (size_t i = 0; i < count; i++){
+            uint32_t first_row, last_row, first_column, last_column;
+            cell_range (geofence, &geofence->shapes[i], &first_row, &last_row, &first_column, &last_column);
+            for (uint32_t row = first_row; row <= last_row; row++){
+                for (uint32_t column = first_column; column <= last_column; column++){
+                    uint32_t cell = row * columns + column;
+                    if (pass == 0)
+                        geofence->cell_start[cell + 1]++;
+                    else
+                        geofence->cell_fences[geofence->cell_start[cell]++] = (uint16_t) i;
+                }
+            }
+        }
+        if (pass == 0){
+            for (uint32_t cell = 0; cell < cells; cell++)
+                geofence->cell_start[cell + 1] += geofence->cell_start[cell];
+        }
+    }
+    // each start now holds the start of the next cell
+    memmove (geofence->cell_start + 1, geofence->cell_start, cells * sizeof (uint32_t));
+    geofence->cell_start[0] = 0;
+
+    for (size_t i = 0; i < count; i++)
+        geofence->shapes[i].inside = 0;
+    geofence->inside_count = 0;
+    geofence->built = 1;
+    return 0;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Fix updates
+//====================================================================================================================================================================================================================================================================
+
+static void report (gps_geofence_t *geofence, int fence, gps_geofence_event_t event, const gps_data_parse_t *fix)
+{
+    if (geofence->callback != NULL)
+        geofence->callback (fence, event, fix, geofence->user_ctx);
+}
+
+int gps_geofence_update (gps_geofence_t *geofence, const gps_data_parse_t *fix)
+{
+    int32_t latitude_e7, longitude_e7;
+    int events = 0;
+
+    if (!geofence->built)
+        return -1;
+    if (!gps_fix_position_e7 (fix, &latitude_e7, &longitude_e7))
+        return 0;
+    geofence->tested = 0;
+
+    // fences left by moving out of their bounding box are not in the cell of the fix
+    for (size_t i = 0; i < geofence->inside_count; i++){
+        gps_geofence_shape_t *shape = &geofence->shapes[geofence->inside[i]];
+        if (!bounds_contain (shape, latitude_e7, longitude_e7)){
+            shape->inside = 0;
+            events++;
+            report (geofence, geofence->inside[i], GPS_GEOFENCE_EXIT, fix);
+        }
+    }
+
+    int64_t row = ((int64_t) latitude_e7 - geofence->grid_latitude_e7) / geofence->cell_height_e7;
+    int64_t column = ((int64_t) longitude_e7 - geofence->grid_longitude_e7) / geofence->cell_width_e7;
+    if (latitude_e7 >= geofence->grid_latitude_e7 && longitude_e7 >= geofence->grid_longitude_e7
+        && row < geofence->rows && column < geofence->columns){
+        uint32_t cell = (uint32_t) row * geofence->columns + (uint32_t) column;
+        for (uint32_t k = geofence->cell_start[cell]; k < geofence->cell_start[cell + 1]; k++){
+            uint16_t fence = geofence->cell_fences[k];
+            gps_geofence_shape_t *shape = &geofence->shapes[fence];
+            geofence->tested++;
+            uint8_t inside = (uint8_t) shape_contains (shape, latitude_e7, longitude_e7);
+            if (inside == shape->inside)
+                continue;
+            shape->inside = inside;
+            if (inside)
+                geofence->inside[geofence->inside_count++] = fence;
+            events++;
+            report (geofence, fence, inside ? GPS_GEOFENCE_ENTER : GPS_GEOFENCE_EXIT, fix);
+        }
+    }
+
+    // drop the fences left from the inside list
+    size_t kept = 0;
+    for (size_t i = 0; i < geofence->inside_count; i++){
+        if (geofence->shapes[geofence->inside[i]].inside)
+            geofence->inside[kept++] = geofence->inside[i];
+    }
+    geofence->inside_count = kept;
+    return events;
+}
+
+int gps_geofence_is_inside (const gps_geofence_t *geofence, int fence)
+{
+    if (fence < 0 || (size_t) fence >= geofence->count)
+        return 0;
+    return geofence->shapes[fence].inside;
+}
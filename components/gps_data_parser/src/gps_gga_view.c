@@ -0,0 +1,136 @@
+/**
+ * @file gps_gga_view.c
+ * @brief Lazy GGA decoding: tokenize once, convert a field group when it is first read.
+ *
+ * Tokenizing records offsets into the caller's sentence. A field group is converted by running
+ * the same group decoder as gps_data_parse() on spans of the sentence, so both paths give
+ * identical results and no field is copied.
+ */
+
+#include "gps_gga_view.h"
+#include "gps_nmea_scan.h"
+#include "gps_nmea_sentence.h"
+#include "gps_parser_private.h"
+
+gps_parse_result_t gps_gga_view_init (gps_gga_view_t *view, const char *sentence, size_t length)
+{
+    view->sentence = sentence;
+    view->decoded_float = 0;
+    view->decoded_fixed_point = 0;
+    view->invalid_fields = 0;
+    gps_gga_set_defaults (&view->data);
+
+    if (sentence == NULL || length < 7 || sentence[0] != '$' || sentence[6] != ',')
+        return GPS_PARSE_ERR_FORMAT;
+
+    // the body ends at the '*', which must be followed by the checksum digits and nothing or CRLF
+    uint8_t checksum;
+    size_t star = 1 + gps_nmea_scan_checksum (sentence + 1, length - 1, &checksum);
+    if (star + 3 > length || sentence[star] != '*' || star + 3 > GPS_NMEA_MAX_SENTENCE_LEN)
+        return GPS_PARSE_ERR_FORMAT;
+    if (length != star + 3 && (length != star + 5 || sentence[star + 3] != '\r' || sentence[star + 4] != '\n'))
+        return GPS_PARSE_ERR_FORMAT;
+    if (gps_nmea_hex_byte (sentence + star + 1) != checksum)
+        return GPS_PARSE_ERR_CHECKSUM;
+
+    if (gps_nmea_sentence_identify (sentence + 1, NULL) != GPS_SENTENCE_GGA)
+        return GPS_PARSE_ERR_UNSUPPORTED;
+
+    // record the fields between '$' and '*'
+    int field_count = 0;
+    size_t start = 0;
+    for (;;){
+        size_t end = start + gps_nmea_scan_field (sentence + start, star - start);
+        if (field_count < GGA_FIELD_COUNT){
+            view->field_offset[field_count] = (uint8_t) start;
+            view->field_length[field_count] = (uint8_t) (end - start);
+        }
+        field_count++;
+        if (end == star)
+            break;
+        start = end + 1;
+    }
+    return (field_count == GGA_FIELD_COUNT) ? GPS_PARSE_OK : GPS_PARSE_ERR_FIELD_COUNT;
+}
+
+const gps_data_parse_t * gps_gga_view_decode (gps_gga_view_t *view, uint32_t fields, uint32_t decode_flags)
+{
+    gps_nmea_span_t field_values[GGA_FIELD_COUNT];
+
+    for (int i = 0; i < GGA_FIELD_COUNT; i++){
+        field_values[i].data = view->sentence + view->field_offset[i];
+        field_values[i].length = view->field_length[i];
+    }
+
+    for (uint32_t field = 1; field & GPS_GGA_FIELD_ALL; field <<= 1){
+        if (!(fields & field))
+            continue;
+
+        uint32_t flags = 0;
+        if ((decode_flags & GPS_DECODE_FLOAT) && !(view->decoded_float & field))
+            flags |= GPS_DECODE_FLOAT;
+        if ((decode_flags & GPS_DECODE_FIXED_POINT) && !(view->decoded_fixed_point & field))
+            flags |= GPS_DECODE_FIXED_POINT;
+        if (flags == 0)
+            continue;
+
+        view->invalid_fields |= gps_gga_field_decode (field_values, field, flags, &view->data);
+        view->decoded_float |= (flags & GPS_DECODE_FLOAT) ? field : 0;
+        view->decoded_fixed_point |= (flags & GPS_DECODE_FIXED_POINT) ? field : 0;
+    }
+    return &view->data;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Typed accessors
+//====================================================================================================================================================================================================================================================================
+
+const gps_time_t * gps_gga_view_time (gps_gga_view_t *view)
+{
+    return &gps_gga_view_decode (view, GPS_GGA_FIELD_TIME, GPS_DECODE_FLOAT)->time;
+}
+
+float gps_gga_view_latitude (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_LATITUDE, GPS_DECODE_FLOAT)->latitude;
+}
+
+float gps_gga_view_longitude (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_LONGITUDE, GPS_DECODE_FLOAT)->longitude;
+}
+
+int32_t gps_gga_view_latitude_e7 (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_LATITUDE, GPS_DECODE_FIXED_POINT)->latitude_e7;
+}
+
+int32_t gps_gga_view_longitude_e7 (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_LONGITUDE, GPS_DECODE_FIXED_POINT)->longitude_e7;
+}
+
+int gps_gga_view_fix_quality (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_FIX_QUALITY, GPS_DECODE_FLOAT)->fix_quality;
+}
+
+int gps_gga_view_num_satellites (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_SATELLITES, GPS_DECODE_FLOAT)->num_satellites;
+}
+
+float gps_gga_view_hdop (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_HDOP, GPS_DECODE_FLOAT)->hdop;
+}
+
+float gps_gga_view_altitude (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_ALTITUDE, GPS_DECODE_FLOAT)->altitude;
+}
+
+int32_t gps_gga_view_altitude_mm (gps_gga_view_t *view)
+{
+    return gps_gga_view_decode (view, GPS_GGA_FIELD_ALTITUDE, GPS_DECODE_FIXED_POINT)->altitude_mm;
+}
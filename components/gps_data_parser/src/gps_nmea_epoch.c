@@ -0,0 +1,237 @@
+/**
+ * @file gps_nmea_epoch.c
+ * @brief Per-epoch aggregation of GGA, RMC, GSA, VTG and GLL sentences into one gps_fix_t.
+ *
+ * Epochs are delimited by the UTC time of the timed sentences. Every member of the fix is
+ * filled by the first sentence of the epoch that provides a valid value for it, so the order
+ * in which a receiver emits its sentences does not matter.
+ */
+
+#include <string.h>
+
+#include "gps_nmea_epoch.h"
+
+static void epoch_start (gps_nmea_epoch_t *epoch, const gps_time_t *time);
+static void epoch_publish (gps_nmea_epoch_t *epoch);
+static void epoch_merge (gps_fix_t *fix, const gps_nmea_msg_t *msg);
+static const gps_time_t * sentence_time (const gps_nmea_msg_t *msg);
+static int time_equal (const gps_time_t *a, const gps_time_t *b);
+
+void gps_nmea_epoch_init (gps_nmea_epoch_t *epoch, uint32_t required, gps_fix_cb_t callback, void *user_ctx)
+{
+    memset (epoch, 0, sizeof (*epoch));
+    epoch->required = required;
+    epoch->callback = callback;
+    epoch->user_ctx = user_ctx;
+    epoch->open = 0;
+    epoch->published_time.hour = DEFAULT_GPS_TIME_HR;
+    epoch->published_time.minute = DEFAULT_GPS_TIME_MIN;
+    epoch->published_time.second = DEFAULT_GPS_TIME_SEC;
+    epoch->published_time.millisecond = DEFAULT_GPS_TIME_MS;
+}
+
+int gps_nmea_epoch_add (gps_nmea_epoch_t *epoch, const gps_nmea_msg_t *msg)
+{
+    int published = 0;
+
+    if (msg->type == GPS_SENTENCE_UNKNOWN || msg->type == GPS_SENTENCE_GSV)
+        return 0;
+
+    const gps_time_t *time = sentence_time (msg);
+    if (time != NULL){
+        // the rest of an epoch that was already completed
+        if (!epoch->open && time_equal (time, &epoch->published_time))
+            return 0;
+
+        // a new time closes the epoch being assembled and opens the next one
+        if (epoch->open && !time_equal (time, &epoch->fix.time)){
+            epoch_publish (epoch);
+            published++;
+        }
+        if (!epoch->open)
+            epoch_start (epoch, time);
+    }
+    else if (!epoch->open){
+        // untimed sentence whose epoch cannot be known
+        return 0;
+    }
+
+    epoch_merge (&epoch->fix, msg);
+
+    if ((epoch->fix.sources & epoch->required) == epoch->required){
+        epoch_publish (epoch);
+        published++;
+    }
+    return published;
+}
+
+int gps_nmea_epoch_flush (gps_nmea_epoch_t *epoch)
+{
+    if (!epoch->open)
+        return 0;
+    epoch_publish (epoch);
+    return 1;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Epoch bookkeeping
+//====================================================================================================================================================================================================================================================================
+
+// Opens an epoch at time with every member of the fix set to its default
+static void epoch_start (gps_nmea_epoch_t *epoch, const gps_time_t *time)
+{
+    gps_fix_t *fix = &epoch->fix;
+
+    fix->time = *time;
+    fix->date.day = fix->date.month = DEFAULT_DATE;
+    fix->date.year = DEFAULT_DATE;
+    fix->utc_ms = DEFAULT_UTC_MS;
+    fix->rx_time.first_us = 0;
+    fix->rx_time.last_us = 0;
+    fix->sources = 0;
+    fix->latitude = DEFAULT_LATITUDE;
+    fix->longitude = DEFAULT_LONGITUDE;
+    fix->altitude = DEFAULT_ALTITUDE;
+    fix->geoid_height = DEFAULT_GEOID_HEIGHT;
+    fix->latitude_e7 = DEFAULT_LATITUDE_E7;
+    fix->longitude_e7 = DEFAULT_LONGITUDE_E7;
+    fix->altitude_mm = DEFAULT_ALTITUDE_MM;
+    fix->fix_quality = DEFAULT_FIX_QUALITY;
+    fix->num_satellites = DEFAULT_NUM_SATELLITES;
+    fix->fix_type = DEFAULT_FIX_QUALITY;
+    fix->hdop = DEFAULT_HDOP;
+    fix->pdop = DEFAULT_DOP;
+    fix->vdop = DEFAULT_DOP;
+    fix->speed_knots = DEFAULT_SPEED;
+    fix->speed_kmh = DEFAULT_SPEED;
+    fix->course = DEFAULT_COURSE;
+    fix->status = DEFAULT_STATUS;
+    fix->mode = DEFAULT_MODE;
+    epoch->open = 1;
+}
+
+static void epoch_publish (gps_nmea_epoch_t *epoch)
+{
+    epoch->open = 0;
+    epoch->published_time = epoch->fix.time;
+    if (epoch->callback != NULL)
+        epoch->callback (&epoch->fix, epoch->user_ctx);
+}
+
+// Returns the UTC time of a timed sentence, NULL for untimed sentences or an empty time field
+static const gps_time_t * sentence_time (const gps_nmea_msg_t *msg)
+{
+    const gps_time_t *time;
+
+    switch (msg->type){
+        case GPS_SENTENCE_GGA: time = &msg->data.gga.time; break;
+        case GPS_SENTENCE_RMC: time = &msg->data.rmc.time; break;
+        case GPS_SENTENCE_GLL: time = &msg->data.gll.time; break;
+        default: return NULL;
+    }
+    return (time->hour == DEFAULT_GPS_TIME_HR) ? NULL : time;
+}
+
+static int time_equal (const gps_time_t *a, const gps_time_t *b)
+{
+    return a->hour == b->hour && a->minute == b->minute && a->second == b->second && a->millisecond == b->millisecond;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Merging, the first valid value of the epoch wins
+//====================================================================================================================================================================================================================================================================
+
+static void merge_float (float *member, float value, float default_value)
+{
+    if (*member == default_value)
+        *member = value;
+}
+
+static void merge_int (int *member, int value, int default_value)
+{
+    if (*member == default_value)
+        *member = value;
+}
+
+static void merge_char (char *member, char value, char default_value)
+{
+    if (*member == default_value)
+        *member = value;
+}
+
+// Latitude and longitude are only taken together
+static void merge_position (gps_fix_t *fix, float latitude, float longitude)
+{
+    if (fix->latitude == DEFAULT_LATITUDE && latitude != DEFAULT_LATITUDE && longitude != DEFAULT_LONGITUDE){
+        fix->latitude = latitude;
+        fix->longitude = longitude;
+    }
+}
+
+static void epoch_merge (gps_fix_t *fix, const gps_nmea_msg_t *msg)
+{
+    if (fix->sources == 0)
+        fix->rx_time.first_us = msg->rx_time.first_us;
+    fix->rx_time.last_us = msg->rx_time.last_us;
+    fix->sources |= GPS_FIX_SOURCE (msg->type);
+
+    switch (msg->type){
+        case GPS_SENTENCE_GGA:{
+            const gps_data_parse_t *gga = &msg->data.gga;
+            merge_position (fix, gga->latitude, gga->longitude);
+            merge_float (&fix->altitude, gga->altitude, DEFAULT_ALTITUDE);
+            merge_float (&fix->geoid_height, gga->geoid_height, DEFAULT_GEOID_HEIGHT);
+            if (fix->latitude_e7 == DEFAULT_LATITUDE_E7 && gga->latitude_e7 != DEFAULT_LATITUDE_E7
+                && gga->longitude_e7 != DEFAULT_LONGITUDE_E7){
+                fix->latitude_e7 = gga->latitude_e7;
+                fix->longitude_e7 = gga->longitude_e7;
+            }
+            if (fix->altitude_mm == DEFAULT_ALTITUDE_MM)
+                fix->altitude_mm = gga->altitude_mm;
+            if (fix->utc_ms == DEFAULT_UTC_MS)
+                fix->utc_ms = gga->utc_ms;
+            merge_int (&fix->fix_quality, gga->fix_quality, DEFAULT_FIX_QUALITY);
+            merge_int (&fix->num_satellites, gga->num_satellites, DEFAULT_NUM_SATELLITES);
+            merge_float (&fix->hdop, gga->hdop, DEFAULT_HDOP);
+            break;
+        }
+        case GPS_SENTENCE_RMC:{
+            const gps_rmc_t *rmc = &msg->data.rmc;
+            if (fix->date.day == DEFAULT_DATE)
+                fix->date = rmc->date;
+            if (fix->utc_ms == DEFAULT_UTC_MS)
+                fix->utc_ms = rmc->utc_ms;
+            merge_position (fix, rmc->latitude, rmc->longitude);
+            merge_float (&fix->speed_knots, rmc->speed_knots, DEFAULT_SPEED);
+            merge_float (&fix->course, rmc->course, DEFAULT_COURSE);
+            merge_char (&fix->status, rmc->status, DEFAULT_STATUS);
+            merge_char (&fix->mode, rmc->mode, DEFAULT_MODE);
+            break;
+        }
+        case GPS_SENTENCE_GSA:{
+            const gps_gsa_t *gsa = &msg->data.gsa;
+            merge_int (&fix->fix_type, gsa->fix_type, DEFAULT_FIX_QUALITY);
+            merge_float (&fix->hdop, gsa->hdop, DEFAULT_DOP);
+            merge_float (&fix->pdop, gsa->pdop, DEFAULT_DOP);
+            merge_float (&fix->vdop, gsa->vdop, DEFAULT_DOP);
+            break;
+        }
+        case GPS_SENTENCE_VTG:{
+            const gps_vtg_t *vtg = &msg->data.vtg;
+            merge_float (&fix->speed_knots, vtg->speed_knots, DEFAULT_SPEED);
+            merge_float (&fix->speed_kmh, vtg->speed_kmh, DEFAULT_SPEED);
+            merge_float (&fix->course, vtg->course_true, DEFAULT_COURSE);
+            merge_char (&fix->mode, vtg->mode, DEFAULT_MODE);
+            break;
+        }
+        case GPS_SENTENCE_GLL:{
+            const gps_gll_t *gll = &msg->data.gll;
+            merge_position (fix, gll->latitude, gll->longitude);
+            merge_char (&fix->status, gll->status, DEFAULT_STATUS);
+            merge_char (&fix->mode, gll->mode, DEFAULT_MODE);
+            break;
+        }
+        default:
+            break;
+    }
+}
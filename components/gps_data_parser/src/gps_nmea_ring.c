@@ -0,0 +1,242 @@
+/**
+ * @file gps_nmea_ring.c
+ * @brief Lock-free SPSC byte ring with in place sentence framing across the wrap point.
+ *
+ * head and tail are free running byte counters, their difference is the fill level and
+ * counter & (capacity - 1) the position in the storage. The producer stores head with release
+ * semantics after writing the bytes, the consumer loads it with acquire semantics before
+ * reading them; tail is handed back the same way.
+ */
+
+#include <string.h>
+
+#include "gps_nmea_ring.h"
+#include "gps_nmea_scan.h"
+
+static size_t view_find (const gps_nmea_view_t *view, size_t from, char c);
+static size_t view_scan_checksum (const gps_nmea_view_t *view, size_t from, size_t limit, uint8_t *checksum);
+static char view_at (const gps_nmea_view_t *view, size_t index);
+static void view_slice (const gps_nmea_view_t *view, size_t from, size_t to, gps_nmea_view_t *slice);
+
+int gps_nmea_ring_init (gps_nmea_ring_t *ring, char *storage, size_t capacity)
+{
+    // a full ring must hold the longest sentence and its CRLF, or next_sentence can never make progress
+    if (capacity < GPS_NMEA_MAX_SENTENCE_LEN + 2 || (capacity & (capacity - 1)) != 0)
+        return -1;
+
+    ring->buffer = storage;
+    ring->capacity = capacity;
+    atomic_init (&ring->head, 0);
+    atomic_init (&ring->tail, 0);
+    ring->resume_offset = 0;
+    ring->resume_checksum = 0;
+    return 0;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Producer
+//====================================================================================================================================================================================================================================================================
+
+size_t gps_nmea_ring_write_reserve (gps_nmea_ring_t *ring, char **region)
+{
+    size_t head = atomic_load_explicit (&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit (&ring->tail, memory_order_acquire);
+    size_t position = head & (ring->capacity - 1);
+    size_t free_bytes = ring->capacity - (head - tail);
+    size_t to_end = ring->capacity - position;
+
+    *region = ring->buffer + position;
+    return (free_bytes < to_end) ? free_bytes : to_end;
+}
+
+void gps_nmea_ring_write_commit (gps_nmea_ring_t *ring, size_t length)
+{
+    size_t head = atomic_load_explicit (&ring->head, memory_order_relaxed);
+    atomic_store_explicit (&ring->head, head + length, memory_order_release);
+}
+
+size_t gps_nmea_ring_write (gps_nmea_ring_t *ring, const char *data, size_t length)
+{
+    size_t head = atomic_load_explicit (&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit (&ring->tail, memory_order_acquire);
+    size_t position = head & (ring->capacity - 1);
+    size_t free_bytes = ring->capacity - (head - tail);
+    size_t to_end = ring->capacity - position;
+
+    if (length > free_bytes)
+        length = free_bytes;
+
+    // up to the end of the storage, then from its start
+    size_t first = (length < to_end) ? length : to_end;
+    memcpy (ring->buffer + position, data, first);
+    memcpy (ring->buffer, data + first, length - first);
+
+    // publish the whole write with one release store
+    atomic_store_explicit (&ring->head, head + length, memory_order_release);
+    return length;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Consumer
+//====================================================================================================================================================================================================================================================================
+
+size_t gps_nmea_ring_peek (gps_nmea_ring_t *ring, gps_nmea_view_t *view)
+{
+    size_t tail = atomic_load_explicit (&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit (&ring->head, memory_order_acquire);
+    size_t position = tail & (ring->capacity - 1);
+    size_t used = head - tail;
+    size_t to_end = ring->capacity - position;
+
+    view->segment[0].data = ring->buffer + position;
+    view->segment[0].length = (used < to_end) ? used : to_end;
+    view->segment[1].data = ring->buffer;
+    view->segment[1].length = used - view->segment[0].length;
+    return used;
+}
+
+void gps_nmea_ring_consume (gps_nmea_ring_t *ring, size_t length)
+{
+    size_t tail = atomic_load_explicit (&ring->tail, memory_order_relaxed);
+    atomic_store_explicit (&ring->tail, tail + length, memory_order_release);
+}
+
+gps_parse_result_t gps_nmea_ring_next_sentence (gps_nmea_ring_t *ring, gps_nmea_view_t *sentence, size_t *advance)
+{
+    gps_nmea_view_t view;
+    size_t length = gps_nmea_ring_peek (ring, &view);
+    size_t start, j;
+    uint8_t checksum;
+
+    if (ring->resume_offset != 0 && ring->resume_offset <= length && view_at (&view, 0) == '$'){
+        // continue the incomplete sentence at the tail where the previous call stopped
+        start = 0;
+        j = ring->resume_offset;
+        checksum = ring->resume_checksum;
+    }
+    else{
+        start = view_find (&view, 0, '$');
+        if (start == length){
+            ring->resume_offset = 0;
+            *advance = length;
+            return GPS_PARSE_INCOMPLETE;
+        }
+        j = start + 1;
+        checksum = 0;
+    }
+    ring->resume_offset = 0;
+
+    // scan no further than the longest sentence allows
+    size_t limit = start + GPS_NMEA_MAX_SENTENCE_LEN - 2;
+    if (limit > length)
+        limit = length;
+    j = view_scan_checksum (&view, j, limit, &checksum);
+
+    if (j + 3 - start > GPS_NMEA_MAX_SENTENCE_LEN){
+        // too long to be a sentence, resume after its '$' so a full ring always makes progress
+        *advance = start + 1;
+        return GPS_PARSE_ERR_FORMAT;
+    }
+    if (j == length || (view_at (&view, j) == '*' && j + 4 >= length)){
+        // sentence is not complete yet, drop the noise before it and remember how far it was scanned
+        ring->resume_offset = j - start;
+        ring->resume_checksum = checksum;
+        *advance = start;
+        return GPS_PARSE_INCOMPLETE;
+    }
+    if (view_at (&view, j) != '*'){
+        // no checksum, or a new '$' interrupted this sentence: resume from the interrupting byte
+        *advance = j;
+        return GPS_PARSE_ERR_FORMAT;
+    }
+
+    // "*hh\r\n" must follow the body
+    int hi = gps_nmea_hex_digit (view_at (&view, j + 1));
+    int lo = gps_nmea_hex_digit (view_at (&view, j + 2));
+    *advance = j + 1;
+    if (hi < 0 || lo < 0 || ((hi << 4) | lo) != checksum)
+        return GPS_PARSE_ERR_CHECKSUM;
+    if (view_at (&view, j + 3) != '\r' || view_at (&view, j + 4) != '\n')
+        return GPS_PARSE_ERR_FORMAT;
+    *advance = j + 5;
+
+    view_slice (&view, start, j + 3, sentence);
+    return GPS_PARSE_OK;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Two segment view helpers, index 0 is the first byte of segment[0]
+//====================================================================================================================================================================================================================================================================
+
+// Returns the index of the first c at or after from, the view length if there is none
+static size_t view_find (const gps_nmea_view_t *view, size_t from, char c)
+{
+    size_t offset = 0;
+
+    for (int i = 0; i < 2; i++){
+        const gps_nmea_span_t *segment = &view->segment[i];
+        if (from < offset + segment->length){
+            size_t skip = (from > offset) ? from - offset : 0;
+            const char *found = memchr (segment->data + skip, c, segment->length - skip);
+            if (found != NULL)
+                return offset + (size_t) (found - segment->data);
+        }
+        offset += segment->length;
+    }
+    return offset;
+}
+
+// gps_nmea_scan_checksum() over [from, limit) of the view, XORs the body bytes into checksum
+static size_t view_scan_checksum (const gps_nmea_view_t *view, size_t from, size_t limit, uint8_t *checksum)
+{
+    size_t offset = 0;
+    size_t index = from;
+
+    for (int i = 0; i < 2 && index < limit; i++){
+        const gps_nmea_span_t *segment = &view->segment[i];
+        size_t end = offset + segment->length;
+        if (end > limit)
+            end = limit;
+        if (index < end){
+            uint8_t part;
+            size_t scanned = gps_nmea_scan_checksum (segment->data + (index - offset), end - index, &part);
+            *checksum ^= part;
+            index += scanned;
+            if (index < end)
+                return index;   // delimiter found in this segment
+        }
+        offset += segment->length;
+    }
+    return index;
+}
+
+static char view_at (const gps_nmea_view_t *view, size_t index)
+{
+    size_t first = view->segment[0].length;
+    return (index < first) ? view->segment[0].data[index] : view->segment[1].data[index - first];
+}
+
+// Sets slice to the bytes [from, to) of view
+static void view_slice (const gps_nmea_view_t *view, size_t from, size_t to, gps_nmea_view_t *slice)
+{
+    size_t first = view->segment[0].length;
+
+    if (from >= first){
+        slice->segment[0].data = view->segment[1].data + (from - first);
+        slice->segment[0].length = to - from;
+        slice->segment[1].data = view->segment[1].data;
+        slice->segment[1].length = 0;
+    }
+    else if (to <= first){
+        slice->segment[0].data = view->segment[0].data + from;
+        slice->segment[0].length = to - from;
+        slice->segment[1].data = view->segment[1].data;
+        slice->segment[1].length = 0;
+    }
+    else{
+        slice->segment[0].data = view->segment[0].data + from;
+        slice->segment[0].length = first - from;
+        slice->segment[1].data = view->segment[1].data;
+        slice->segment[1].length = to - first;
+    }
+}
@@ -0,0 +1,205 @@
+/**
+ * @file gps_nmea_scan.c
+ * @brief Delimiter search and XOR checksum kernels, SSE2 / NEON / SWAR with a scalar tail.
+ *
+ * Each kernel skips whole blocks that hold no delimiter (XORing them into a block wide
+ * accumulator for the checksum) and finishes the block holding the delimiter byte by byte.
+ * The SWAR kernel first steps byte by byte to a word boundary, as targets such as the ESP32
+ * cannot load a word from an unaligned address in a single instruction.
+ */
+
+#include <string.h>
+
+#include "gps_nmea_scan.h"
+
+#if GPS_NMEA_SCAN_SCALAR
+#define SCAN_SCALAR_ONLY 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SCAN_NEON 1
+#else
+#define SCAN_SWAR 1
+#endif
+
+#define IS_FIELD_END(c)     ((c) == ',' || (c) == '*')
+#define IS_BODY_END(c)      ((c) == '*' || (c) == '$' || (c) == '\r' || (c) == '\n')
+
+#if SCAN_SWAR
+// One machine word: 4 bytes on ESP32 targets, 8 on 64 bit hosts without SSE2/NEON
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t scan_word_t;
+#else
+typedef uint32_t scan_word_t;
+#endif
+
+#define SWAR_ONES   ((scan_word_t) -1 / 0xFF)   // 0x0101...01
+#define SWAR_LOW7   (SWAR_ONES * 0x7F)          // 0x7F7F...7F
+
+// Sets the high bit of every byte of v equal to c (exact, no false positives from borrows)
+static inline scan_word_t swar_match (scan_word_t v, unsigned char c)
+{
+    scan_word_t x = v ^ (SWAR_ONES * c);
+    return ~(((x & SWAR_LOW7) + SWAR_LOW7) | x | SWAR_LOW7);
+}
+
+// Nonzero while p is not on a word boundary
+#define SWAR_MISALIGNED(p)  (((uintptr_t) (p)) & (sizeof (scan_word_t) - 1))
+
+// p must be word aligned: memcpy avoids aliasing the char data, and with the alignment known
+// it compiles to a single aligned load
+static inline scan_word_t swar_load (const char *p)
+{
+    scan_word_t v;
+    memcpy (&v, __builtin_assume_aligned (p, sizeof (scan_word_t)), sizeof (v));
+    return v;
+}
+
+static inline uint8_t swar_fold (scan_word_t v)
+{
+#if UINTPTR_MAX > 0xFFFFFFFFu
+    v ^= v >> 32;
+#endif
+    v ^= v >> 16;
+    v ^= v >> 8;
+    return (uint8_t) v;
+}
+#endif
+
+size_t gps_nmea_scan_field (const char *data, size_t length)
+{
+    size_t i = 0;
+
+#if SCAN_SSE2
+    const __m128i comma = _mm_set1_epi8 (',');
+    const __m128i star = _mm_set1_epi8 ('*');
+    for (; i + 16 <= length; i += 16){
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+        int mask = _mm_movemask_epi8 (_mm_or_si128 (_mm_cmpeq_epi8 (v, comma), _mm_cmpeq_epi8 (v, star)));
+        if (mask != 0)
+            return i + (size_t) __builtin_ctz ((unsigned) mask);
+    }
+#elif SCAN_NEON
+    const uint8x16_t comma = vdupq_n_u8 (',');
+    const uint8x16_t star = vdupq_n_u8 ('*');
+    for (; i + 16 <= length; i += 16){
+        uint8x16_t v = vld1q_u8 ((const uint8_t *) (data + i));
+        if (vmaxvq_u8 (vorrq_u8 (vceqq_u8 (v, comma), vceqq_u8 (v, star))) != 0)
+            break;
+    }
+#elif SCAN_SWAR
+    for (; i < length && SWAR_MISALIGNED (data + i); i++){
+        if (IS_FIELD_END (data[i]))
+            return i;
+    }
+    for (; i + sizeof (scan_word_t) <= length; i += sizeof (scan_word_t)){
+        scan_word_t v = swar_load (data + i);
+        if ((swar_match (v, ',') | swar_match (v, '*')) != 0)
+            break;
+    }
+#endif
+
+    for (; i < length; i++){
+        if (IS_FIELD_END (data[i]))
+            break;
+    }
+    return i;
+}
+
+size_t gps_nmea_scan_checksum (const char *data, size_t length, uint8_t *checksum)
+{
+    size_t i = 0;
+    uint8_t sum = 0;
+
+#if SCAN_SSE2
+    const __m128i star = _mm_set1_epi8 ('*');
+    const __m128i dollar = _mm_set1_epi8 ('$');
+    const __m128i cr = _mm_set1_epi8 ('\r');
+    const __m128i lf = _mm_set1_epi8 ('\n');
+    __m128i acc = _mm_setzero_si128 ();
+    for (; i + 16 <= length; i += 16){
+        __m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+        __m128i hit = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (v, star), _mm_cmpeq_epi8 (v, dollar)),
+                                    _mm_or_si128 (_mm_cmpeq_epi8 (v, cr), _mm_cmpeq_epi8 (v, lf)));
+        if (_mm_movemask_epi8 (hit) != 0)
+            break;
+        acc = _mm_xor_si128 (acc, v);
+    }
+    acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 8));
+    acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 4));
+    acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 2));
+    acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 1));
+    sum = (uint8_t) _mm_cvtsi128_si32 (acc);
+#elif SCAN_NEON
+    const uint8x16_t star = vdupq_n_u8 ('*');
+    const uint8x16_t dollar = vdupq_n_u8 ('$');
+    const uint8x16_t cr = vdupq_n_u8 ('\r');
+    const uint8x16_t lf = vdupq_n_u8 ('\n');
+    uint8x16_t acc = vdupq_n_u8 (0);
+    for (; i + 16 <= length; i += 16){
+        uint8x16_t v = vld1q_u8 ((const uint8_t *) (data + i));
+        uint8x16_t hit = vorrq_u8 (vorrq_u8 (vceqq_u8 (v, star), vceqq_u8 (v, dollar)),
+                                   vorrq_u8 (vceqq_u8 (v, cr), vceqq_u8 (v, lf)));
+        if (vmaxvq_u8 (hit) != 0)
+            break;
+        acc = veorq_u8 (acc, v);
+    }
+    uint64x2_t halves = vreinterpretq_u64_u8 (acc);
+    uint64_t folded = vgetq_lane_u64 (halves, 0) ^ vgetq_lane_u64 (halves, 1);
+    folded ^= folded >> 32;
+    folded ^= folded >> 16;
+    folded ^= folded >> 8;
+    sum = (uint8_t) folded;
+#elif SCAN_SWAR
+    for (; i < length && SWAR_MISALIGNED (data + i); i++){
+        char c = data[i];
+        if (IS_BODY_END (c)){
+            *checksum = sum;
+            return i;
+        }
+        sum ^= (uint8_t) c;
+    }
+    scan_word_t acc = 0;
+    for (; i + sizeof (scan_word_t) <= length; i += sizeof (scan_word_t)){
+        scan_word_t v = swar_load (data + i);
+        if ((swar_match (v, '*') | swar_match (v, '$') | swar_match (v, '\r') | swar_match (v, '\n')) != 0)
+            break;
+        acc ^= v;
+    }
+    sum ^= swar_fold (acc);
+#endif
+
+    for (; i < length; i++){
+        char c = data[i];
+        if (IS_BODY_END (c))
+            break;
+        sum ^= (uint8_t) c;
+    }
+
+    *checksum = sum;
+    return i;
+}
+
+int gps_nmea_hex_digit (char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+int gps_nmea_hex_byte (const char *digits)
+{
+    int hi = gps_nmea_hex_digit (digits[0]);
+    if (hi < 0)
+        return -1;
+    int lo = gps_nmea_hex_digit (digits[1]);
+    if (lo < 0)
+        return -1;
+    return (hi << 4) | lo;
+}
@@ -0,0 +1,406 @@
+/**
+ * @file gps_nmea_sentence.c
+ * @brief Table driven dispatch of NMEA 0183 sentences to per-type decoders.
+ *
+ * The talker ID is resolved by indexing a table with its second character and the sentence
+ * type by indexing an 8 entry table with a hash of its last two characters, both lookups are
+ * confirmed with a single comparison so no chain of strcmp calls is needed.
+ */
+
+#include <string.h>
+
+#include "gps_nmea_sentence.h"
+#include "gps_nmea_scan.h"
+#include "gps_parser_private.h"
+
+// Decodes the tokenized fields of ctx into msg, returns the mask of present but invalid fields
+typedef uint32_t (*sentence_decoder_t) (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+
+static uint32_t gga_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+static uint32_t rmc_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+static uint32_t gsa_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+static uint32_t gsv_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+static uint32_t vtg_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+static uint32_t gll_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg);
+static int date_decode (gps_nmea_span_t field, gps_date_t *date);
+static char char_field (gps_nmea_span_t field, char default_value, int *valid);
+
+// Slot of a sentence type in s_sentence_table, collision free for the supported types
+#define SENTENCE_SLOT(c1, c2) ((((unsigned char) (c1)) + (((unsigned char) (c2)) << 1)) & 7)
+
+typedef struct {
+    char name[4];                   // sentence type, e.g. "GGA"
+    gps_sentence_type_t type;
+    int min_fields;                 // field count range including the address field
+    int max_fields;
+    sentence_decoder_t decode;
+} sentence_entry_t;
+
+// Indexed by SENTENCE_SLOT() of the last two characters of the sentence type
+static const sentence_entry_t s_sentence_table[8] = {
+    [SENTENCE_SLOT ('G', 'A')] = { "GGA", GPS_SENTENCE_GGA, GGA_FIELD_COUNT, GGA_FIELD_COUNT, gga_decode },
+    [SENTENCE_SLOT ('M', 'C')] = { "RMC", GPS_SENTENCE_RMC, 12, 14, rmc_decode },
+    [SENTENCE_SLOT ('S', 'A')] = { "GSA", GPS_SENTENCE_GSA, 18, 19, gsa_decode },
+    [SENTENCE_SLOT ('S', 'V')] = { "GSV", GPS_SENTENCE_GSV, 4, 21, gsv_decode },
+    [SENTENCE_SLOT ('T', 'G')] = { "VTG", GPS_SENTENCE_VTG, 9, 10, vtg_decode },
+    [SENTENCE_SLOT ('L', 'L')] = { "GLL", GPS_SENTENCE_GLL, 7, 8, gll_decode },
+};
+
+// Talker IDs starting with 'G', indexed by their second character
+static const gps_talker_t s_talker_table[26] = {
+    ['P' - 'A'] = GPS_TALKER_GP,
+    ['N' - 'A'] = GPS_TALKER_GN,
+    ['L' - 'A'] = GPS_TALKER_GL,
+    ['A' - 'A'] = GPS_TALKER_GA,
+    ['B' - 'A'] = GPS_TALKER_GB,
+};
+
+// Returns the table entry of a 5 character address, NULL if it is not supported
+static const sentence_entry_t * sentence_lookup (const char *address, gps_talker_t *talker)
+{
+    // characters are checked in order so a short NUL-terminated address is never read past its end
+    if (address[0] != 'G' || address[1] < 'A' || address[1] > 'Z')
+        return NULL;
+    gps_talker_t id = s_talker_table[address[1] - 'A'];
+    if (id == GPS_TALKER_UNKNOWN || address[2] == '\0' || address[3] == '\0' || address[4] == '\0')
+        return NULL;
+
+    const sentence_entry_t *entry = &s_sentence_table[SENTENCE_SLOT (address[3], address[4])];
+    if (entry->decode == NULL || memcmp (entry->name, address + 2, 3) != 0)
+        return NULL;
+
+    if (talker != NULL)
+        *talker = id;
+    return entry;
+}
+
+gps_sentence_type_t gps_nmea_sentence_identify (const char *address, gps_talker_t *talker)
+{
+    if (talker != NULL)
+        *talker = GPS_TALKER_UNKNOWN;
+    if (address == NULL)
+        return GPS_SENTENCE_UNKNOWN;
+
+    const sentence_entry_t *entry = sentence_lookup (address, talker);
+    return (entry != NULL) ? entry->type : GPS_SENTENCE_UNKNOWN;
+}
+
+// Parses a framed sentence, type receives the identified sentence type or -1 if the sentence has no address
+static gps_parse_result_t sentence_parse (gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_nmea_msg_t *msg, int *type)
+{
+    msg->type = GPS_SENTENCE_UNKNOWN;
+    msg->talker = GPS_TALKER_UNKNOWN;
+    ctx->invalid_fields = 0;
+    *type = -1;
+
+    if (sentence == NULL || length < 7 || sentence[0] != '$' || sentence[6] != ',')
+        return GPS_PARSE_ERR_FORMAT;
+
+    gps_talker_t talker;
+    const sentence_entry_t *entry = sentence_lookup (sentence + 1, &talker);
+    *type = (entry != NULL) ? (int) entry->type : GPS_SENTENCE_UNKNOWN;
+    if (entry == NULL)
+        return GPS_PARSE_ERR_UNSUPPORTED;
+
+    int field_count = gps_nmea_tokenize (ctx, sentence, length);
+    if (field_count < 0)
+        return GPS_PARSE_ERR_FORMAT;
+    if (field_count < entry->min_fields || field_count > entry->max_fields)
+        return GPS_PARSE_ERR_FIELD_COUNT;
+
+    msg->type = entry->type;
+    msg->talker = talker;
+    msg->rx_time = ctx->rx_time;
+    ctx->invalid_fields = entry->decode (ctx, msg);
+
+    // RMC carries the date: it dates itself and the sentences after it
+    if (msg->type == GPS_SENTENCE_RMC){
+        gps_rmc_t *rmc = &msg->data.rmc;
+        if (rmc->date.day != DEFAULT_DATE && rmc->time.hour != DEFAULT_GPS_TIME_HR)
+            gps_utc_date_update (ctx, rmc->date.year, rmc->date.month, rmc->date.day, &rmc->time);
+        rmc->utc_ms = gps_utc_ms (ctx, &rmc->time);
+    }
+    return (ctx->invalid_fields != 0) ? GPS_PARSE_INVALID_FIELD : GPS_PARSE_OK;
+}
+
+gps_parse_result_t gps_nmea_sentence_parse (gps_parser_ctx_t *ctx, const char *sentence, size_t length, gps_nmea_msg_t *msg)
+{
+    int type;
+    gps_parse_result_t result = sentence_parse (ctx, sentence, length, msg, &type);
+
+    // a framed sentence: its bytes are counted by whoever framed it
+    gps_stats_count (ctx, 0, type, result);
+    return result;
+}
+
+gps_parse_result_t gps_nmea_sentence_parse_view (gps_parser_ctx_t *ctx, const gps_nmea_view_t *sentence, gps_nmea_msg_t *msg)
+{
+    const gps_nmea_span_t *first = &sentence->segment[0];
+    const gps_nmea_span_t *second = &sentence->segment[1];
+
+    if (second->length == 0)
+        return gps_nmea_sentence_parse (ctx, first->data, first->length, msg);
+
+    // the only copy of the parser: a wrapped sentence is gathered into ctx to be tokenized in one piece
+    size_t length = first->length + second->length;
+    if (length > GPS_NMEA_MAX_SENTENCE_LEN){
+        msg->type = GPS_SENTENCE_UNKNOWN;
+        msg->talker = GPS_TALKER_UNKNOWN;
+        ctx->invalid_fields = 0;
+        gps_stats_count (ctx, 0, -1, GPS_PARSE_ERR_FORMAT);
+        return GPS_PARSE_ERR_FORMAT;
+    }
+    memcpy (ctx->wrapped, first->data, first->length);
+    memcpy (ctx->wrapped + first->length, second->data, second->length);
+    return gps_nmea_sentence_parse (ctx, ctx->wrapped, length, msg);
+}
+
+// Body of gps_nmea_parse_next(), type receives the type of the sentence parsed or -1
+static gps_parse_result_t parse_next (gps_parser_ctx_t *ctx, const char *buffer, size_t length,
+                                      size_t *offset, gps_nmea_msg_t *msg, int *type)
+{
+    size_t i = *offset;
+    *type = -1;
+
+    // skip to the next sentence start
+    const char *dollar = (i < length) ? memchr (buffer + i, '$', length - i) : NULL;
+    if (dollar == NULL){
+        *offset = length;
+        return GPS_PARSE_INCOMPLETE;
+    }
+    size_t start = (size_t) (dollar - buffer);
+
+    // scan the sentence body once, accumulating the checksum
+    uint8_t checksum;
+    size_t j = start + 1 + gps_nmea_scan_checksum (buffer + start + 1, length - start - 1, &checksum);
+
+    if (j == length || (buffer[j] == '*' && j + 4 >= length)){
+        // sentence is not complete yet, leave it for the next call
+        *offset = start;
+        return GPS_PARSE_INCOMPLETE;
+    }
+    if (buffer[j] != '*'){
+        // no checksum, or a new '$' interrupted this sentence: resume from the interrupting byte
+        *offset = j;
+        return GPS_PARSE_ERR_FORMAT;
+    }
+
+    // "*hh\r\n" must follow the body
+    int expected = gps_nmea_hex_byte (buffer + j + 1);
+    *offset = j + 1;
+    if (expected != checksum)
+        return GPS_PARSE_ERR_CHECKSUM;
+    if (buffer[j + 3] != '\r' || buffer[j + 4] != '\n')
+        return GPS_PARSE_ERR_FORMAT;
+    *offset = j + 5;
+
+    return sentence_parse (ctx, buffer + start, j + 3 - start, msg, type);
+}
+
+gps_parse_result_t gps_nmea_parse_next (gps_parser_ctx_t *ctx, const char *buffer, size_t length,
+                                        size_t *offset, gps_nmea_msg_t *msg)
+{
+    size_t start = *offset;
+    int type;
+    gps_parse_result_t result = parse_next (ctx, buffer, length, offset, msg, &type);
+
+    // every byte consumed is counted once, bytes left for the next call are counted by it
+    gps_stats_count (ctx, *offset - start, type, result);
+    return result;
+}
+
+size_t gps_nmea_parse_batch (gps_parser_ctx_t *ctx, const char *buffer, size_t length,
+                             gps_nmea_msg_t *msgs, size_t max_msgs, size_t *consumed)
+{
+    size_t count = 0;
+    size_t stop = length;
+    size_t i = 0;
+
+    // no room for a sentence: nothing is examined, so nothing is consumed
+    if (buffer == NULL || max_msgs == 0){
+        if (consumed != NULL)
+            *consumed = 0;
+        return 0;
+    }
+
+    while (count < max_msgs)
+    {
+        gps_parse_result_t result = gps_nmea_parse_next (ctx, buffer, length, &i, &msgs[count]);
+        if (result == GPS_PARSE_INCOMPLETE){
+            stop = i;
+            break;
+        }
+        if (result >= GPS_PARSE_OK){
+            count++;
+            if (count == max_msgs)
+                stop = i;
+        }
+    }
+
+    if (consumed != NULL)
+        *consumed = stop;
+    return count;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Sentence Decoders
+//====================================================================================================================================================================================================================================================================
+
+// Records field index of ctx in the local invalid mask when decoded reports a present field as invalid
+#define CHECK_FIELD(index, decoded)     (invalid |= gps_field_invalid (gps_nmea_field (ctx, (index)), (index), (decoded)))
+
+// $--GGA,time,lat,N,lon,E,quality,satellites,hdop,altitude,M,geoid,M,dgps age,station*hh
+static uint32_t gga_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg)
+{
+    return gps_gga_fields_decode (ctx, &msg->data.gga);
+}
+
+// $--RMC,time,status,lat,N,lon,E,speed,course,date,variation,E,mode[,nav status]*hh
+static uint32_t rmc_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg)
+{
+    gps_rmc_t *rmc = &msg->data.rmc;
+    uint32_t invalid = 0;
+    int valid;
+
+    CHECK_FIELD (1, gps_field_decode_time (gps_nmea_field (ctx, 1), &rmc->time));
+    rmc->status = char_field (gps_nmea_field (ctx, 2), DEFAULT_STATUS, &valid);
+    CHECK_FIELD (2, valid);
+    CHECK_FIELD (3, gps_field_decode_coordinate (gps_nmea_field (ctx, 3), gps_nmea_field (ctx, 4), 0, &rmc->latitude, &rmc->lat_direction));
+    CHECK_FIELD (4, rmc->lat_direction != DEFAULT_LAT_DIRECTION);
+    CHECK_FIELD (5, gps_field_decode_coordinate (gps_nmea_field (ctx, 5), gps_nmea_field (ctx, 6), 1, &rmc->longitude, &rmc->lon_direction));
+    CHECK_FIELD (6, rmc->lon_direction != DEFAULT_LON_DIRECTION);
+    CHECK_FIELD (7, gps_field_decode_float (gps_nmea_field (ctx, 7), 0, DEFAULT_SPEED, &rmc->speed_knots));
+    CHECK_FIELD (8, gps_field_decode_float (gps_nmea_field (ctx, 8), 0, DEFAULT_COURSE, &rmc->course));
+    CHECK_FIELD (9, date_decode (gps_nmea_field (ctx, 9), &rmc->date));
+    CHECK_FIELD (10, gps_field_decode_float (gps_nmea_field (ctx, 10), 0, DEFAULT_MAGNETIC_VARIATION, &rmc->magnetic_variation));
+
+    char variation_direction = gps_field_char (gps_nmea_field (ctx, 11));
+    if (variation_direction == 'E' || variation_direction == 'W'){
+        rmc->magnetic_variation_direction = variation_direction;
+        if (variation_direction == 'W' && rmc->magnetic_variation != DEFAULT_MAGNETIC_VARIATION)
+            rmc->magnetic_variation *= -1;
+    }
+    else{
+        rmc->magnetic_variation_direction = DEFAULT_STATUS;
+        CHECK_FIELD (11, 0);
+    }
+
+    rmc->mode = char_field (gps_nmea_field (ctx, 12), DEFAULT_MODE, &valid);
+    CHECK_FIELD (12, valid);
+    return invalid;
+}
+
+// $--GSA,mode,fix type,prn x12,pdop,hdop,vdop[,system id]*hh
+static uint32_t gsa_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg)
+{
+    gps_gsa_t *gsa = &msg->data.gsa;
+    uint32_t invalid = 0;
+    int valid;
+
+    gsa->selection_mode = char_field (gps_nmea_field (ctx, 1), DEFAULT_MODE, &valid);
+    CHECK_FIELD (1, valid);
+    CHECK_FIELD (2, gps_field_decode_int (gps_nmea_field (ctx, 2), DEFAULT_FIX_QUALITY, &gsa->fix_type));
+    for (int i = 0; i < GSA_MAX_SATELLITES; i++)
+        CHECK_FIELD (3 + i, gps_field_decode_int (gps_nmea_field (ctx, 3 + i), DEFAULT_SATELLITE_VALUE, &gsa->satellite_prn[i]));
+    CHECK_FIELD (15, gps_field_decode_float (gps_nmea_field (ctx, 15), 0, DEFAULT_DOP, &gsa->pdop));
+    CHECK_FIELD (16, gps_field_decode_float (gps_nmea_field (ctx, 16), 0, DEFAULT_DOP, &gsa->hdop));
+    CHECK_FIELD (17, gps_field_decode_float (gps_nmea_field (ctx, 17), 0, DEFAULT_DOP, &gsa->vdop));
+    return invalid;
+}
+
+// $--GSV,total,number,in view,{prn,elevation,azimuth,snr} x0..4[,signal id]*hh
+static uint32_t gsv_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg)
+{
+    gps_gsv_t *gsv = &msg->data.gsv;
+    uint32_t invalid = 0;
+
+    CHECK_FIELD (1, gps_field_decode_int (gps_nmea_field (ctx, 1), DEFAULT_SATELLITE_VALUE, &gsv->total_messages));
+    CHECK_FIELD (2, gps_field_decode_int (gps_nmea_field (ctx, 2), DEFAULT_SATELLITE_VALUE, &gsv->message_number));
+    CHECK_FIELD (3, gps_field_decode_int (gps_nmea_field (ctx, 3), DEFAULT_SATELLITE_VALUE, &gsv->satellites_in_view));
+
+    // 4 fields per satellite, a trailing signal ID field (NMEA 4.10) is ignored
+    int count = (ctx->field_count - 4) / 4;
+    if (count > GSV_MAX_SATELLITES)
+        count = GSV_MAX_SATELLITES;
+    gsv->satellite_count = count;
+
+    for (int i = 0; i < GSV_MAX_SATELLITES; i++){
+        gps_satellite_t *sat = &gsv->satellites[i];
+        int first = 4 + 4 * i;
+        if (i >= count){
+            sat->prn = sat->elevation = sat->azimuth = sat->snr = DEFAULT_SATELLITE_VALUE;
+            continue;
+        }
+        CHECK_FIELD (first, gps_field_decode_int (gps_nmea_field (ctx, first), DEFAULT_SATELLITE_VALUE, &sat->prn));
+        CHECK_FIELD (first + 1, gps_field_decode_int (gps_nmea_field (ctx, first + 1), DEFAULT_SATELLITE_VALUE, &sat->elevation));
+        CHECK_FIELD (first + 2, gps_field_decode_int (gps_nmea_field (ctx, first + 2), DEFAULT_SATELLITE_VALUE, &sat->azimuth));
+        CHECK_FIELD (first + 3, gps_field_decode_int (gps_nmea_field (ctx, first + 3), DEFAULT_SATELLITE_VALUE, &sat->snr));
+    }
+    return invalid;
+}
+
+// $--VTG,course,T,course,M,speed,N,speed,K[,mode]*hh
+static uint32_t vtg_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg)
+{
+    gps_vtg_t *vtg = &msg->data.vtg;
+    uint32_t invalid = 0;
+    int valid;
+
+    CHECK_FIELD (1, gps_field_decode_float (gps_nmea_field (ctx, 1), 0, DEFAULT_COURSE, &vtg->course_true));
+    CHECK_FIELD (3, gps_field_decode_float (gps_nmea_field (ctx, 3), 0, DEFAULT_COURSE, &vtg->course_magnetic));
+    CHECK_FIELD (5, gps_field_decode_float (gps_nmea_field (ctx, 5), 0, DEFAULT_SPEED, &vtg->speed_knots));
+    CHECK_FIELD (7, gps_field_decode_float (gps_nmea_field (ctx, 7), 0, DEFAULT_SPEED, &vtg->speed_kmh));
+    vtg->mode = char_field (gps_nmea_field (ctx, 9), DEFAULT_MODE, &valid);
+    CHECK_FIELD (9, valid);
+    return invalid;
+}
+
+// $--GLL,lat,N,lon,E,time,status[,mode]*hh
+static uint32_t gll_decode (const gps_parser_ctx_t *ctx, gps_nmea_msg_t *msg)
+{
+    gps_gll_t *gll = &msg->data.gll;
+    uint32_t invalid = 0;
+    int valid;
+
+    CHECK_FIELD (1, gps_field_decode_coordinate (gps_nmea_field (ctx, 1), gps_nmea_field (ctx, 2), 0, &gll->latitude, &gll->lat_direction));
+    CHECK_FIELD (2, gll->lat_direction != DEFAULT_LAT_DIRECTION);
+    CHECK_FIELD (3, gps_field_decode_coordinate (gps_nmea_field (ctx, 3), gps_nmea_field (ctx, 4), 1, &gll->longitude, &gll->lon_direction));
+    CHECK_FIELD (4, gll->lon_direction != DEFAULT_LON_DIRECTION);
+    CHECK_FIELD (5, gps_field_decode_time (gps_nmea_field (ctx, 5), &gll->time));
+    gll->status = char_field (gps_nmea_field (ctx, 6), DEFAULT_STATUS, &valid);
+    CHECK_FIELD (6, valid);
+    gll->mode = char_field (gps_nmea_field (ctx, 7), DEFAULT_MODE, &valid);
+    CHECK_FIELD (7, valid);
+    return invalid;
+}
+
+// Decodes a DDMMYY date field, all members are set to DEFAULT_DATE if it is invalid
+static int date_decode (gps_nmea_span_t field, gps_date_t *date)
+{
+    date->day = date->month = DEFAULT_DATE;
+    date->year = DEFAULT_DATE;
+
+    if (field.length != 6)
+        return 0;
+    for (int i = 0; i < 6; i++){
+        if (field.data[i] < '0' || field.data[i] > '9')
+            return 0;
+    }
+
+    int day = 10 * (field.data[0] - '0') + (field.data[1] - '0');
+    int month = 10 * (field.data[2] - '0') + (field.data[3] - '0');
+    if (day < 1 || day > 31 || month < 1 || month > 12)
+        return 0;
+
+    date->day = (uint8_t) day;
+    date->month = (uint8_t) month;
+    date->year = (uint16_t) (2000 + 10 * (field.data[4] - '0') + (field.data[5] - '0'));
+    return 1;
+}
+
+// Returns the single character of a status or mode field, valid is cleared if the field is not one character
+static char char_field (gps_nmea_span_t field, char default_value, int *valid)
+{
+    *valid = (field.length == 1);
+    return *valid ? field.data[0] : default_value;
+}
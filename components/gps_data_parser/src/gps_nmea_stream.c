@@ -0,0 +1,167 @@
+/**
+ * @file gps_nmea_stream.c
+ * @brief Incremental NMEA 0183 sentence framer with on the fly checksum evaluation.
+ *
+ * Every byte is looked at exactly once: it advances a small state machine, is appended
+ * to the sentence buffer and, between '$' and '*', is XORed into the running checksum.
+ * Runs of body bytes are copied and checksummed a block at a time by gps_nmea_scan_checksum().
+ */
+
+#include <string.h>
+
+#include "gps_nmea_stream.h"
+#include "gps_nmea_scan.h"
+#include "gps_parser_private.h"
+
+// Framer states
+enum {
+    STREAM_WAIT_START = 0,	// discarding bytes until '$'
+    STREAM_BODY,			// between '$' and '*'
+    STREAM_CHECKSUM_HI,		// expecting first checksum digit
+    STREAM_CHECKSUM_LO,		// expecting second checksum digit
+    STREAM_CR,				// expecting '\r'
+    STREAM_LF,				// expecting '\n'
+};
+
+static void stream_start_sentence (gps_nmea_stream_t *stream);
+static void stream_drop (gps_nmea_stream_t *stream, gps_parse_result_t reason);
+
+void gps_nmea_stream_init (gps_nmea_stream_t *stream, gps_nmea_sentence_cb_t callback, void *user_ctx)
+{
+    memset (stream, 0, sizeof (*stream));
+    stream->callback = callback;
+    stream->user_ctx = user_ctx;
+    stream->state = STREAM_WAIT_START;
+}
+
+void gps_nmea_stream_reset (gps_nmea_stream_t *stream)
+{
+    stream->length = 0;
+    stream->checksum = 0;
+    stream->expected_checksum = 0;
+    stream->state = STREAM_WAIT_START;
+}
+
+size_t gps_nmea_stream_feed (gps_nmea_stream_t *stream, const char *data, size_t length)
+{
+    return gps_nmea_stream_feed_at (stream, data, length, 0);
+}
+
+size_t gps_nmea_stream_feed_at (gps_nmea_stream_t *stream, const char *data, size_t length, int64_t rx_time_us)
+{
+    size_t emitted = 0;
+
+    if (data == NULL)
+        return 0;
+    stream->chunk_time_us = rx_time_us;
+    if (stream->stats_ctx != NULL)
+        gps_stats_count (stream->stats_ctx, length, -1, GPS_PARSE_OK);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (stream->state == STREAM_BODY){
+            // copy the run of body bytes up to the next delimiter in one step, the byte
+            // that ends the run (or exceeds the sentence length) goes through the state machine
+            size_t room = GPS_NMEA_MAX_SENTENCE_LEN - 2 - stream->length;
+            uint8_t checksum;
+            size_t run = gps_nmea_scan_checksum (data + i, (length - i < room) ? length - i : room, &checksum);
+            memcpy (stream->sentence + stream->length, data + i, run);
+            stream->length += run;
+            stream->checksum ^= checksum;
+            i += run;
+            if (i == length)
+                break;
+        }
+
+        char c = data[i];
+
+        // '$' always starts a new sentence, whatever was received before it
+        if (c == '$'){
+            if (stream->state != STREAM_WAIT_START)
+                stream_drop (stream, GPS_PARSE_ERR_FORMAT);
+            stream_start_sentence (stream);
+            continue;
+        }
+
+        switch (stream->state)
+        {
+            case STREAM_WAIT_START:
+                break;
+
+            case STREAM_BODY:
+                if (c == '\r' || c == '\n' || stream->length >= GPS_NMEA_MAX_SENTENCE_LEN - 2){
+                    // sentence without checksum or too long to be valid
+                    stream_drop (stream, GPS_PARSE_ERR_FORMAT);
+                }
+                else if (c == '*'){
+                    stream->sentence[stream->length++] = c;
+                    stream->state = STREAM_CHECKSUM_HI;
+                }
+                else{
+                    stream->sentence[stream->length++] = c;
+                    stream->checksum ^= (uint8_t) c;
+                }
+                break;
+
+            case STREAM_CHECKSUM_HI:
+            case STREAM_CHECKSUM_LO:
+            {
+                int value = gps_nmea_hex_digit (c);
+                if (value < 0){
+                    stream_drop (stream, GPS_PARSE_ERR_FORMAT);
+                    break;
+                }
+                stream->sentence[stream->length++] = c;
+                stream->expected_checksum = (uint8_t) ((stream->expected_checksum << 4) | value);
+                stream->state = (stream->state == STREAM_CHECKSUM_HI) ? STREAM_CHECKSUM_LO : STREAM_CR;
+                break;
+            }
+
+            case STREAM_CR:
+                if (c == '\r')
+                    stream->state = STREAM_LF;
+                else
+                    stream_drop (stream, GPS_PARSE_ERR_FORMAT);
+                break;
+
+            case STREAM_LF:
+                if (c == '\n' && stream->checksum == stream->expected_checksum){
+                    stream->sentence[stream->length] = '\0';
+                    stream->rx_time.last_us = stream->chunk_time_us;
+                    if (stream->callback != NULL)
+                        stream->callback (stream->sentence, stream->length, stream->user_ctx);
+                    emitted++;
+                    gps_nmea_stream_reset (stream);
+                }
+                else
+                    stream_drop (stream, (c == '\n') ? GPS_PARSE_ERR_CHECKSUM : GPS_PARSE_ERR_FORMAT);
+                break;
+
+            default:
+                stream_drop (stream, GPS_PARSE_ERR_FORMAT);
+                break;
+        }
+    }
+
+    return emitted;
+}
+
+// Starts assembling a new sentence at '$'
+static void stream_start_sentence (gps_nmea_stream_t *stream)
+{
+    stream->sentence[0] = '$';
+    stream->length = 1;
+    stream->checksum = 0;
+    stream->expected_checksum = 0;
+    stream->state = STREAM_BODY;
+    stream->rx_time.first_us = stream->chunk_time_us;
+    stream->rx_time.last_us = 0;
+}
+
+// Discards the sentence being assembled, counting why in the statistics context if there is one
+static void stream_drop (gps_nmea_stream_t *stream, gps_parse_result_t reason)
+{
+    if (stream->stats_ctx != NULL)
+        gps_stats_count (stream->stats_ctx, 0, -1, reason);
+    gps_nmea_stream_reset (stream);
+}
@@ -0,0 +1,214 @@
+/**
+ * @file gps_parser_private.h
+ * @brief Field decoders shared by the sentence decoders of the component, not part of the public API.
+ */
+#ifndef GPS_PARSER_PRIVATE_H
+#define GPS_PARSER_PRIVATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gps_data_parser.h"
+#include "gps_nmea_sentence.h"
+
+// Diagnostic logging, compiled out unless GPS_PARSER_LOG_ENABLED is set
+#if GPS_PARSER_LOG_ENABLED
+#ifdef ESP_PLATFORM
+#include <esp_log.h>
+#define GPS_PARSER_LOGE(...)    ESP_LOGE ("gps_parser", __VA_ARGS__)
+#define GPS_PARSER_LOGD(...)    ESP_LOGD ("gps_parser", __VA_ARGS__)
+#else
+#include <stdio.h>
+#define GPS_PARSER_LOGE(...)    (fprintf (stderr, "E gps_parser: " __VA_ARGS__), fputc ('\n', stderr))
+#define GPS_PARSER_LOGD(...)    (fprintf (stderr, "D gps_parser: " __VA_ARGS__), fputc ('\n', stderr))
+#endif
+#else
+#define GPS_PARSER_LOGE(...)    ((void) 0)
+#define GPS_PARSER_LOGD(...)    ((void) 0)
+#endif
+
+/**
+ * @brief Splits a sentence into fields at ',' and '*', recording their offsets and lengths in ctx.
+ *
+ * The sentence stays in the caller's buffer and is only read, it must stay unchanged while its
+ * fields are decoded.
+ *
+ * @return Number of fields found (fields past GPS_NMEA_MAX_FIELDS are counted but not stored),
+ *         -1 if the sentence is longer than GPS_NMEA_MAX_SENTENCE_LEN.
+ */
+int gps_nmea_tokenize(gps_parser_ctx_t *ctx, const char *sentence, size_t length);
+
+/**
+ * @brief Returns field index of the tokenized sentence, an empty span if the sentence has fewer fields.
+ */
+gps_nmea_span_t gps_nmea_field(const gps_parser_ctx_t *ctx, int index);
+
+/**
+ * @brief Returns the bit of field index if the field is present but its decoder reported it invalid.
+ *
+ * Empty fields are not errors, receivers leave fields empty when they have no value for them.
+ */
+static inline uint32_t gps_field_invalid(gps_nmea_span_t field, int index, int valid)
+{
+    return (!valid && field.length != 0) ? (1u << index) : 0;
+}
+
+/**
+ * @brief First character of a field, '\0' if the field is empty.
+ */
+static inline char gps_field_char(gps_nmea_span_t field)
+{
+    return (field.length != 0) ? field.data[0] : '\0';
+}
+
+/**
+ * @brief Little-endian 32-bit accessors of the binary fix formats (gps_fix_record.h, gps_fix_history.h).
+ */
+static inline void gps_put_le32(uint8_t *bytes, uint32_t value)
+{
+    bytes[0] = (uint8_t) value;
+    bytes[1] = (uint8_t) (value >> 8);
+    bytes[2] = (uint8_t) (value >> 16);
+    bytes[3] = (uint8_t) (value >> 24);
+}
+
+static inline uint32_t gps_get_le32(const uint8_t *bytes)
+{
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+/**
+ * @brief Position of a fix in 1e-7 degrees, from the fixed-point members if decoded, the float members otherwise.
+ *
+ * @return 1 if the fix has a position, otherwise 0.
+ */
+static inline int gps_fix_position_e7(const gps_data_parse_t *fix, int32_t *latitude_e7, int32_t *longitude_e7)
+{
+    if (fix->latitude_e7 != DEFAULT_LATITUDE_E7 && fix->longitude_e7 != DEFAULT_LONGITUDE_E7){
+        *latitude_e7 = fix->latitude_e7;
+        *longitude_e7 = fix->longitude_e7;
+        return 1;
+    }
+    if (fix->latitude == DEFAULT_LATITUDE || fix->longitude == DEFAULT_LONGITUDE)
+        return 0;
+    *latitude_e7 = (int32_t) ((double) fix->latitude * 1e7 + (fix->latitude >= 0 ? 0.5 : -0.5));
+    *longitude_e7 = (int32_t) ((double) fix->longitude * 1e7 + (fix->longitude >= 0 ? 0.5 : -0.5));
+    return 1;
+}
+
+/**
+ * @brief Adds to a counter of ctx. The parse calls are the only writers: a relaxed load and
+ * store compile to a plain increment, without a lock or an atomic read-modify-write.
+ */
+static inline void gps_stat_add(gps_parser_ctx_t *ctx, gps_stat_t stat, uint32_t value)
+{
+    atomic_store_explicit(&ctx->stats[stat], atomic_load_explicit(&ctx->stats[stat], memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+/**
+ * @brief Counts one examined sentence: the raw bytes it consumed, its type and its rejection class.
+ *
+ * @param type The gps_sentence_type_t of a sentence with a valid checksum (GPS_SENTENCE_UNKNOWN
+ *             if unsupported), -1 if the sentence was rejected before its type was known.
+ */
+void gps_stats_count(gps_parser_ctx_t *ctx, size_t bytes, int type, gps_parse_result_t result);
+
+#define GPS_MS_PER_DAY  86400000LL
+
+/**
+ * @brief UTC time of day in milliseconds of a decoded time, TIME_ZONE taken back out of the hour.
+ */
+static inline uint32_t gps_time_utc_ms(const gps_time_t *time)
+{
+    uint32_t hour = (uint32_t) (time->hour + 24 - TIME_ZONE % 24) % 24;
+    return ((hour * 60 + time->minute) * 60 + time->second) * 1000 + time->millisecond;
+}
+
+/**
+ * @brief Dates the sentences decoded with ctx from now on, called for every RMC sentence with a date and a time.
+ */
+void gps_utc_date_update(gps_parser_ctx_t *ctx, int year, int month, int day, const gps_time_t *time);
+
+/**
+ * @brief UTC time in milliseconds since 1970-01-01 of a time decoded with ctx.
+ *
+ * The date is the one of the last gps_utc_date_update(), moved by a day when the time of day
+ * shows that midnight passed in between, so the cost is one addition.
+ *
+ * @return The time, DEFAULT_UTC_MS if time or the date is unknown.
+ */
+int64_t gps_utc_ms(const gps_parser_ctx_t *ctx, const gps_time_t *time);
+
+/**
+ * @brief Sets every member of a GGA result to its DEFAULT_* value.
+ */
+void gps_gga_set_defaults(gps_data_parse_t *gps_data);
+
+/**
+ * @brief Decodes one GPS_GGA_FIELD_* group of the 15 fields of a GGA sentence.
+ *
+ * Only the members of that group are written, in the modes selected by decode_flags.
+ *
+ * @param fields The fields, indexed like the GGA sentence (empty spans for empty fields).
+ *
+ * @return Mask of the fields that were present but invalid, see gps_field_invalid().
+ */
+uint32_t gps_gga_field_decode(const gps_nmea_span_t *fields, uint32_t field, uint32_t decode_flags, gps_data_parse_t *gps_data);
+
+/**
+ * @brief Decodes the 15 fields of a GGA sentence tokenized into ctx.
+ *
+ * @return Mask of the fields that were present but invalid, see gps_field_invalid().
+ */
+uint32_t gps_gga_fields_decode(const gps_parser_ctx_t *ctx, gps_data_parse_t *gps_data);
+
+/**
+ * @brief Decodes a HHMMSS.SSS field, time is set to the default values if it is invalid.
+ *
+ * @return 1 if the field is valid, otherwise 0.
+ */
+int gps_field_decode_time(gps_nmea_span_t field, gps_time_t *time);
+
+/**
+ * @brief Decodes a DDMM.MMMM (latitude) or DDDMM.MMMM (longitude) field and its direction field.
+ *
+ * The coordinate is converted to degrees, negative for south and west. An invalid value is set to
+ * DEFAULT_LATITUDE / DEFAULT_LONGITUDE and an invalid direction to DEFAULT_LAT_DIRECTION / DEFAULT_LON_DIRECTION.
+ *
+ * @return 1 if the value is valid, otherwise 0.
+ */
+int gps_field_decode_coordinate(gps_nmea_span_t value, gps_nmea_span_t direction, int is_longitude, float *coordinate, char *hemisphere);
+
+/**
+ * @brief Same as gps_field_decode_coordinate() with an exact integer result in 1e-7 degrees.
+ *
+ * An invalid value is set to DEFAULT_LATITUDE_E7 / DEFAULT_LONGITUDE_E7. No float arithmetic is used.
+ *
+ * @return 1 if the value is valid, otherwise 0.
+ */
+int gps_field_decode_coordinate_e7(gps_nmea_span_t value, gps_nmea_span_t direction, int is_longitude, int32_t *coordinate, char *hemisphere);
+
+/**
+ * @brief Decodes a decimal field into an integer in units of 10^-scale_digits, rounded to the nearest unit.
+ *
+ * value is set to default_value if the field is empty, invalid or out of the int32_t range.
+ *
+ * @return 1 if the field is valid, otherwise 0.
+ */
+int gps_field_decode_fixed_point(gps_nmea_span_t field, int scale_digits, int allow_negative, int32_t default_value, int32_t *value);
+
+/**
+ * @brief Decodes a real number field, value is set to default_value if it is empty or invalid.
+ *
+ * @return 1 if the field is valid, otherwise 0.
+ */
+int gps_field_decode_float(gps_nmea_span_t field, int allow_negative, float default_value, float *value);
+
+/**
+ * @brief Decodes an unsigned integer field, value is set to default_value if it is empty or invalid.
+ *
+ * @return 1 if the field is valid, otherwise 0.
+ */
+int gps_field_decode_int(gps_nmea_span_t field, int default_value, int *value);
+
+#endif  // GPS_PARSER_PRIVATE_H
@@ -0,0 +1,267 @@
+/**
+ * @file gps_receiver.c
+ * @brief Receiver instances over an RX ring, and workers parsing a fixed set of receivers each.
+ *
+ * A receiver is only ever parsed by one task: the caller, or the worker it was bound to. The
+ * ring is single-producer/single-consumer, so the UART task and that worker need no lock
+ * between them. A worker sleeps until one of its receivers is written; on the host the wake-up
+ * flag is guarded by a mutex of that worker only, on the ESP32 it is the task notification.
+ */
+
+#include <string.h>
+
+#include "gps_receiver.h"
+#include "gps_parser_private.h"
+
+static void worker_wake (gps_receiver_worker_t *worker);
+static int worker_wait (gps_receiver_worker_t *worker);
+static void worker_run (gps_receiver_worker_t *worker);
+static void workers_stop (gps_receiver_pool_t *pool, size_t count);
+static void receivers_bind (gps_receiver_pool_t *pool);
+static void receivers_detach (gps_receiver_pool_t *pool);
+
+//====================================================================================================================================================================================================================================================================
+//                         Receivers
+//====================================================================================================================================================================================================================================================================
+
+int gps_receiver_init (gps_receiver_t *rx, char *storage, size_t capacity, uint32_t required,
+                       gps_fix_cb_t callback, void *user_ctx)
+{
+    memset (rx, 0, sizeof (*rx));
+    if (gps_nmea_ring_init (&rx->ring, storage, capacity) != 0)
+        return -1;
+    gps_parser_init (&rx->ctx);
+    gps_nmea_epoch_init (&rx->epoch, required, callback, user_ctx);
+    return 0;
+}
+
+size_t gps_receiver_write (gps_receiver_t *rx, const char *data, size_t length)
+{
+    size_t written = gps_nmea_ring_write (&rx->ring, data, length);
+
+    // a receiver only has a worker to wake once its pool is started
+    gps_receiver_worker_t *worker = atomic_load (&rx->worker);
+    if (written > 0 && worker != NULL)
+        worker_wake (worker);
+    return written;
+}
+
+size_t gps_receiver_poll (gps_receiver_t *rx)
+{
+    gps_nmea_view_t sentence;
+    gps_parse_result_t result;
+    size_t advance;
+    size_t parsed = 0;
+
+    while ((result = gps_nmea_ring_next_sentence (&rx->ring, &sentence, &advance)) != GPS_PARSE_INCOMPLETE || advance > 0){
+        if (result == GPS_PARSE_OK){
+            if (gps_nmea_sentence_parse_view (&rx->ctx, &sentence, &rx->msg) >= GPS_PARSE_OK)
+                gps_nmea_epoch_add (&rx->epoch, &rx->msg);
+            parsed++;
+        }
+        // the ring frames the bytes: count them, and the sentences it rejected
+        gps_stats_count (&rx->ctx, advance, -1, (result == GPS_PARSE_INCOMPLETE) ? GPS_PARSE_OK : result);
+        gps_nmea_ring_consume (&rx->ring, advance);
+    }
+    return parsed;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Worker pool
+//====================================================================================================================================================================================================================================================================
+
+int gps_receiver_pool_init (gps_receiver_pool_t *pool, size_t worker_count)
+{
+    memset (pool, 0, sizeof (*pool));
+    if (worker_count == 0 || worker_count > GPS_RECEIVER_MAX_WORKERS)
+        return -1;
+    pool->worker_count = worker_count;
+    for (size_t i = 0; i < worker_count; i++)
+        pool->worker[i].pool = pool;
+    return 0;
+}
+
+int gps_receiver_pool_add (gps_receiver_pool_t *pool, gps_receiver_t *rx)
+{
+    if (pool->started || rx->pool != NULL)
+        return -1;
+
+    size_t index = pool->receiver_count++ % pool->worker_count;
+    gps_receiver_worker_t *worker = &pool->worker[index];
+    gps_receiver_t **last = &worker->receivers;
+    while (*last != NULL)
+        last = &(*last)->next;
+    *last = rx;
+    rx->next = NULL;
+    rx->pool = pool;
+    return (int) index;
+}
+
+// Lets the receivers wake their workers, once every worker runs, and has the bytes already written parsed
+static void receivers_bind (gps_receiver_pool_t *pool)
+{
+    for (size_t i = 0; i < pool->worker_count; i++){
+        for (gps_receiver_t *rx = pool->worker[i].receivers; rx != NULL; rx = rx->next)
+            atomic_store (&rx->worker, &pool->worker[i]);
+        worker_wake (&pool->worker[i]);
+    }
+}
+
+// The receivers go back to the caller
+static void receivers_detach (gps_receiver_pool_t *pool)
+{
+    for (size_t i = 0; i < pool->worker_count; i++){
+        for (gps_receiver_t *rx = pool->worker[i].receivers; rx != NULL; rx = rx->next){
+            atomic_store (&rx->worker, NULL);
+            rx->pool = NULL;
+        }
+        pool->worker[i].receivers = NULL;
+    }
+    pool->receiver_count = 0;
+}
+
+#ifdef ESP_PLATFORM
+
+static void worker_task (void *arg)
+{
+    gps_receiver_worker_t *worker = (gps_receiver_worker_t *) arg;
+    worker_run (worker);
+    atomic_store (&worker->exited, 1);
+    vTaskDelete (NULL);
+}
+
+int gps_receiver_pool_start (gps_receiver_pool_t *pool)
+{
+    if (pool->started)
+        return -1;
+    atomic_store (&pool->running, 1);
+
+    for (size_t i = 0; i < pool->worker_count; i++){
+        gps_receiver_worker_t *worker = &pool->worker[i];
+        atomic_store (&worker->exited, 0);
+        if (xTaskCreatePinnedToCore (worker_task, "gps_worker", GPS_RECEIVER_TASK_STACK, worker, GPS_RECEIVER_TASK_PRIORITY,
+                                     &worker->task, (BaseType_t) (i % portNUM_PROCESSORS)) != pdPASS){
+            workers_stop (pool, i);
+            receivers_detach (pool);
+            return -1;
+        }
+    }
+    receivers_bind (pool);
+    pool->started = 1;
+    return 0;
+}
+
+// Stops the first count workers and waits until they have exited
+static void workers_stop (gps_receiver_pool_t *pool, size_t count)
+{
+    atomic_store (&pool->running, 0);
+    for (size_t i = 0; i < count; i++){
+        worker_wake (&pool->worker[i]);
+        while (!atomic_load (&pool->worker[i].exited))
+            vTaskDelay (1);
+    }
+}
+
+static void worker_wake (gps_receiver_worker_t *worker)
+{
+    xTaskNotifyGive (worker->task);
+}
+
+static int worker_wait (gps_receiver_worker_t *worker)
+{
+    ulTaskNotifyTake (pdTRUE, portMAX_DELAY);
+    return atomic_load (&worker->pool->running);
+}
+
+#else
+
+static void * worker_thread (void *arg)
+{
+    worker_run ((gps_receiver_worker_t *) arg);
+    return NULL;
+}
+
+int gps_receiver_pool_start (gps_receiver_pool_t *pool)
+{
+    if (pool->started)
+        return -1;
+    atomic_store (&pool->running, 1);
+
+    for (size_t i = 0; i < pool->worker_count; i++){
+        gps_receiver_worker_t *worker = &pool->worker[i];
+        worker->pending = 0;
+        pthread_mutex_init (&worker->lock, NULL);
+        pthread_cond_init (&worker->wake, NULL);
+        if (pthread_create (&worker->thread, NULL, worker_thread, worker) != 0){
+            pthread_cond_destroy (&worker->wake);
+            pthread_mutex_destroy (&worker->lock);
+            workers_stop (pool, i);
+            receivers_detach (pool);
+            return -1;
+        }
+    }
+    receivers_bind (pool);
+    pool->started = 1;
+    return 0;
+}
+
+// Stops the first count workers and waits until they have exited
+static void workers_stop (gps_receiver_pool_t *pool, size_t count)
+{
+    atomic_store (&pool->running, 0);
+    for (size_t i = 0; i < count; i++){
+        gps_receiver_worker_t *worker = &pool->worker[i];
+        worker_wake (worker);
+        pthread_join (worker->thread, NULL);
+        pthread_cond_destroy (&worker->wake);
+        pthread_mutex_destroy (&worker->lock);
+    }
+}
+
+static void worker_wake (gps_receiver_worker_t *worker)
+{
+    pthread_mutex_lock (&worker->lock);
+    worker->pending = 1;
+    pthread_cond_signal (&worker->wake);
+    pthread_mutex_unlock (&worker->lock);
+}
+
+static int worker_wait (gps_receiver_worker_t *worker)
+{
+    pthread_mutex_lock (&worker->lock);
+    while (!worker->pending && atomic_load (&worker->pool->running))
+        pthread_cond_wait (&worker->wake, &worker->lock);
+    worker->pending = 0;
+    pthread_mutex_unlock (&worker->lock);
+    return atomic_load (&worker->pool->running);
+}
+
+#endif
+
+// Parses the receivers of a worker whenever one of them was written, until the pool stops
+static void worker_run (gps_receiver_worker_t *worker)
+{
+    for (;;)
+    {
+        // bytes written before the stop are still parsed
+        int running = worker_wait (worker);
+        for (gps_receiver_t *rx = worker->receivers; rx != NULL; rx = rx->next)
+            gps_receiver_poll (rx);
+        if (!running)
+            break;
+    }
+}
+
+void gps_receiver_pool_stop (gps_receiver_pool_t *pool)
+{
+    if (!pool->started)
+        return;
+    // no write wakes a worker once it has stopped
+    for (size_t i = 0; i < pool->worker_count; i++){
+        for (gps_receiver_t *rx = pool->worker[i].receivers; rx != NULL; rx = rx->next)
+            atomic_store (&rx->worker, NULL);
+    }
+    workers_stop (pool, pool->worker_count);
+    receivers_detach (pool);
+    pool->started = 0;
+}
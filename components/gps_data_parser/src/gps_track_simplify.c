@@ -0,0 +1,148 @@
+/**
+ * @file gps_track_simplify.c
+ * @brief Cone-intersection track simplification.
+ *
+ * Every fix farther than the tolerance from the anchor allows the directions within
+ * asin(tolerance / distance) of its own direction. The cone is the intersection of these
+ * intervals and is kept as its two edge vectors, so testing and narrowing it needs a few
+ * multiplications and one square root per fix, and no angle is ever computed. The cone only
+ * bounds directions: the farthest distance reached in the segment bounds the fixes that come
+ * back towards the anchor.
+ */
+
+#include <math.h>
+
+#include "gps_track_simplify.h"
+#include "gps_parser_private.h"
+
+#define METRES_PER_E7       0.0111194926f   // one 1e-7 degree of latitude on the mean earth radius
+#define RADIANS_PER_E7      1.74532925e-9f
+#define E7_PER_TURN         3600000000LL
+
+static float cross (const float *a, const float *b)
+{
+    return a[0] * b[1] - a[1] * b[0];
+}
+
+// Passes a fix on and makes it the anchor of the next segment
+static void emit (gps_track_simplify_t *simplify, const gps_data_parse_t *fix, int32_t latitude_e7, int32_t longitude_e7)
+{
+    simplify->has_anchor = 1;
+    simplify->anchor_latitude_e7 = latitude_e7;
+    simplify->anchor_longitude_e7 = longitude_e7;
+    simplify->longitude_scale = METRES_PER_E7 * cosf ((float) latitude_e7 * RADIANS_PER_E7);
+    simplify->has_cone = 0;
+    simplify->max_distance = 0;
+    simplify->has_pending = 0;
+    simplify->points_out++;
+    if (simplify->callback != NULL)
+        simplify->callback (fix, simplify->user_ctx);
+}
+
+// Narrows the cone to a position, returns 0 without changing it if the position is outside the cone
+// or falls back more than the tolerance behind the farthest position of the segment
+static int cone_accept (gps_track_simplify_t *simplify, int32_t latitude_e7, int32_t longitude_e7)
+{
+    int64_t longitude_delta = (int64_t) longitude_e7 - simplify->anchor_longitude_e7;
+    if (longitude_delta > E7_PER_TURN / 2)
+        longitude_delta -= E7_PER_TURN;
+    else if (longitude_delta < -E7_PER_TURN / 2)
+        longitude_delta += E7_PER_TURN;
+
+    float position[2] = {
+        (float) longitude_delta * simplify->longitude_scale,
+        (float) ((int64_t) latitude_e7 - simplify->anchor_latitude_e7) * METRES_PER_E7,
+    };
+    float distance_squared = position[0] * position[0] + position[1] * position[1];
+    float distance = sqrtf (distance_squared);
+    float tolerance = simplify->tolerance;
+
+    // the segment ends at its last fix, a fix coming back towards the anchor would be off it
+    if (distance < simplify->max_distance - tolerance)
+        return 0;
+    if (distance <= tolerance){
+        if (distance > simplify->max_distance)
+            simplify->max_distance = distance;
+        return 1;
+    }
+
+    // edges of the directions passing within the tolerance of this position
+    float x = position[0] / distance;
+    float y = position[1] / distance;
+    float s = tolerance / distance;
+    float c = sqrtf (1 - s * s);
+    float cw[2] = { x * c + y * s, y * c - x * s };
+    float ccw[2] = { x * c - y * s, y * c + x * s };
+
+    if (!simplify->has_cone){
+        simplify->has_cone = 1;
+    }
+    else{
+        if (cross (simplify->cone_cw, position) < 0 || cross (position, simplify->cone_ccw) < 0)
+            return 0;
+        // keep the narrower edge on each side
+        if (cross (simplify->cone_cw, cw) < 0){
+            cw[0] = simplify->cone_cw[0];
+            cw[1] = simplify->cone_cw[1];
+        }
+        if (cross (ccw, simplify->cone_ccw) < 0){
+            ccw[0] = simplify->cone_ccw[0];
+            ccw[1] = simplify->cone_ccw[1];
+        }
+    }
+    simplify->cone_cw[0] = cw[0];
+    simplify->cone_cw[1] = cw[1];
+    simplify->cone_ccw[0] = ccw[0];
+    simplify->cone_ccw[1] = ccw[1];
+    if (distance > simplify->max_distance)
+        simplify->max_distance = distance;
+    return 1;
+}
+
+void gps_track_simplify_init (gps_track_simplify_t *simplify, float tolerance, gps_track_point_cb_t callback, void *user_ctx)
+{
+    simplify->tolerance = tolerance;
+    simplify->callback = callback;
+    simplify->user_ctx = user_ctx;
+    simplify->has_anchor = 0;
+    simplify->has_cone = 0;
+    simplify->max_distance = 0;
+    simplify->has_pending = 0;
+    simplify->fixes_in = 0;
+    simplify->points_out = 0;
+}
+
+int gps_track_simplify_add (gps_track_simplify_t *simplify, const gps_data_parse_t *fix)
+{
+    int32_t latitude_e7, longitude_e7;
+    int emitted = 0;
+
+    if (!gps_fix_position_e7 (fix, &latitude_e7, &longitude_e7))
+        return 0;
+    simplify->fixes_in++;
+
+    if (!simplify->has_anchor){
+        emit (simplify, fix, latitude_e7, longitude_e7);
+        return 1;
+    }
+
+    // outside the cone: the segment ends at the previous fix, which anchors the next one
+    if (!cone_accept (simplify, latitude_e7, longitude_e7)){
+        emit (simplify, &simplify->pending, simplify->pending_latitude_e7, simplify->pending_longitude_e7);
+        emitted = 1;
+        cone_accept (simplify, latitude_e7, longitude_e7);
+    }
+    simplify->pending = *fix;
+    simplify->pending_latitude_e7 = latitude_e7;
+    simplify->pending_longitude_e7 = longitude_e7;
+    simplify->has_pending = 1;
+    return emitted;
+}
+
+int gps_track_simplify_flush (gps_track_simplify_t *simplify)
+{
+    if (!simplify->has_pending)
+        return 0;
+    emit (simplify, &simplify->pending, simplify->pending_latitude_e7, simplify->pending_longitude_e7);
+    return 1;
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/_intsup.h>
 #include "unity.h"
@@ -468,7 +469,265 @@ TEST_CASE("Sentence with Excessive Length", "[gps_parser]")
     free(result);// deallocate memory
 }
 
+/**
+ * @brief Test case 12: Caller-owned context and output
+ *
+ * This test case verifies that gps_data_parse() fills caller-provided storage and that two
+ * contexts used alternately do not disturb each other.
+ */
+TEST_CASE("Parse into caller-owned context and output", "[gps_parser]")
+{
+    gps_parser_ctx_t ctx_a, ctx_b;
+    gps_data_parse_t data_a, data_b;
+    gps_parser_init(&ctx_a);
+    gps_parser_init(&ctx_b);
+
+    TEST_ASSERT_EQUAL(0, gps_data_parse(&ctx_a, "$GPGGA,123456.257,2358.5623,N,12345.6719,E,1,08,1.0,120.83,M,0.0,M,18,934*6B\r\n", &data_a));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_CHECKSUM, gps_data_parse(&ctx_b, "$GPGGA,123456.00,1234.56,N,12345.67,E,1,08,1.0,10.0,M,0.0,M,18,ABC*3E\r\n", &data_b));
+    TEST_ASSERT_EQUAL(0, gps_data_parse(&ctx_b, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &data_b));
+
+    TEST_ASSERT_EQUAL_FLOAT(23.97603, data_a.latitude); // first result untouched by the second context
+    TEST_ASSERT_EQUAL_INT(934, data_a.dgps_station_id);
+    TEST_ASSERT_EQUAL_FLOAT(-6.505618, data_b.longitude); // west longitude is negative
+    TEST_ASSERT_EQUAL_INT(8, data_b.num_satellites);
+    TEST_ASSERT_EQUAL_INT(DEFAULT_DGPS_STATION_ID, data_b.dgps_station_id);
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse(&ctx_a, NULL, &data_a));
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, data_a.latitude);
+}
 
+TEST_CASE("Parse result codes", "[gps_parser]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &data));
+    TEST_ASSERT_EQUAL_HEX32(0, ctx.invalid_fields);     // empty fields are not errors
+
+    // corrupted latitude and longitude hemisphere, the other fields are still decoded
+    TEST_ASSERT_EQUAL(GPS_PARSE_INVALID_FIELD, gps_data_parse(&ctx, "$GPGGA,123456.00,12x4.56,N,12345.67,Q,1,08,1.0,10.0,M,0.0,M,,*3B\r\n", &data));
+    TEST_ASSERT_EQUAL_HEX32((1u << 2) | (1u << 5), ctx.invalid_fields);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, data.latitude);
+    TEST_ASSERT_EQUAL('-', data.lon_direction);
+    TEST_ASSERT_EQUAL_FLOAT(10.0, data.altitude);
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse(&ctx, "", &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse(&ctx, "$GPRMC,1*00\r\n", &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_CHECKSUM, gps_data_parse(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76\r\n", &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FIELD_COUNT, gps_data_parse(&ctx, "$GPGGA,123456.00,1234.56,N,12345.67,E,1,08,1.0,10.0,M,0.0,M,18*41\r\n", &data));
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_ALTITUDE, data.altitude);
+}
+
+/**
+ * @brief A GGA cut short by a stray '$', a corrupted GGA or a burst of junk does not hide the intact GGA after it,
+ * and a stream made only of GGA fragments is rejected in a single pass.
+ */
+TEST_CASE("Resync: intact GGA after corrupted ones", "[gps_parser]")
+{
+    static const char good[] = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+    static char junk[32768];
+    gps_parser_ctx_t ctx;
+    gps_parser_stats_t stats;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+
+    // power glitch inside a GGA: the '$' of the next sentence interrupts it
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,092750.000,5321.68$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &data));
+    TEST_ASSERT_EQUAL(51, data.time.second);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 53.361337, data.latitude);
+
+    // wrong checksum, missing CRLF and a stray '$' at the position of a field
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76\r\n"
+                                                        "$GNGGA,1,2*00$GPGGA,09$,5321.6802\r\n"
+                                                        "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &data));
+    TEST_ASSERT_EQUAL(51, data.time.second);
+
+    // stream5 and stream11 of main.c
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, ",09275,,,,,,,,,,ewrwer,sdfvzx,453453635,41,,,A*43\r\n$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n  $GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n", &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, ",,,$$%%&^*(*(@,,,,4531313372,W,0.02,31.66,280511,,,A*43\r\n$GPGGA,065551.680,5321.6802,S,00630.3371,E,1,85,,,,554.3,M,,*30\r\n$GPGSA,A,3,10,07,05##(())(,1.38*0A\r%^&*()_+n", &data));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, -53.361337, data.latitude);
+
+    // a burst of GGA fragments and junk before the fix
+    size_t length = 0;
+    while (length + 16 < sizeof(junk) - sizeof(good)){
+        memcpy(junk + length, (length % 3 == 0) ? "$GPGGA,$$*\r\n" : "$GNGGA,1*Z\r$", 12);
+        length += 12;
+    }
+    memcpy(junk + length, good, sizeof(good));
+    gps_parser_stats_reset(&ctx);
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, junk, &data));
+    gps_parser_stats_snapshot(&ctx, &stats);
+    TEST_ASSERT_EQUAL(strlen(junk), stats.value[GPS_STAT_BYTES]);
+    junk[length] = '\0';
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse(&ctx, junk, &data));
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, data.latitude);
+}
+
+/**
+ * @brief A buffer without NUL terminator, sized exactly to its content, is parsed in place and left unchanged,
+ * at any size and with the GGA sentence at its very end.
+ */
+TEST_CASE("Parse buffer: unterminated input decoded in place", "[gps_parser]")
+{
+    static const char gga[] = "$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,-61.7,M,55.3,M,,*46\r\n";
+    size_t gga_length = sizeof(gga) - 1;
+    size_t length = 5000 + gga_length;
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+    ctx.decode_flags = GPS_DECODE_FLOAT | GPS_DECODE_FIXED_POINT;
+
+    // exact size allocations: a read past the end is caught by the address sanitizer
+    char *buffer = malloc(length);
+    char *copy = malloc(length);
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_NOT_NULL(copy);
+    for (size_t i = 0; i < 5000; i++)
+        buffer[i] = (i % 97 == 0) ? '$' : (char) ('0' + i % 10);
+    memcpy(buffer + 5000, gga, gga_length);
+    memcpy(copy, buffer, length);
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse_buffer(&ctx, buffer, length, &data));
+    TEST_ASSERT_EQUAL_MEMORY(copy, buffer, length);
+    TEST_ASSERT_EQUAL(9, data.time.hour - TIME_ZONE);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 53.361337, data.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, -6.505618, data.longitude);
+    TEST_ASSERT_EQUAL_FLOAT(-61.7, data.altitude);
+    TEST_ASSERT_EQUAL(-61700, data.altitude_mm);
+    TEST_ASSERT_EQUAL_FLOAT(55.3, data.geoid_height);
+    TEST_ASSERT_EQUAL('M', data.geoid_height_units);
+
+    // the sentence without its CRLF, then a length cutting the buffer before the sentence
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse_buffer(&ctx, buffer + 5000, gga_length - 2, &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse_buffer(&ctx, buffer, 5000, &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse_buffer(&ctx, NULL, length, &data));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_data_parse_buffer(&ctx, buffer, 0, &data));
+    TEST_ASSERT_EQUAL_MEMORY(copy, buffer, length);
+
+    free(copy);
+    free(buffer);
+}
+
+/**
+ * @brief Every field type is validated and converted in the same pass: a field is either converted or rejected
+ * and set to its default, whatever the position of the bad character.
+ */
+TEST_CASE("Field decoders: validation and conversion in one pass", "[gps_parser]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+    ctx.decode_flags = GPS_DECODE_FLOAT | GPS_DECODE_FIXED_POINT;
+
+    static const char valid[] = "$GPGGA,235959.25,0000.0001,S,18000.0000,E,8,2147483647,0.5,-0.05,M,55.,M,12345678901234567890.5,1023*00";
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_gga_sentence_parse(&ctx, valid, strlen(valid), &data));
+    TEST_ASSERT_EQUAL((23 + TIME_ZONE) % 24, data.time.hour);
+    TEST_ASSERT_EQUAL(59, data.time.second);
+    TEST_ASSERT_EQUAL(250, data.time.millisecond);
+    TEST_ASSERT_EQUAL(-17, data.latitude_e7);
+    TEST_ASSERT_EQUAL(1800000000, data.longitude_e7);
+    TEST_ASSERT_EQUAL_FLOAT(180.0, data.longitude);
+    TEST_ASSERT_EQUAL(2147483647, data.num_satellites);
+    TEST_ASSERT_EQUAL_FLOAT(-0.05, data.altitude);
+    TEST_ASSERT_EQUAL(-50, data.altitude_mm);
+    TEST_ASSERT_EQUAL(55000, data.geoid_height_mm);
+    TEST_ASSERT_EQUAL_FLOAT(1.2345679e19, data.dgps_age);
+    TEST_ASSERT_EQUAL(1023, data.dgps_station_id);
+
+    // out of range time and degrees, too many digits before the point, a second point, an int overflow and a misplaced sign
+    static const char invalid[] = "$GPGGA,236000.00,9100.0000,N,012345.678,E,1,2147483648,1.0.3,-,M,5-5.3,M,1a,1.2.*00";
+    TEST_ASSERT_EQUAL(GPS_PARSE_INVALID_FIELD, gps_gga_sentence_parse(&ctx, invalid, strlen(invalid), &data));
+    TEST_ASSERT_EQUAL(DEFAULT_GPS_TIME_HR, data.time.hour);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, data.latitude);
+    TEST_ASSERT_EQUAL(DEFAULT_LONGITUDE_E7, data.longitude_e7);
+    TEST_ASSERT_EQUAL(DEFAULT_NUM_SATELLITES, data.num_satellites);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_HDOP, data.hdop);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_GEOID_HEIGHT, data.geoid_height);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_DGPS_AGE, data.dgps_age);
+    TEST_ASSERT_EQUAL(DEFAULT_DGPS_STATION_ID, data.dgps_station_id);
+    TEST_ASSERT_EQUAL((1u << 1) | (1u << 2) | (1u << 4) | (1u << 7) | (1u << 8) | (1u << 9) | (1u << 11) | (1u << 13) | (1u << 14), ctx.invalid_fields);
+}
+
+TEST_CASE("Fixed-point decode mode", "[gps_parser]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+    ctx.decode_flags = GPS_DECODE_FIXED_POINT;
+
+    TEST_ASSERT_EQUAL(0, gps_data_parse(&ctx, "$GPGGA,123456.257,2358.5623,N,12345.6719,E,1,08,1.0,120.83,M,0.0,M,18,934*6B\r\n", &data));
+    TEST_ASSERT_EQUAL_INT32(239760383, data.latitude_e7);      // 23 + 58.5623 / 60 degrees
+    TEST_ASSERT_EQUAL_INT32(1237611983, data.longitude_e7);    // 123 + 45.6719 / 60 degrees
+    TEST_ASSERT_EQUAL_INT32(120830, data.altitude_mm);
+    TEST_ASSERT_EQUAL_INT32(0, data.geoid_height_mm);
+    TEST_ASSERT_EQUAL_UINT16(100, data.hdop_x100);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, data.latitude);  // float members are not decoded
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_ALTITUDE, data.altitude);
+    TEST_ASSERT_EQUAL_INT(8, data.num_satellites);
+
+    ctx.decode_flags = GPS_DECODE_FLOAT | GPS_DECODE_FIXED_POINT;
+    TEST_ASSERT_EQUAL(0, gps_data_parse(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &data));
+    TEST_ASSERT_EQUAL_INT32(-65056183, data.longitude_e7);     // west longitude is negative
+    TEST_ASSERT_EQUAL_FLOAT(-6.505618, data.longitude);
+    TEST_ASSERT_EQUAL_INT32(61700, data.altitude_mm);
+    TEST_ASSERT_EQUAL_INT32(55300, data.geoid_height_mm);
+    TEST_ASSERT_EQUAL_UINT16(103, data.hdop_x100);
+
+    TEST_ASSERT_EQUAL(0, gps_data_parse(&ctx, "$GPGGA,123456.00,,N,,E,0,00,,,M,,M,,*44\r\n", &data));
+    TEST_ASSERT_EQUAL_INT32(DEFAULT_LATITUDE_E7, data.latitude_e7);
+    TEST_ASSERT_EQUAL_INT32(DEFAULT_ALTITUDE_MM, data.altitude_mm);
+    TEST_ASSERT_EQUAL_UINT16(DEFAULT_HDOP_X100, data.hdop_x100);
+}
+
+/**
+ * @brief TIME_ZONE hours wrap past midnight, and a GGA alone has no date for utc_ms.
+ */
+TEST_CASE("Time zone wraps past midnight", "[gps_parser]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,203000.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*7C\r\n", &data));
+    TEST_ASSERT_EQUAL((20 + TIME_ZONE) % 24, data.time.hour);
+    TEST_ASSERT_EQUAL(30, data.time.minute);
+    TEST_ASSERT_EQUAL_INT64(DEFAULT_UTC_MS, data.utc_ms);
+}
+
+/**
+ * @brief Only the selected GGA field groups are decoded and checked, the others keep their defaults.
+ */
+TEST_CASE("GGA field selection", "[gps_parser]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+    TEST_ASSERT_EQUAL_HEX32(GPS_GGA_FIELD_ALL, ctx.gga_fields);
+
+    // position only, e.g. for a geofence
+    ctx.gga_fields = GPS_GGA_FIELD_LATITUDE | GPS_GGA_FIELD_LONGITUDE;
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &data));
+    TEST_ASSERT_EQUAL_FLOAT(53.361336, data.latitude);
+    TEST_ASSERT_EQUAL('W', data.lon_direction);
+    TEST_ASSERT_EQUAL(DEFAULT_GPS_TIME_HR, data.time.hour);
+    TEST_ASSERT_EQUAL(DEFAULT_FIX_QUALITY, data.fix_quality);
+    TEST_ASSERT_EQUAL(DEFAULT_NUM_SATELLITES, data.num_satellites);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_HDOP, data.hdop);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_ALTITUDE, data.altitude);
+    TEST_ASSERT_EQUAL(DEFAULT_ALTITUDE_UNITS, data.altitude_units);
+
+    // time only: an invalid field outside the selection is not reported
+    ctx.gga_fields = GPS_GGA_FIELD_TIME;
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,092751.000,53A1.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*06\r\n", &data));
+    TEST_ASSERT_EQUAL(27, data.time.minute);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, data.latitude);
+    TEST_ASSERT_EQUAL_HEX32(0, ctx.invalid_fields);
+
+    ctx.gga_fields = GPS_GGA_FIELD_LATITUDE;
+    TEST_ASSERT_EQUAL(GPS_PARSE_INVALID_FIELD, gps_data_parse(&ctx, "$GPGGA,092751.000,53A1.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*06\r\n", &data));
+    TEST_ASSERT_EQUAL_HEX32(1u << 2, ctx.invalid_fields);
+}
 
 //====================================================================================================================================================================================================================================================================
 //                         Test of private functions of the library 
@@ -557,3 +816,29 @@ TEST_CASE("latitude and longitude processor test","[gps_parser]")
   TEST_ASSERT_EQUAL_FLOAT(0.0,longitude_latitude_parser_public(NULL));     // NULL input
       
 }
+
+TEST_CASE("fixed-point latitude and longitude processor test","[gps_parser]")
+{
+    TEST_ASSERT_EQUAL_INT32(593909633, longitude_latitude_fixed_point_parser_public("5923.4578")); // 59 + 23.4578 / 60, rounded
+    TEST_ASSERT_EQUAL_INT32(1377539633, longitude_latitude_fixed_point_parser_public("13745.2378"));
+    TEST_ASSERT_EQUAL_INT32(1800000000, longitude_latitude_fixed_point_parser_public("18000.0000"));
+    TEST_ASSERT_EQUAL_INT32(0, longitude_latitude_fixed_point_parser_public(NULL));
+}
+
+TEST_CASE("decimal fixed-point processor test","[gps_parser]")
+{
+    int32_t value = 0;
+    TEST_ASSERT_EQUAL(1, decimal_fixed_point_parser_public("120.83", 3, 1, &value));
+    TEST_ASSERT_EQUAL_INT32(120830, value);
+    TEST_ASSERT_EQUAL(1, decimal_fixed_point_parser_public("-12.3456", 3, 1, &value)); // rounded away from zero
+    TEST_ASSERT_EQUAL_INT32(-12346, value);
+    TEST_ASSERT_EQUAL(1, decimal_fixed_point_parser_public("0.994", 2, 0, &value));
+    TEST_ASSERT_EQUAL_INT32(99, value);
+    TEST_ASSERT_EQUAL(1, decimal_fixed_point_parser_public("7", 2, 0, &value));
+    TEST_ASSERT_EQUAL_INT32(700, value);
+    TEST_ASSERT_EQUAL(0, decimal_fixed_point_parser_public("-1.0", 2, 0, &value));    // negative not allowed
+    TEST_ASSERT_EQUAL(0, decimal_fixed_point_parser_public("1.2.3", 2, 0, &value));   // corrupted
+    TEST_ASSERT_EQUAL(0, decimal_fixed_point_parser_public("", 2, 0, &value));        // empty field
+    TEST_ASSERT_EQUAL(0, decimal_fixed_point_parser_public("-", 2, 1, &value));
+    TEST_ASSERT_EQUAL(0, decimal_fixed_point_parser_public("99999999", 3, 0, &value)); // out of the int32_t range
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_fix_history.h"
+
+// Fix i of a 1 Hz track heading north-east at about 10 m/s, with receiver noise
+static void track_fix(int i, gps_fix_record_t *record)
+{
+    gps_data_parse_t data;
+    uint32_t noise = (uint32_t) i * 2654435761u;
+
+    memset(&data, 0, sizeof(data));
+    data.time.hour = (uint8_t) (9 + i / 3600);
+    data.time.minute = (uint8_t) (i / 60 % 60);
+    data.time.second = (uint8_t) (i % 60);
+    data.time.millisecond = 0;
+    data.latitude_e7 = 533613367 + i * 640 + (int32_t) (noise >> 28) - 8;
+    data.longitude_e7 = -65056183 + i * 1070 + (int32_t) ((noise >> 24) & 15) - 8;
+    data.altitude_mm = 61700 + (int32_t) ((noise >> 20) & 3) * 100;
+    data.fix_quality = 1;
+    data.num_satellites = 8 + (i / 600) % 3;
+    data.hdop_x100 = 100;
+    gps_fix_record_encode(&data, record);
+}
+
+/**
+ * @brief An hour of 1 Hz track fits in 12 KB and is read back exactly, oldest first.
+ */
+TEST_CASE("Fix history: one hour of track", "[gps_fix_history]")
+{
+    static uint8_t storage[12 * 1024];
+    gps_fix_history_t history;
+    gps_fix_history_iter_t iter;
+    gps_fix_record_t record, expected;
+
+    TEST_ASSERT_EQUAL(0, gps_fix_history_init(&history, storage, sizeof(storage), GPS_FIX_HISTORY_DEFAULT_BLOCK_SIZE));
+    for (int i = 0; i < 3600; i++){
+        track_fix(i, &record);
+        gps_fix_history_append(&history, &record);
+    }
+    TEST_ASSERT_EQUAL(3600, history.count);
+    TEST_ASSERT_LESS_THAN(sizeof(storage), gps_fix_history_bytes_used(&history));
+
+    int i = 0;
+    gps_fix_history_iter_init(&iter, &history);
+    while (gps_fix_history_iter_next(&iter, &record)){
+        track_fix(i++, &expected);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.bytes, record.bytes, GPS_FIX_RECORD_SIZE);
+    }
+    TEST_ASSERT_EQUAL(3600, i);
+    TEST_ASSERT_EQUAL(0, gps_fix_history_iter_next(&iter, &record));
+}
+
+/**
+ * @brief A full history drops its oldest block and keeps the newest fixes in order.
+ */
+TEST_CASE("Fix history: oldest fixes are dropped", "[gps_fix_history]")
+{
+    uint8_t storage[4 * 128 + 10];
+    gps_fix_history_t history;
+    gps_fix_history_iter_t iter;
+    gps_fix_record_t record, expected;
+
+    TEST_ASSERT_EQUAL(0, gps_fix_history_init(&history, storage, sizeof(storage), 128));
+    TEST_ASSERT_EQUAL(4, history.block_count);
+    for (int i = 0; i < 500; i++){
+        track_fix(i, &record);
+        gps_fix_history_append(&history, &record);
+        TEST_ASSERT_LESS_OR_EQUAL(4 * 128, gps_fix_history_bytes_used(&history));
+    }
+    TEST_ASSERT_GREATER_THAN(60, history.count);
+    TEST_ASSERT_LESS_THAN(500, history.count);
+
+    size_t read = 0;
+    int i = 500 - (int) history.count;
+    gps_fix_history_iter_init(&iter, &history);
+    while (gps_fix_history_iter_next(&iter, &record)){
+        track_fix(i++, &expected);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected.bytes, record.bytes, GPS_FIX_RECORD_SIZE);
+        read++;
+    }
+    TEST_ASSERT_EQUAL(history.count, read);
+    TEST_ASSERT_EQUAL(500, i);
+
+    gps_fix_history_clear(&history);
+    gps_fix_history_iter_init(&iter, &history);
+    TEST_ASSERT_EQUAL(0, gps_fix_history_iter_next(&iter, &record));
+}
+
+/**
+ * @brief Missing values, midnight and jumps between records are stored exactly.
+ */
+TEST_CASE("Fix history: sentinels and large changes", "[gps_fix_history]")
+{
+    uint8_t storage[256];
+    gps_fix_history_t history;
+    gps_fix_history_iter_t iter;
+    gps_fix_record_t records[4], record;
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+
+    TEST_ASSERT_EQUAL(-1, gps_fix_history_init(&history, storage, sizeof(storage), 32));
+    TEST_ASSERT_EQUAL(-1, gps_fix_history_init(&history, storage, 100, 64));
+    TEST_ASSERT_EQUAL(0, gps_fix_history_init(&history, storage, sizeof(storage), 128));
+
+    memset(&data, 0, sizeof(data));
+    data.time.hour = 23;
+    data.time.minute = 59;
+    data.time.second = 59;
+    data.latitude_e7 = -899999999;
+    data.longitude_e7 = 1799999999;
+    data.altitude_mm = -5000;
+    data.hdop_x100 = 9990;
+    gps_fix_record_encode(&data, &records[0]);
+    data.time.hour = 0;
+    data.time.second = 0;
+    data.latitude_e7 = 899999999;
+    data.longitude_e7 = -1799999999;
+    data.altitude_mm = 5000;
+    gps_fix_record_encode(&data, &records[1]);
+    gps_parser_init(&ctx);
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GNGGA,,,,,,0,00,,,M,,M,,*78\r\n", &data));
+    gps_fix_record_encode(&data, &records[2]);
+    records[3] = records[0];
+
+    for (int i = 0; i < 4; i++)
+        gps_fix_history_append(&history, &records[i]);
+    gps_fix_history_iter_init(&iter, &history);
+    for (int i = 0; i < 4; i++){
+        TEST_ASSERT_EQUAL(1, gps_fix_history_iter_next(&iter, &record));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(records[i].bytes, record.bytes, GPS_FIX_RECORD_SIZE);
+    }
+    TEST_ASSERT_EQUAL(0, gps_fix_history_iter_next(&iter, &record));
+}
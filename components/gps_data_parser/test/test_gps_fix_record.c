@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_fix_record.h"
+
+static const char *s_gga = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+
+/**
+ * @brief The record is 18 bytes with the documented little-endian layout.
+ */
+TEST_CASE("Fix record: packed layout", "[gps_fix_record]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_fix_record_t record;
+    gps_fix_record_t records[4];
+
+    TEST_ASSERT_EQUAL(GPS_FIX_RECORD_SIZE, sizeof(record));
+    TEST_ASSERT_EQUAL(4 * GPS_FIX_RECORD_SIZE, sizeof(records));
+
+    gps_parser_init(&ctx);
+    ctx.decode_flags = GPS_DECODE_FIXED_POINT;
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, s_gga, &data));
+    gps_fix_record_encode(&data, &record);
+
+    // 533613367, -65056183, UTC time of day in ms | fix quality 1 << 27, 617 dm, 8 satellites, HDOP 10
+    uint32_t time_ms = 9u * 3600000u + 27u * 60000u + 51u * 1000u;
+    uint32_t word = time_ms | (1u << 27);
+    const uint8_t expected[GPS_FIX_RECORD_SIZE] = {
+        0x37, 0x4B, 0xCE, 0x1F,
+        0x49, 0x52, 0x1F, 0xFC,
+        (uint8_t) word, (uint8_t) (word >> 8), (uint8_t) (word >> 16), (uint8_t) (word >> 24),
+        0x69, 0x02, 0x00,
+        8,
+        10, 0,
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, record.bytes, GPS_FIX_RECORD_SIZE);
+}
+
+/**
+ * @brief Both decode modes pack to the same record, which unpacks to the values rounded to the record's units.
+ */
+TEST_CASE("Fix record: round trip of a GGA sentence", "[gps_fix_record]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_fix_record_t from_float, from_fixed_point;
+
+    gps_parser_init(&ctx);
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, s_gga, &data));
+    gps_fix_record_encode(&data, &from_float);
+    ctx.decode_flags = GPS_DECODE_FIXED_POINT;
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, s_gga, &data));
+    gps_fix_record_encode(&data, &from_fixed_point);
+
+    // the float position is only exact to a few 1e-7 degrees, the other fields pack identically
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(from_fixed_point.bytes + 8, from_float.bytes + 8, GPS_FIX_RECORD_SIZE - 8);
+    gps_fix_record_decode(&from_float, &data);
+    TEST_ASSERT_INT32_WITHIN(40, 533613367, data.latitude_e7);
+    TEST_ASSERT_INT32_WITHIN(40, -65056183, data.longitude_e7);
+
+    gps_fix_record_decode(&from_fixed_point, &data);
+    TEST_ASSERT_EQUAL(533613367, data.latitude_e7);
+    TEST_ASSERT_EQUAL(-65056183, data.longitude_e7);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 53.361336, data.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, -6.505618, data.longitude);
+    TEST_ASSERT_EQUAL('N', data.lat_direction);
+    TEST_ASSERT_EQUAL('W', data.lon_direction);
+    TEST_ASSERT_EQUAL(27, data.time.minute);
+    TEST_ASSERT_EQUAL(51, data.time.second);
+    TEST_ASSERT_EQUAL(0, data.time.millisecond);
+    TEST_ASSERT_EQUAL(1, data.fix_quality);
+    TEST_ASSERT_EQUAL(8, data.num_satellites);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.0, data.hdop);
+    TEST_ASSERT_EQUAL(100, data.hdop_x100);
+    TEST_ASSERT_EQUAL(61700, data.altitude_mm);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 61.7, data.altitude);
+    TEST_ASSERT_EQUAL('M', data.altitude_units);
+    TEST_ASSERT_EQUAL(DEFAULT_GEOID_HEIGHT, data.geoid_height);
+    TEST_ASSERT_EQUAL(DEFAULT_GEOID_HEIGHT_MM, data.geoid_height_mm);
+    TEST_ASSERT_EQUAL(DEFAULT_DGPS_STATION_ID, data.dgps_station_id);
+}
+
+/**
+ * @brief Missing and out of range values are packed as sentinels and unpack to the defaults.
+ */
+TEST_CASE("Fix record: missing values and rounding", "[gps_fix_record]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_fix_record_t record;
+
+    // receiver without a fix: only the fix quality and satellite count are present
+    gps_parser_init(&ctx);
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GNGGA,,,,,,0,00,,,M,,M,,*78\r\n", &data));
+    gps_fix_record_encode(&data, &record);
+    gps_fix_record_decode(&record, &data);
+    TEST_ASSERT_EQUAL(DEFAULT_GPS_TIME_HR, data.time.hour);
+    TEST_ASSERT_EQUAL(DEFAULT_LATITUDE, data.latitude);
+    TEST_ASSERT_EQUAL(DEFAULT_LATITUDE_E7, data.latitude_e7);
+    TEST_ASSERT_EQUAL(DEFAULT_LON_DIRECTION, data.lon_direction);
+    TEST_ASSERT_EQUAL(0, data.fix_quality);
+    TEST_ASSERT_EQUAL(0, data.num_satellites);
+    TEST_ASSERT_EQUAL(DEFAULT_HDOP, data.hdop);
+    TEST_ASSERT_EQUAL(DEFAULT_HDOP_X100, data.hdop_x100);
+    TEST_ASSERT_EQUAL(DEFAULT_ALTITUDE, data.altitude);
+    TEST_ASSERT_EQUAL(DEFAULT_ALTITUDE_MM, data.altitude_mm);
+    TEST_ASSERT_EQUAL(DEFAULT_ALTITUDE_UNITS, data.altitude_units);
+
+    // negative altitude rounds half away from zero, values beyond the record's range are dropped
+    data.altitude_mm = -1250;
+    data.hdop_x100 = DEFAULT_HDOP_X100;
+    data.hdop = 12.34f;
+    data.fix_quality = 15;
+    data.num_satellites = 300;
+    data.time.hour = 23;
+    data.time.minute = 59;
+    data.time.second = 59;
+    data.time.millisecond = 999;
+    gps_fix_record_encode(&data, &record);
+    gps_fix_record_decode(&record, &data);
+    TEST_ASSERT_EQUAL(-1300, data.altitude_mm);
+    TEST_ASSERT_EQUAL(123, (int) (data.hdop * 10 + 0.5f));
+    TEST_ASSERT_EQUAL(DEFAULT_FIX_QUALITY, data.fix_quality);
+    TEST_ASSERT_EQUAL(DEFAULT_NUM_SATELLITES, data.num_satellites);
+    TEST_ASSERT_EQUAL(23, data.time.hour);
+    TEST_ASSERT_EQUAL(999, data.time.millisecond);
+
+    data.altitude_mm = 900000000;
+    data.time.hour = 24;
+    gps_fix_record_encode(&data, &record);
+    gps_fix_record_decode(&record, &data);
+    TEST_ASSERT_EQUAL(DEFAULT_ALTITUDE_MM, data.altitude_mm);
+    TEST_ASSERT_EQUAL(DEFAULT_GPS_TIME_HR, data.time.hour);
+}
+
+/**
+ * @brief The record holds the UTC time of day, a local time on the other side of midnight round trips.
+ */
+TEST_CASE("Fix record: time is stored in UTC", "[gps_fix_record]")
+{
+    gps_data_parse_t data;
+    gps_fix_record_t record;
+
+    // 21:30:15.250 UTC, past midnight in local time for TIME_ZONE >= 3
+    memset(&data, 0, sizeof(data));
+    data.time.hour = (24 + TIME_ZONE % 24 + 21) % 24;
+    data.time.minute = 30;
+    data.time.second = 15;
+    data.time.millisecond = 250;
+    data.fix_quality = 1;
+    gps_fix_record_encode(&data, &record);
+
+    uint32_t word = record.bytes[8] | ((uint32_t) record.bytes[9] << 8) | ((uint32_t) record.bytes[10] << 16) | ((uint32_t) record.bytes[11] << 24);
+    TEST_ASSERT_EQUAL_UINT32(((21u * 60u + 30u) * 60u + 15u) * 1000u + 250u, word & GPS_FIX_RECORD_NO_TIME);
+
+    gps_fix_record_decode(&record, &data);
+    TEST_ASSERT_EQUAL((24 + TIME_ZONE % 24 + 21) % 24, data.time.hour);
+    TEST_ASSERT_EQUAL(30, data.time.minute);
+    TEST_ASSERT_EQUAL(15, data.time.second);
+    TEST_ASSERT_EQUAL(250, data.time.millisecond);
+    TEST_ASSERT_EQUAL(1, data.fix_quality);
+}
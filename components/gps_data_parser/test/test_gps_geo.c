@@ -0,0 +1,116 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_geo.h"
+
+#define RADIANS (M_PI / 180)
+
+// Double precision libm references on the same sphere
+static double reference_distance(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    double a = pow(sin((latitude2 - latitude1) * RADIANS / 2), 2)
+             + cos(latitude1 * RADIANS) * cos(latitude2 * RADIANS) * pow(sin((longitude2 - longitude1) * RADIANS / 2), 2);
+    return 2 * GPS_GEO_EARTH_RADIUS * asin(sqrt(a));
+}
+
+static double reference_bearing(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    double delta = (longitude2 - longitude1) * RADIANS;
+    double bearing = atan2(sin(delta) * cos(latitude2 * RADIANS),
+                           cos(latitude1 * RADIANS) * sin(latitude2 * RADIANS) - sin(latitude1 * RADIANS) * cos(latitude2 * RADIANS) * cos(delta)) / RADIANS;
+    return (bearing < 0) ? bearing + 360 : bearing;
+}
+
+// Deterministic pseudo-random value in -1 to 1
+static double noise(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (double) (*state >> 8) / (1 << 23) - 1;
+}
+
+/**
+ * @brief Distances and bearings from centimetres to thousands of kilometres match libm in double precision.
+ */
+TEST_CASE("Geo: distance and bearing accuracy", "[gps_geo]")
+{
+    enum { COUNT = 203 };       // not a multiple of the vector width
+    static float latitude1[COUNT], longitude1[COUNT], latitude2[COUNT], longitude2[COUNT];
+    static float distance[COUNT], bearing[COUNT];
+    uint32_t state = 12345;
+
+    for (int i = 0; i < COUNT; i++){
+        double scale = pow(10, -6 + (i % 8));                       // 1e-6 to 10 degrees apart
+        latitude1[i] = (float) (80 * noise(&state));
+        longitude1[i] = (float) (180 * noise(&state));
+        latitude2[i] = (float) fmax(-89.9, fmin(89.9, latitude1[i] + scale * noise(&state)));
+        longitude2[i] = longitude1[i] + (float) (scale * noise(&state));
+    }
+    latitude2[0] = latitude1[0];                                    // identical points
+    longitude2[0] = longitude1[0];
+    latitude1[1] = 10.0f, longitude1[1] = 179.5f;                   // across the antimeridian
+    latitude2[1] = 10.0f, longitude2[1] = -179.5f;
+
+    gps_geo_distance(latitude1, longitude1, latitude2, longitude2, distance, COUNT);
+    gps_geo_bearing(latitude1, longitude1, latitude2, longitude2, bearing, COUNT);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, distance[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, bearing[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 111195.0 * cos(10 * RADIANS), distance[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 90.0, bearing[1]);
+    for (int i = 1; i < COUNT; i++){
+        double expected = reference_distance(latitude1[i], longitude1[i], latitude2[i], longitude2[i]);
+        TEST_ASSERT_FLOAT_WITHIN(1e-5 * expected + 0.005, expected, distance[i]);
+        if (expected > 1.0){
+            double expected_bearing = reference_bearing(latitude1[i], longitude1[i], latitude2[i], longitude2[i]);
+            double error = fabs(expected_bearing - bearing[i]);
+            TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, fmin(error, 360 - error));
+        }
+    }
+}
+
+/**
+ * @brief Track length, cumulative lengths, segment bearings and speeds of consecutive fixes.
+ */
+TEST_CASE("Geo: track length and speeds", "[gps_geo]")
+{
+    enum { COUNT = 150 };       // more than one chunk of gps_geo_track_length()
+    static float latitude[COUNT], longitude[COUNT], segment[COUNT - 1], bearing[COUNT - 1], speed[COUNT - 1];
+    static int64_t time_ms[COUNT];
+    static double cumulative[COUNT];
+    gps_geo_track_t track = { latitude, longitude, time_ms, COUNT };
+
+    // due north along a meridian, 10 m every second, then a fix with the same time
+    for (int i = 0; i < COUNT; i++){
+        latitude[i] = (float) (53.0 + i * 10 / (GPS_GEO_EARTH_RADIUS * RADIANS));
+        longitude[i] = -6.5f;
+        time_ms[i] = 1000LL * i;
+    }
+    time_ms[COUNT - 1] = time_ms[COUNT - 2];
+
+    gps_geo_track_segments(&track, segment);
+    gps_geo_track_bearings(&track, bearing);
+    gps_geo_track_speeds(&track, speed);
+    double length = gps_geo_track_length(&track, cumulative);
+
+    // float latitudes near 53 degrees are only exact to about 0.4 m
+    TEST_ASSERT_FLOAT_WITHIN(0.5, (COUNT - 1) * 10.0, length);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, cumulative[0]);
+    TEST_ASSERT_EQUAL_DOUBLE(length, cumulative[COUNT - 1]);
+    for (int i = 0; i < COUNT - 1; i++){
+        double expected = reference_distance(latitude[i], longitude[i], latitude[i + 1], longitude[i + 1]);
+        TEST_ASSERT_FLOAT_WITHIN(0.001, expected, segment[i]);
+        TEST_ASSERT_FLOAT_WITHIN(1e-6, cumulative[i] + segment[i], cumulative[i + 1]);
+        TEST_ASSERT_TRUE(bearing[i] < 0.01f || bearing[i] > 359.99f);
+        if (i < COUNT - 2)
+            TEST_ASSERT_FLOAT_WITHIN(0.001, expected, speed[i]);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(GPS_GEO_NO_SPEED, speed[COUNT - 2]);
+
+    // short tracks have no segments
+    track.count = 1;
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, gps_geo_track_length(&track, cumulative));
+    track.count = 0;
+    gps_geo_track_speeds(&track, speed);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, gps_geo_track_length(&track, NULL));
+}
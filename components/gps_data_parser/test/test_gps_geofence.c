@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_geofence.h"
+
+#define METRES_PER_E7   0.0111194926
+
+// Records the events reported by gps_geofence_update()
+typedef struct {
+    int count;
+    int fence[16];
+    gps_geofence_event_t event[16];
+} event_sink_t;
+
+static void sink_event(int fence, gps_geofence_event_t event, const gps_data_parse_t *fix, void *user_ctx)
+{
+    event_sink_t *sink = (event_sink_t *) user_ctx;
+    if (sink->count < 16){
+        sink->fence[sink->count] = fence;
+        sink->event[sink->count] = event;
+    }
+    sink->count++;
+}
+
+static gps_data_parse_t fix_e7(int32_t latitude_e7, int32_t longitude_e7)
+{
+    gps_data_parse_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.latitude_e7 = latitude_e7;
+    fix.longitude_e7 = longitude_e7;
+    return fix;
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+/**
+ * @brief Enter and exit events of a concave polygon and a circle along a path.
+ */
+TEST_CASE("Geofence: polygon and circle transitions", "[gps_geofence]")
+{
+    // L-shaped depot: 0..2000 x 0..1000 plus 0..1000 x 1000..2000 (longitude x latitude, 1e-7 degrees from 53.36 N 6.5 W)
+    static const gps_geofence_point_t depot[] = {
+        { 533600000, -65000000 }, { 533600000, -64998000 }, { 533601000, -64998000 },
+        { 533601000, -64999000 }, { 533602000, -64999000 }, { 533602000, -65000000 },
+    };
+    static uint64_t storage[256];
+    event_sink_t sink = { 0 };
+    gps_geofence_t geofence;
+
+    TEST_ASSERT_EQUAL(0, gps_geofence_init(&geofence, storage, sizeof(storage), 4, sink_event, &sink));
+    TEST_ASSERT_EQUAL(0, gps_geofence_add_polygon(&geofence, depot, 6));
+    // 50 m circle around a point 100 m north of the depot
+    int32_t circle_latitude = 533602000 + (int32_t) (100 / METRES_PER_E7);
+    TEST_ASSERT_EQUAL(1, gps_geofence_add_circle(&geofence, circle_latitude, -64999500, 50.0f));
+    gps_data_parse_t fix = fix_e7(533600500, -64999500);
+    TEST_ASSERT_EQUAL(-1, gps_geofence_update(&geofence, &fix));
+    TEST_ASSERT_EQUAL(0, gps_geofence_build(&geofence));
+    TEST_ASSERT_EQUAL(-1, gps_geofence_add_circle(&geofence, 0, 0, 10.0f));
+
+    // inside the lower arm
+    TEST_ASSERT_EQUAL(1, gps_geofence_update(&geofence, &fix));
+    TEST_ASSERT_EQUAL(0, sink.fence[0]);
+    TEST_ASSERT_EQUAL(GPS_GEOFENCE_ENTER, sink.event[0]);
+    TEST_ASSERT_EQUAL(1, gps_geofence_is_inside(&geofence, 0));
+
+    // the notch of the L is inside the bounding box but outside the polygon
+    fix = fix_e7(533601500, -64998500);
+    TEST_ASSERT_EQUAL(1, gps_geofence_update(&geofence, &fix));
+    TEST_ASSERT_EQUAL(GPS_GEOFENCE_EXIT, sink.event[1]);
+    fix = fix_e7(533601500, -64999500);
+    TEST_ASSERT_EQUAL(1, gps_geofence_update(&geofence, &fix));
+    TEST_ASSERT_EQUAL(GPS_GEOFENCE_ENTER, sink.event[2]);
+    TEST_ASSERT_EQUAL(0, gps_geofence_update(&geofence, &fix));
+
+    // straight into the circle: leave the depot, enter the circle in one fix
+    fix = fix_e7(circle_latitude + (int32_t) (40 / METRES_PER_E7), -64999500);
+    TEST_ASSERT_EQUAL(2, gps_geofence_update(&geofence, &fix));
+    TEST_ASSERT_EQUAL(0, sink.fence[3]);
+    TEST_ASSERT_EQUAL(GPS_GEOFENCE_EXIT, sink.event[3]);
+    TEST_ASSERT_EQUAL(1, sink.fence[4]);
+    TEST_ASSERT_EQUAL(GPS_GEOFENCE_ENTER, sink.event[4]);
+    TEST_ASSERT_EQUAL(0, gps_geofence_is_inside(&geofence, 0));
+    TEST_ASSERT_EQUAL(1, gps_geofence_is_inside(&geofence, 1));
+
+    // fixes without a position change nothing, 60 m from the center is outside
+    gps_data_parse_t no_fix = fix_e7(DEFAULT_LATITUDE_E7, DEFAULT_LONGITUDE_E7);
+    no_fix.latitude = DEFAULT_LATITUDE;
+    no_fix.longitude = DEFAULT_LONGITUDE;
+    TEST_ASSERT_EQUAL(0, gps_geofence_update(&geofence, &no_fix));
+    fix = fix_e7(circle_latitude + (int32_t) (60 / METRES_PER_E7), -64999500);
+    TEST_ASSERT_EQUAL(1, gps_geofence_update(&geofence, &fix));
+    TEST_ASSERT_EQUAL(GPS_GEOFENCE_EXIT, sink.event[5]);
+    TEST_ASSERT_EQUAL(6, sink.count);
+
+    // invalid fences
+    TEST_ASSERT_EQUAL(0, gps_geofence_init(&geofence, storage, sizeof(storage), 4, NULL, NULL));
+    TEST_ASSERT_EQUAL(-1, gps_geofence_add_polygon(&geofence, depot, 2));
+    TEST_ASSERT_EQUAL(-1, gps_geofence_add_circle(&geofence, 0, 0, 0.0f));
+    TEST_ASSERT_EQUAL(-1, gps_geofence_add_circle(&geofence, 950000000, 0, 10.0f));
+    TEST_ASSERT_EQUAL(-1, gps_geofence_init(&geofence, storage, 64, 4, NULL, NULL));
+}
+
+/**
+ * @brief With thousands of fences the grid gives the same state as testing every fence, for a few fences per fix.
+ */
+TEST_CASE("Geofence: grid index matches a linear scan", "[gps_geofence]")
+{
+    enum { FENCES = 3000, FIXES = 2000 };
+    static gps_geofence_point_t squares[FENCES][4];
+    static uint8_t storage[GPS_GEOFENCE_STORAGE_SIZE(FENCES)];
+    static uint8_t expected[FENCES];
+    event_sink_t sink = { 0 };
+    gps_geofence_t geofence;
+    uint32_t random = 1;
+
+    // squares of 100 to 1000 units on even coordinates over a 0.01 x 0.01 degree area, fixes on odd ones never hit an edge
+    TEST_ASSERT_EQUAL(0, gps_geofence_init(&geofence, storage, sizeof(storage), FENCES, sink_event, &sink));
+    for (int i = 0; i < FENCES; i++){
+        int32_t latitude = 533000000 + (int32_t) (next_random(&random) % 100000);
+        int32_t longitude = -65000000 + (int32_t) (next_random(&random) % 100000);
+        int32_t size = 100 + (int32_t) (next_random(&random) % 900);
+        latitude &= ~1;
+        longitude &= ~1;
+        size &= ~1;
+        squares[i][0] = (gps_geofence_point_t) { latitude, longitude };
+        squares[i][1] = (gps_geofence_point_t) { latitude, longitude + size };
+        squares[i][2] = (gps_geofence_point_t) { latitude + size, longitude + size };
+        squares[i][3] = (gps_geofence_point_t) { latitude + size, longitude };
+        TEST_ASSERT_EQUAL(i, gps_geofence_add_polygon(&geofence, squares[i], 4));
+    }
+    TEST_ASSERT_EQUAL(0, gps_geofence_build(&geofence));
+    TEST_ASSERT_GREATER_THAN(FENCES / 4, geofence.rows * geofence.columns);
+
+    int32_t latitude = 533050001, longitude = -64950001;
+    size_t most_tested = 0;
+    int events = 0, changes = 0;
+    for (int n = 0; n < FIXES; n++){
+        latitude += ((int32_t) (next_random(&random) % 801) - 400) * 2;
+        longitude += ((int32_t) (next_random(&random) % 801) - 400) * 2;
+        gps_data_parse_t fix = fix_e7(latitude, longitude);
+        events += gps_geofence_update(&geofence, &fix);
+        most_tested = (geofence.tested > most_tested) ? geofence.tested : most_tested;
+
+        for (int i = 0; i < FENCES; i++){
+            uint8_t inside = latitude > squares[i][0].latitude_e7 && latitude < squares[i][2].latitude_e7
+                          && longitude > squares[i][0].longitude_e7 && longitude < squares[i][2].longitude_e7;
+            changes += (inside != expected[i]);
+            expected[i] = inside;
+            TEST_ASSERT_EQUAL(inside, gps_geofence_is_inside(&geofence, i));
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(20, changes);
+    TEST_ASSERT_EQUAL(changes, events);
+    TEST_ASSERT_EQUAL(changes, sink.count);
+    TEST_ASSERT_LESS_THAN(FENCES / 50, most_tested);
+
+    // a storage too small for the full grid gets a coarser one that gives the same answers
+    static uint8_t small_storage[FENCES * sizeof(gps_geofence_shape_t) + FENCES * 5];
+    gps_geofence_t coarse;
+    TEST_ASSERT_EQUAL(0, gps_geofence_init(&coarse, small_storage, sizeof(small_storage), FENCES, NULL, NULL));
+    for (int i = 0; i < FENCES; i++)
+        gps_geofence_add_polygon(&coarse, squares[i], 4);
+    TEST_ASSERT_EQUAL(0, gps_geofence_build(&coarse));
+    TEST_ASSERT_LESS_THAN(geofence.rows * geofence.columns, coarse.rows * coarse.columns);
+    gps_data_parse_t fix = fix_e7(latitude, longitude);
+    gps_geofence_update(&coarse, &fix);
+    for (int i = 0; i < FENCES; i++)
+        TEST_ASSERT_EQUAL(expected[i], gps_geofence_is_inside(&coarse, i));
+
+    // no room for even one cell
+    TEST_ASSERT_EQUAL(0, gps_geofence_init(&coarse, small_storage, FENCES * sizeof(gps_geofence_shape_t), FENCES, NULL, NULL));
+    for (int i = 0; i < FENCES; i++)
+        gps_geofence_add_polygon(&coarse, squares[i], 4);
+    TEST_ASSERT_EQUAL(-1, gps_geofence_build(&coarse));
+}
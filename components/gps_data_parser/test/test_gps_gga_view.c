@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_gga_view.h"
+
+static const char *s_gga = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+
+/**
+ * @brief Reading position and fix quality converts those groups only, each one once.
+ */
+TEST_CASE("GGA view: accessors convert on first access", "[gps_gga_view]")
+{
+    gps_gga_view_t view;
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_gga_view_init(&view, s_gga, strlen(s_gga)));
+    TEST_ASSERT_EQUAL(0, view.decoded_float | view.decoded_fixed_point);
+    TEST_ASSERT_EQUAL(DEFAULT_LATITUDE, view.data.latitude);
+    TEST_ASSERT_EQUAL(7, view.field_offset[1]);
+    TEST_ASSERT_EQUAL(10, view.field_length[1]);
+    TEST_ASSERT_EQUAL(0, view.field_length[14]);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 53.361336, gps_gga_view_latitude(&view));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, -6.505618, gps_gga_view_longitude(&view));
+    TEST_ASSERT_EQUAL(1, gps_gga_view_fix_quality(&view));
+    TEST_ASSERT_EQUAL(GPS_GGA_FIELD_LATITUDE | GPS_GGA_FIELD_LONGITUDE | GPS_GGA_FIELD_FIX_QUALITY, view.decoded_float);
+    TEST_ASSERT_EQUAL('N', view.data.lat_direction);
+    TEST_ASSERT_EQUAL(DEFAULT_HDOP, view.data.hdop);               // not read, not converted
+    TEST_ASSERT_EQUAL(DEFAULT_GPS_TIME_SEC, view.data.time.second);
+
+    // fixed-point values of an already converted group are converted separately
+    TEST_ASSERT_EQUAL(533613367, gps_gga_view_latitude_e7(&view));
+    TEST_ASSERT_EQUAL(-65056183, gps_gga_view_longitude_e7(&view));
+    TEST_ASSERT_EQUAL(61700, gps_gga_view_altitude_mm(&view));
+    TEST_ASSERT_EQUAL(GPS_GGA_FIELD_LATITUDE | GPS_GGA_FIELD_LONGITUDE | GPS_GGA_FIELD_ALTITUDE, view.decoded_fixed_point);
+    TEST_ASSERT_EQUAL(51, gps_gga_view_time(&view)->second);
+    TEST_ASSERT_EQUAL(8, gps_gga_view_num_satellites(&view));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.03, gps_gga_view_hdop(&view));
+    TEST_ASSERT_EQUAL(0, view.invalid_fields);
+}
+
+// Compares every member, padding bytes are not initialized
+static void assert_gga_equal(const gps_data_parse_t *expected, const gps_data_parse_t *actual)
+{
+    TEST_ASSERT_EQUAL(expected->time.hour, actual->time.hour);
+    TEST_ASSERT_EQUAL(expected->time.minute, actual->time.minute);
+    TEST_ASSERT_EQUAL(expected->time.second, actual->time.second);
+    TEST_ASSERT_EQUAL(expected->time.millisecond, actual->time.millisecond);
+    TEST_ASSERT_EQUAL_FLOAT(expected->latitude, actual->latitude);
+    TEST_ASSERT_EQUAL(expected->lat_direction, actual->lat_direction);
+    TEST_ASSERT_EQUAL_FLOAT(expected->longitude, actual->longitude);
+    TEST_ASSERT_EQUAL(expected->lon_direction, actual->lon_direction);
+    TEST_ASSERT_EQUAL(expected->fix_quality, actual->fix_quality);
+    TEST_ASSERT_EQUAL(expected->num_satellites, actual->num_satellites);
+    TEST_ASSERT_EQUAL_FLOAT(expected->hdop, actual->hdop);
+    TEST_ASSERT_EQUAL_FLOAT(expected->altitude, actual->altitude);
+    TEST_ASSERT_EQUAL(expected->altitude_units, actual->altitude_units);
+    TEST_ASSERT_EQUAL_FLOAT(expected->geoid_height, actual->geoid_height);
+    TEST_ASSERT_EQUAL(expected->geoid_height_units, actual->geoid_height_units);
+    TEST_ASSERT_EQUAL_FLOAT(expected->dgps_age, actual->dgps_age);
+    TEST_ASSERT_EQUAL(expected->dgps_station_id, actual->dgps_station_id);
+    TEST_ASSERT_EQUAL(expected->latitude_e7, actual->latitude_e7);
+    TEST_ASSERT_EQUAL(expected->longitude_e7, actual->longitude_e7);
+    TEST_ASSERT_EQUAL(expected->altitude_mm, actual->altitude_mm);
+    TEST_ASSERT_EQUAL(expected->geoid_height_mm, actual->geoid_height_mm);
+    TEST_ASSERT_EQUAL(expected->hdop_x100, actual->hdop_x100);
+}
+
+/**
+ * @brief Converting every group gives the same result as the eager parser.
+ */
+TEST_CASE("GGA view: full decode matches gps_gga_sentence_parse", "[gps_gga_view]")
+{
+    const char *sentences[] = {
+        "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75",
+        "$GNGGA,002153.000,3342.6618,S,11751.3858,E,2,10,1.2,27.0,M,-34.2,M,2.5,0031*67",
+        "$GPGGA,092751.000,5321.6802,X,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*63",
+    };
+    gps_parser_ctx_t ctx;
+    gps_gga_view_t view;
+    gps_data_parse_t expected;
+
+    gps_parser_init(&ctx);
+    ctx.decode_flags = GPS_DECODE_FLOAT | GPS_DECODE_FIXED_POINT;
+    for (size_t i = 0; i < sizeof(sentences) / sizeof(sentences[0]); i++){
+        size_t length = strlen(sentences[i]);
+        gps_parse_result_t result = gps_gga_sentence_parse(&ctx, sentences[i], length, &expected);
+        TEST_ASSERT_TRUE(result >= GPS_PARSE_OK);
+        TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_gga_view_init(&view, sentences[i], length));
+
+        const gps_data_parse_t *data = gps_gga_view_decode(&view, GPS_GGA_FIELD_ALL, ctx.decode_flags);
+        assert_gga_equal(&expected, data);
+        TEST_ASSERT_EQUAL_HEX32(ctx.invalid_fields, view.invalid_fields);
+    }
+    TEST_ASSERT_EQUAL_HEX32(1u << 3, view.invalid_fields);  // hemisphere 'X'
+}
+
+TEST_CASE("GGA view: rejected sentences", "[gps_gga_view]")
+{
+    gps_gga_view_t view;
+    const char *wrong_checksum = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76";
+    const char *rmc = "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43";
+    const char *short_gga = "$GPGGA,092751.000,5321.6802,N*05";
+    const char *trailing = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n$";
+
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_CHECKSUM, gps_gga_view_init(&view, wrong_checksum, strlen(wrong_checksum)));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_UNSUPPORTED, gps_gga_view_init(&view, rmc, strlen(rmc)));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FIELD_COUNT, gps_gga_view_init(&view, short_gga, strlen(short_gga)));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_gga_view_init(&view, trailing, strlen(trailing)));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_gga_view_init(&view, s_gga, 40));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_gga_view_init(&view, NULL, 0));
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_nmea_epoch.h"
+
+// One second of multi-GNSS output followed by an epoch without VTG and the start of a third
+static const char *s_epochs =
+    "$GNRMC,092751.000,A,5321.6802,N,00630.3371,W,0.02,31.66,280511,,,A*5F\r\n"
+    "$GNVTG,31.66,T,,M,0.02,N,0.04,K,A*17\r\n"
+    "$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*6B\r\n"
+    "$GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*14\r\n"
+    "$GNGSA,A,2,65,66,,,,,,,,,,,2.50,2.00,1.50*1F\r\n"
+    "$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76\r\n"
+    "$GNGLL,5321.6802,N,00630.3371,W,092751.000,A,A*57\r\n"
+    "$GNGGA,092752.000,5321.6803,N,00630.3372,W,1,9,0.98,61.9,M,55.3,M,,*66\r\n"
+    "$GNGSA,A,3,10,07,05,02,29,04,08,13,16,,,,1.60,0.98,1.25*1F\r\n"
+    "$GNRMC,092752.000,A,5321.6803,N,00630.3372,W,0.05,30.10,280511,,,A*59\r\n"
+    "$GNRMC,092753.000,A,5321.6804,N,00630.3373,W,0.07,29.50,280511,,,A*50\r\n";
+
+// Collects the published epochs
+typedef struct {
+    int count;
+    gps_fix_t fixes[4];
+} fix_sink_t;
+
+static void sink_fix(const gps_fix_t *fix, void *user_ctx)
+{
+    fix_sink_t *sink = (fix_sink_t *) user_ctx;
+    if (sink->count < 4)
+        sink->fixes[sink->count] = *fix;
+    sink->count++;
+}
+
+// Decodes buffer and feeds every sentence to the aggregator, returns the number of epochs published
+static int feed_sentences(gps_nmea_epoch_t *epoch, const char *buffer)
+{
+    static gps_nmea_msg_t msgs[16];
+    gps_parser_ctx_t ctx;
+    int published = 0;
+
+    gps_parser_init(&ctx);
+    ctx.decode_flags = GPS_DECODE_FLOAT | GPS_DECODE_FIXED_POINT;
+    size_t count = gps_nmea_parse_batch(&ctx, buffer, strlen(buffer), msgs, 16, NULL);
+    for (size_t i = 0; i < count; i++)
+        published += gps_nmea_epoch_add(epoch, &msgs[i]);
+    return published;
+}
+
+/**
+ * @brief RMC, VTG, GGA and GSA of one UTC time are merged into one record, published as soon
+ * as the last of them arrives; the trailing GSA, GSV and GLL of that epoch are ignored.
+ */
+TEST_CASE("Epoch: sentences of one time are merged and published once", "[gps_epoch]")
+{
+    fix_sink_t sink = { 0 };
+    gps_nmea_epoch_t epoch;
+
+    gps_nmea_epoch_init(&epoch, GPS_EPOCH_DEFAULT_REQUIRED, sink_fix, &sink);
+    TEST_ASSERT_EQUAL(2, feed_sentences(&epoch, s_epochs));
+    TEST_ASSERT_EQUAL(2, sink.count);
+
+    const gps_fix_t *fix = &sink.fixes[0];
+    TEST_ASSERT_EQUAL(GPS_EPOCH_DEFAULT_REQUIRED, fix->sources);
+    TEST_ASSERT_EQUAL(27, fix->time.minute);
+    TEST_ASSERT_EQUAL(51, fix->time.second);
+    TEST_ASSERT_EQUAL(28, fix->date.day);
+    TEST_ASSERT_EQUAL(5, fix->date.month);
+    TEST_ASSERT_EQUAL(2011, fix->date.year);
+    TEST_ASSERT_EQUAL_INT64(1306574871000LL, fix->utc_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 53.361336, fix->latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, -6.505618, fix->longitude);
+    TEST_ASSERT_EQUAL(533613367, fix->latitude_e7);
+    TEST_ASSERT_EQUAL(61700, fix->altitude_mm);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 61.7, fix->altitude);
+    TEST_ASSERT_EQUAL(1, fix->fix_quality);
+    TEST_ASSERT_EQUAL(8, fix->num_satellites);
+    TEST_ASSERT_EQUAL(3, fix->fix_type);                    // first GSA of the epoch
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.72, fix->pdop);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.03, fix->hdop);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.38, fix->vdop);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.02, fix->speed_knots);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.04, fix->speed_kmh);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 31.66, fix->course);
+    TEST_ASSERT_EQUAL('A', fix->status);
+    TEST_ASSERT_EQUAL('A', fix->mode);
+
+    // no VTG in the second epoch: published incomplete when the third one starts
+    fix = &sink.fixes[1];
+    TEST_ASSERT_EQUAL(52, fix->time.second);
+    TEST_ASSERT_EQUAL_INT64(1306574872000LL, fix->utc_ms);         // dated by the RMC of the previous epoch
+    TEST_ASSERT_EQUAL(GPS_FIX_SOURCE(GPS_SENTENCE_GGA) | GPS_FIX_SOURCE(GPS_SENTENCE_GSA) | GPS_FIX_SOURCE(GPS_SENTENCE_RMC), fix->sources);
+    TEST_ASSERT_EQUAL(9, fix->num_satellites);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.05, fix->speed_knots);
+    TEST_ASSERT_EQUAL(DEFAULT_SPEED, fix->speed_kmh);
+
+    // the third epoch is still open until flushed
+    TEST_ASSERT_EQUAL(1, gps_nmea_epoch_flush(&epoch));
+    TEST_ASSERT_EQUAL(3, sink.count);
+    TEST_ASSERT_EQUAL(53, sink.fixes[2].time.second);
+    TEST_ASSERT_EQUAL(DEFAULT_FIX_QUALITY, sink.fixes[2].fix_quality);
+    TEST_ASSERT_EQUAL(0, gps_nmea_epoch_flush(&epoch));
+}
+
+/**
+ * @brief Untimed sentences before the first timed one, and sentences with an empty time
+ * (no fix yet) cannot be placed in an epoch and are ignored.
+ */
+TEST_CASE("Epoch: sentences without a time", "[gps_epoch]")
+{
+    fix_sink_t sink = { 0 };
+    gps_nmea_epoch_t epoch;
+
+    gps_nmea_epoch_init(&epoch, GPS_FIX_SOURCE(GPS_SENTENCE_GGA), sink_fix, &sink);
+    TEST_ASSERT_EQUAL(0, feed_sentences(&epoch, "$GNVTG,31.66,T,,M,0.02,N,0.04,K,A*17\r\n"
+                                                "$GNGGA,,,,,,0,00,,,M,,M,,*78\r\n"));
+    TEST_ASSERT_EQUAL(0, gps_nmea_epoch_flush(&epoch));
+
+    // a required set of GGA only completes every epoch on its GGA
+    TEST_ASSERT_EQUAL(2, feed_sentences(&epoch, s_epochs));
+    TEST_ASSERT_EQUAL(2, sink.count);
+    TEST_ASSERT_EQUAL(GPS_FIX_SOURCE(GPS_SENTENCE_RMC) | GPS_FIX_SOURCE(GPS_SENTENCE_VTG) | GPS_FIX_SOURCE(GPS_SENTENCE_GGA),
+                      sink.fixes[0].sources);
+    TEST_ASSERT_EQUAL(GPS_FIX_SOURCE(GPS_SENTENCE_GGA), sink.fixes[1].sources);
+    TEST_ASSERT_EQUAL(1, gps_nmea_epoch_flush(&epoch));     // RMC of 092753 opened the third epoch
+}
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_nmea_ring.h"
+
+static const char *s_gga = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+
+// Copies a view into a NUL-terminated string for comparisons
+static size_t view_to_string(const gps_nmea_view_t *view, char *out)
+{
+    memcpy(out, view->segment[0].data, view->segment[0].length);
+    memcpy(out + view->segment[0].length, view->segment[1].data, view->segment[1].length);
+    out[view->segment[0].length + view->segment[1].length] = '\0';
+    return view->segment[0].length + view->segment[1].length;
+}
+
+TEST_CASE("Ring: capacity must be a power of two", "[gps_ring]")
+{
+    char storage[256];
+    gps_nmea_ring_t ring;
+
+    TEST_ASSERT_EQUAL(-1, gps_nmea_ring_init(&ring, storage, 0));
+    TEST_ASSERT_EQUAL(-1, gps_nmea_ring_init(&ring, storage, 200));
+    // too small for the longest sentence and its CRLF
+    TEST_ASSERT_EQUAL(-1, gps_nmea_ring_init(&ring, storage, GPS_NMEA_MAX_SENTENCE_LEN));
+    TEST_ASSERT_EQUAL(0, gps_nmea_ring_init(&ring, storage, sizeof(storage)));
+}
+
+TEST_CASE("Ring: writes stop when full and readable bytes wrap", "[gps_ring]")
+{
+    char storage[256];
+    char data[300];
+    gps_nmea_ring_t ring;
+    gps_nmea_view_t view;
+    char text[257];
+
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = 'A' + i % 26;
+    gps_nmea_ring_init(&ring, storage, sizeof(storage));
+    TEST_ASSERT_EQUAL(0, gps_nmea_ring_peek(&ring, &view));
+    TEST_ASSERT_EQUAL(252, gps_nmea_ring_write(&ring, data, 252));
+    gps_nmea_ring_consume(&ring, 250);
+
+    // 4 bytes left before the end of the storage, 254 free in total
+    TEST_ASSERT_EQUAL(254, gps_nmea_ring_write(&ring, data, sizeof(data)));
+    TEST_ASSERT_EQUAL(0, gps_nmea_ring_write(&ring, "T", 1));
+    TEST_ASSERT_EQUAL(256, gps_nmea_ring_peek(&ring, &view));
+    TEST_ASSERT_EQUAL(6, view.segment[0].length);
+    TEST_ASSERT_EQUAL(250, view.segment[1].length);
+    view_to_string(&view, text);
+    TEST_ASSERT_EQUAL(0, memcmp(text, data + 250, 2));
+    TEST_ASSERT_EQUAL(0, memcmp(text + 2, data, 254));
+
+    // reserve/commit exposes the free region up to the end of the storage only
+    char *region;
+    gps_nmea_ring_consume(&ring, 256);
+    TEST_ASSERT_EQUAL(6, gps_nmea_ring_write_reserve(&ring, &region));
+    TEST_ASSERT_EQUAL_PTR(storage + 250, region);
+    memcpy(region, "uvwxyz", 6);
+    gps_nmea_ring_write_commit(&ring, 6);
+    TEST_ASSERT_EQUAL(250, gps_nmea_ring_write_reserve(&ring, &region));
+    TEST_ASSERT_EQUAL_PTR(storage, region);
+    TEST_ASSERT_EQUAL(6, gps_nmea_ring_peek(&ring, &view));
+}
+
+/**
+ * @brief A sentence that wraps the end of the storage is returned as two segments pointing into
+ * the ring, for every possible wrap point, and decodes like a contiguous one.
+ */
+TEST_CASE("Ring: sentence wrapping the end is a two segment view", "[gps_ring]")
+{
+    char storage[256];
+    size_t gga_length = strlen(s_gga);
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msg;
+    char text[GPS_NMEA_MAX_SENTENCE_LEN + 1];
+
+    gps_parser_init(&ctx);
+    for (size_t shift = 0; shift < sizeof(storage); shift++){
+        gps_nmea_ring_t ring;
+        gps_nmea_view_t sentence;
+        size_t advance;
+
+        gps_nmea_ring_init(&ring, storage, sizeof(storage));
+        memset(storage, '-', sizeof(storage));
+        gps_nmea_ring_write(&ring, storage, shift);
+        gps_nmea_ring_consume(&ring, shift);
+        gps_nmea_ring_write(&ring, "xx", 2);     // noise before the sentence
+        TEST_ASSERT_EQUAL(gga_length, gps_nmea_ring_write(&ring, s_gga, gga_length));
+
+        TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+        TEST_ASSERT_EQUAL(2 + gga_length, advance);
+        TEST_ASSERT_TRUE(sentence.segment[0].data >= storage && sentence.segment[0].data < storage + sizeof(storage));
+        size_t start = (shift + 2) % sizeof(storage);
+        if (start + gga_length - 2 > sizeof(storage))
+            TEST_ASSERT_EQUAL(sizeof(storage) - start, sentence.segment[0].length);
+        else
+            TEST_ASSERT_EQUAL(0, sentence.segment[1].length);
+        TEST_ASSERT_EQUAL(gga_length - 2, view_to_string(&sentence, text));
+        TEST_ASSERT_EQUAL(0, strncmp(s_gga, text, gga_length - 2));
+
+        TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_nmea_sentence_parse_view(&ctx, &sentence, &msg));
+        TEST_ASSERT_EQUAL(GPS_SENTENCE_GGA, msg.type);
+        TEST_ASSERT_EQUAL(8, msg.data.gga.num_satellites);
+        TEST_ASSERT_FLOAT_WITHIN(0.01, 61.7, msg.data.gga.altitude);
+
+        gps_nmea_ring_consume(&ring, advance);
+        TEST_ASSERT_EQUAL(GPS_PARSE_INCOMPLETE, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+        TEST_ASSERT_EQUAL(0, advance);
+    }
+}
+
+/**
+ * @brief Bytes trickling in one at a time: the sentence is reported once, when its LF arrives,
+ * and the rejection classes match gps_nmea_parse_next().
+ */
+TEST_CASE("Ring: incomplete sentences and rejections", "[gps_ring]")
+{
+    char storage[256];
+    gps_nmea_ring_t ring;
+    gps_nmea_view_t sentence;
+    size_t advance;
+    size_t gga_length = strlen(s_gga);
+    int complete = 0;
+
+    gps_nmea_ring_init(&ring, storage, sizeof(storage));
+    for (size_t i = 0; i < gga_length; i++){
+        gps_nmea_ring_write(&ring, s_gga + i, 1);
+        gps_parse_result_t result = gps_nmea_ring_next_sentence(&ring, &sentence, &advance);
+        if (result == GPS_PARSE_OK)
+            complete++;
+        else
+            TEST_ASSERT_EQUAL(GPS_PARSE_INCOMPLETE, result);
+        gps_nmea_ring_consume(&ring, advance);
+    }
+    TEST_ASSERT_EQUAL(1, complete);
+
+    // wrong checksum, then a sentence interrupted by a new '$', then one without checksum
+    const char *bad = "$GPGGA,1,2*00\r\n$GPGSA,A$GPGLL,1*\r\n$GPVTG,1\r\n";
+    gps_nmea_ring_write(&ring, bad, strlen(bad));
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_CHECKSUM, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+    gps_nmea_ring_consume(&ring, advance);
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+    gps_nmea_ring_consume(&ring, advance);
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_CHECKSUM, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+    gps_nmea_ring_consume(&ring, advance);
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+    gps_nmea_ring_consume(&ring, advance);
+    TEST_ASSERT_EQUAL(GPS_PARSE_INCOMPLETE, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+
+    // a '$' followed by more than a sentence worth of bytes is dropped so a full ring drains
+    gps_nmea_ring_init(&ring, storage, sizeof(storage));
+    gps_nmea_ring_write(&ring, "$", 1);
+    while (gps_nmea_ring_write(&ring, "AAAAAAAA", 8) != 0)
+        ;
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FORMAT, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+    TEST_ASSERT_EQUAL(1, advance);
+    gps_nmea_ring_consume(&ring, advance);
+    TEST_ASSERT_EQUAL(GPS_PARSE_INCOMPLETE, gps_nmea_ring_next_sentence(&ring, &sentence, &advance));
+    TEST_ASSERT_EQUAL(sizeof(storage) - 1, advance);
+}
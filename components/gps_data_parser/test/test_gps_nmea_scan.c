@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_nmea_scan.h"
+
+// Byte by byte reference of gps_nmea_scan_checksum()
+static size_t reference_checksum(const char *data, size_t length, uint8_t *checksum)
+{
+    size_t i;
+    *checksum = 0;
+    for (i = 0; i < length && data[i] != '*' && data[i] != '$' && data[i] != '\r' && data[i] != '\n'; i++)
+        *checksum ^= (uint8_t) data[i];
+    return i;
+}
+
+// Byte by byte reference of gps_nmea_scan_field()
+static size_t reference_field(const char *data, size_t length)
+{
+    size_t i;
+    for (i = 0; i < length && data[i] != ',' && data[i] != '*'; i++)
+        ;
+    return i;
+}
+
+/**
+ * @brief The block kernels agree with a byte loop for every delimiter position, buffer length
+ * and (mis)alignment, including delimiters in the first, last and middle byte of a block.
+ */
+TEST_CASE("Scan: kernels match the byte by byte reference", "[gps_scan]")
+{
+    const char delimiters[] = { ',', '*', '$', '\r', '\n' };
+    char buffer[80];
+
+    for (size_t d = 0; d < sizeof(delimiters); d++){
+        for (size_t offset = 0; offset < 8; offset++){
+            for (size_t position = 0; position < 48; position++){
+                for (size_t i = 0; i < sizeof(buffer); i++)
+                    buffer[i] = (char) ('A' + (i * 7) % 26);
+                buffer[offset + position] = delimiters[d];
+
+                for (size_t length = 0; length <= 64; length += 5){
+                    uint8_t expected_sum, actual_sum;
+                    size_t expected = reference_checksum(buffer + offset, length, &expected_sum);
+                    TEST_ASSERT_EQUAL(expected, gps_nmea_scan_checksum(buffer + offset, length, &actual_sum));
+                    TEST_ASSERT_EQUAL_HEX8(expected_sum, actual_sum);
+                    TEST_ASSERT_EQUAL(reference_field(buffer + offset, length), gps_nmea_scan_field(buffer + offset, length));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Scan: checksum of a full sentence body", "[gps_scan]")
+{
+    const char *gga = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+    uint8_t checksum = 0;
+
+    size_t end = gps_nmea_scan_checksum(gga + 1, strlen(gga) - 1, &checksum);
+    TEST_ASSERT_EQUAL('*', gga[1 + end]);
+    TEST_ASSERT_EQUAL_HEX8(0x75, checksum);
+    TEST_ASSERT_EQUAL(6, gps_nmea_scan_field(gga, strlen(gga)));   // first ',' after the address
+}
+
+TEST_CASE("Scan: hexadecimal checksum digits", "[gps_scan]")
+{
+    TEST_ASSERT_EQUAL(0x75, gps_nmea_hex_byte("75"));
+    TEST_ASSERT_EQUAL(0xAF, gps_nmea_hex_byte("aF"));
+    TEST_ASSERT_EQUAL(0x00, gps_nmea_hex_byte("00\r\n"));
+    TEST_ASSERT_EQUAL(-1, gps_nmea_hex_byte("7"));      // single digit, the NUL is not a digit
+    TEST_ASSERT_EQUAL(-1, gps_nmea_hex_byte(""));       // second byte is not read
+    TEST_ASSERT_EQUAL(-1, gps_nmea_hex_byte("G1"));
+    TEST_ASSERT_EQUAL(-1, gps_nmea_hex_digit('g'));
+}
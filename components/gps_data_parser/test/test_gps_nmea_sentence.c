@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_nmea_sentence.h"
+
+// Parses a sentence literal without its CRLF
+static int parse_sentence(gps_parser_ctx_t *ctx, const char *sentence, gps_nmea_msg_t *msg)
+{
+    return gps_nmea_sentence_parse(ctx, sentence, strlen(sentence), msg);
+}
+
+/**
+ * @brief Address fields of every supported talker and sentence type are resolved,
+ * unsupported ones are rejected.
+ */
+TEST_CASE("Sentence identify: talkers and types", "[gps_sentence]")
+{
+    gps_talker_t talker;
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GGA, gps_nmea_sentence_identify("GPGGA", &talker));
+    TEST_ASSERT_EQUAL(GPS_TALKER_GP, talker);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GGA, gps_nmea_sentence_identify("GNGGA", &talker));
+    TEST_ASSERT_EQUAL(GPS_TALKER_GN, talker);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_RMC, gps_nmea_sentence_identify("GLRMC", &talker));
+    TEST_ASSERT_EQUAL(GPS_TALKER_GL, talker);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GSA, gps_nmea_sentence_identify("GAGSA", &talker));
+    TEST_ASSERT_EQUAL(GPS_TALKER_GA, talker);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GSV, gps_nmea_sentence_identify("GBGSV", &talker));
+    TEST_ASSERT_EQUAL(GPS_TALKER_GB, talker);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_VTG, gps_nmea_sentence_identify("GPVTG", NULL));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GLL, gps_nmea_sentence_identify("GPGLL", NULL));
+
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, gps_nmea_sentence_identify("GPGBS", &talker)); // unsupported type
+    TEST_ASSERT_EQUAL(GPS_TALKER_UNKNOWN, talker);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, gps_nmea_sentence_identify("BDGGA", NULL)); // unsupported talker
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, gps_nmea_sentence_identify("GXGGA", NULL));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, gps_nmea_sentence_identify("GPGG", NULL));  // too short
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, gps_nmea_sentence_identify("", NULL));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, gps_nmea_sentence_identify(NULL, NULL));
+}
+
+/**
+ * @brief A GN talker GGA is found by gps_data_parse() and decoded by the dispatcher.
+ */
+TEST_CASE("Sentence parse: GNGGA", "[gps_sentence]")
+{
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_nmea_msg_t msg;
+    gps_parser_init(&ctx);
+
+    TEST_ASSERT_EQUAL(0, gps_data_parse(&ctx, "$GNRMC,1*00\r\n$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*6B\r\n", &data));
+    TEST_ASSERT_EQUAL_FLOAT(53.36134, data.latitude);
+
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*6B", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GGA, msg.type);
+    TEST_ASSERT_EQUAL(GPS_TALKER_GN, msg.talker);
+    TEST_ASSERT_EQUAL_FLOAT(-6.505618, msg.data.gga.longitude);
+    TEST_ASSERT_EQUAL_FLOAT(61.7, msg.data.gga.altitude);
+
+    // the GGA field selection of the context applies to the dispatcher too
+    ctx.gga_fields = GPS_GGA_FIELD_FIX_QUALITY;
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*6B", &msg));
+    TEST_ASSERT_EQUAL(1, msg.data.gga.fix_quality);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LONGITUDE, msg.data.gga.longitude);
+}
+
+/**
+ * @brief RMC sentences date themselves and the sentences after them, across midnight; the receive
+ * times set in the context are copied to every result.
+ */
+TEST_CASE("Sentence parse: UTC epoch and receive times", "[gps_sentence]")
+{
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msg;
+    gps_parser_init(&ctx);
+
+    // no date known yet
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75", &msg));
+    TEST_ASSERT_EQUAL_INT64(DEFAULT_UTC_MS, msg.data.gga.utc_ms);
+    TEST_ASSERT_EQUAL(0, msg.rx_time.first_us);
+
+    // 2011-05-28 09:27:50 UTC, the GGA of the next second is dated by it
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43", &msg));
+    TEST_ASSERT_EQUAL_INT64(1306574870000LL, msg.data.rmc.utc_ms);
+    ctx.rx_time.first_us = 1000;
+    ctx.rx_time.last_us = 1250;
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75", &msg));
+    TEST_ASSERT_EQUAL_INT64(1306574871000LL, msg.data.gga.utc_ms);
+    TEST_ASSERT_EQUAL_INT64(1000, msg.rx_time.first_us);
+    TEST_ASSERT_EQUAL_INT64(1250, msg.rx_time.last_us);
+    TEST_ASSERT_EQUAL_INT64(1250, msg.data.gga.rx_time.last_us);
+
+    // the GGA just after midnight arrives before the RMC of the new day, 2024-02-29 is a leap day
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPRMC,235959.500,A,5321.6802,N,00630.3372,W,0.02,31.66,290224,,,A*4E", &msg));
+    TEST_ASSERT_EQUAL_INT64(1709251199500LL, msg.data.rmc.utc_ms);
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPGGA,000000.250,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*7A", &msg));
+    TEST_ASSERT_EQUAL_INT64(1709251200250LL, msg.data.gga.utc_ms);
+    TEST_ASSERT_EQUAL(5, msg.data.gga.time.hour);
+}
+
+/**
+ * @brief RMC, GSA, GSV, VTG and GLL sentences are decoded into their own structures.
+ */
+TEST_CASE("Sentence parse: RMC GSA GSV VTG GLL", "[gps_sentence]")
+{
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msg;
+    gps_parser_init(&ctx);
+
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_RMC, msg.type);
+    TEST_ASSERT_EQUAL('A', msg.data.rmc.status);
+    TEST_ASSERT_EQUAL_FLOAT(53.36134, msg.data.rmc.latitude);
+    TEST_ASSERT_EQUAL_FLOAT(-6.50562, msg.data.rmc.longitude);
+    TEST_ASSERT_EQUAL_FLOAT(0.02, msg.data.rmc.speed_knots);
+    TEST_ASSERT_EQUAL_FLOAT(31.66, msg.data.rmc.course);
+    TEST_ASSERT_EQUAL(28, msg.data.rmc.date.day);
+    TEST_ASSERT_EQUAL(5, msg.data.rmc.date.month);
+    TEST_ASSERT_EQUAL(2011, msg.data.rmc.date.year);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_MAGNETIC_VARIATION, msg.data.rmc.magnetic_variation);
+    TEST_ASSERT_EQUAL('A', msg.data.rmc.mode);
+
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GSA, msg.type);
+    TEST_ASSERT_EQUAL('A', msg.data.gsa.selection_mode);
+    TEST_ASSERT_EQUAL(3, msg.data.gsa.fix_type);
+    TEST_ASSERT_EQUAL(10, msg.data.gsa.satellite_prn[0]);
+    TEST_ASSERT_EQUAL(13, msg.data.gsa.satellite_prn[7]);
+    TEST_ASSERT_EQUAL(DEFAULT_SATELLITE_VALUE, msg.data.gsa.satellite_prn[8]);
+    TEST_ASSERT_EQUAL_FLOAT(1.72, msg.data.gsa.pdop);
+    TEST_ASSERT_EQUAL_FLOAT(1.03, msg.data.gsa.hdop);
+    TEST_ASSERT_EQUAL_FLOAT(1.38, msg.data.gsa.vdop);
+
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GSV, msg.type);
+    TEST_ASSERT_EQUAL(3, msg.data.gsv.total_messages);
+    TEST_ASSERT_EQUAL(11, msg.data.gsv.satellites_in_view);
+    TEST_ASSERT_EQUAL(3, msg.data.gsv.satellite_count);
+    TEST_ASSERT_EQUAL(29, msg.data.gsv.satellites[0].prn);
+    TEST_ASSERT_EQUAL(301, msg.data.gsv.satellites[0].azimuth);
+    TEST_ASSERT_EQUAL(DEFAULT_SATELLITE_VALUE, msg.data.gsv.satellites[1].snr);
+    TEST_ASSERT_EQUAL(36, msg.data.gsv.satellites[2].prn);
+    TEST_ASSERT_EQUAL(DEFAULT_SATELLITE_VALUE, msg.data.gsv.satellites[3].prn);
+
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GPVTG,31.66,T,,M,0.02,N,0.04,K,A*09", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_VTG, msg.type);
+    TEST_ASSERT_EQUAL_FLOAT(31.66, msg.data.vtg.course_true);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_COURSE, msg.data.vtg.course_magnetic);
+    TEST_ASSERT_EQUAL_FLOAT(0.04, msg.data.vtg.speed_kmh);
+    TEST_ASSERT_EQUAL('A', msg.data.vtg.mode);
+
+    TEST_ASSERT_EQUAL(0, parse_sentence(&ctx, "$GNGLL,5321.6802,N,00630.3372,W,092750.000,A,A*55", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GLL, msg.type);
+    TEST_ASSERT_EQUAL(GPS_TALKER_GN, msg.talker);
+    TEST_ASSERT_EQUAL_FLOAT(53.36134, msg.data.gll.latitude);
+    TEST_ASSERT_EQUAL('W', msg.data.gll.lon_direction);
+    TEST_ASSERT_EQUAL(27, msg.data.gll.time.minute);
+    TEST_ASSERT_EQUAL('A', msg.data.gll.status);
+
+    // unsupported sentence and wrong field count
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_UNSUPPORTED, parse_sentence(&ctx, "$GNGBS,170556.00,3.0,2.9,8.3,,,,*5C", &msg));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_UNKNOWN, msg.type);
+    TEST_ASSERT_EQUAL(GPS_PARSE_ERR_FIELD_COUNT, parse_sentence(&ctx, "$GPGLL,5321.6802,N*39", &msg));
+}
+
+/**
+ * @brief Every valid sentence of a one second UART block is returned by a single batch call,
+ * corrupted sentences are skipped.
+ */
+TEST_CASE("Batch parse: all sentences of a buffer", "[gps_sentence]")
+{
+    // stream5 of main.c: noise, GGA, GSA, a GSV interrupted by a '$', GSV and a corrupted GSV
+    const char buffer[] = ",09275,,,,,,,,,,ewrwer,sdfvzx,453453635,41,,,A*43\r\n"
+                          "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n"
+                          "  $GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n"
+                          "$GPGSV,AIZAZ UABID HASHMI   59,290,20,08,54$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76\r\n"
+                          " $GPGSV,3,3,11,29,09,3JDSAFNJKDASFDSC01,24,16,09,020,,36,,,*76\r\n";
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msgs[8];
+    size_t consumed = 0;
+    gps_parser_init(&ctx);
+
+    TEST_ASSERT_EQUAL(3, gps_nmea_parse_batch(&ctx, buffer, strlen(buffer), msgs, 8, &consumed));
+    TEST_ASSERT_EQUAL(strlen(buffer), consumed);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GGA, msgs[0].type);
+    TEST_ASSERT_EQUAL_FLOAT(61.7, msgs[0].data.gga.altitude);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GSA, msgs[1].type);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GSV, msgs[2].type);
+    TEST_ASSERT_EQUAL(29, msgs[2].data.gsv.satellites[0].prn);
+}
+
+/**
+ * @brief A full output array and an incomplete trailing sentence stop the batch at the right offset.
+ */
+TEST_CASE("Batch parse: consumed offset", "[gps_sentence]")
+{
+    const char rmc[] = "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43\r\n";
+    const char gga[] = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+    char buffer[256];
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msgs[2];
+    size_t consumed = 0;
+    gps_parser_init(&ctx);
+
+    // array full after the first sentence
+    snprintf(buffer, sizeof(buffer), "%s%s", rmc, gga);
+    TEST_ASSERT_EQUAL(1, gps_nmea_parse_batch(&ctx, buffer, strlen(buffer), msgs, 1, &consumed));
+    TEST_ASSERT_EQUAL(strlen(rmc), consumed);
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_RMC, msgs[0].type);
+
+    // the rest of the buffer gives the second sentence
+    TEST_ASSERT_EQUAL(1, gps_nmea_parse_batch(&ctx, buffer + consumed, strlen(buffer) - consumed, msgs, 2, &consumed));
+    TEST_ASSERT_EQUAL(GPS_SENTENCE_GGA, msgs[0].type);
+    TEST_ASSERT_EQUAL(strlen(gga), consumed);
+
+    // a sentence cut before its CRLF is left for the next read
+    TEST_ASSERT_EQUAL(1, gps_nmea_parse_batch(&ctx, buffer, strlen(buffer) - 1, msgs, 2, &consumed));
+    TEST_ASSERT_EQUAL(strlen(rmc), consumed);
+    TEST_ASSERT_EQUAL(0, gps_nmea_parse_batch(&ctx, gga, 20, msgs, 2, &consumed));
+    TEST_ASSERT_EQUAL(0, consumed);
+
+    // no room for a sentence: the buffer is left untouched
+    consumed = 1;
+    TEST_ASSERT_EQUAL(0, gps_nmea_parse_batch(&ctx, buffer, strlen(buffer), msgs, 0, &consumed));
+    TEST_ASSERT_EQUAL(0, consumed);
+}
+
+/**
+ * @brief gps_nmea_parse_next() reports the outcome of every sentence of a buffer in order.
+ */
+TEST_CASE("Parse next: outcome of each sentence", "[gps_sentence]")
+{
+    const char buffer[] =
+        "noise$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n"   // ok
+        "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76\r\n"        // wrong checksum
+        "$GPGLL,5321.6802,N*39\r\n"                                                         // wrong field count
+        "$GNGBS,170556.00,3.0,2.9,8.3,,,,*5C\r\n"                                           // unsupported
+        "$GPGGA,092751.000\r\n"                                                             // no checksum
+        "$GPGGA,092751.000,53";                                                             // incomplete
+    const gps_parse_result_t expected[] = {
+        GPS_PARSE_OK, GPS_PARSE_ERR_CHECKSUM, GPS_PARSE_ERR_FIELD_COUNT, GPS_PARSE_ERR_UNSUPPORTED,
+        GPS_PARSE_ERR_FORMAT, GPS_PARSE_INCOMPLETE,
+    };
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msg;
+    size_t offset = 0;
+    gps_parser_init(&ctx);
+
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+        TEST_ASSERT_EQUAL(expected[i], gps_nmea_parse_next(&ctx, buffer, sizeof(buffer) - 1, &offset, &msg));
+    TEST_ASSERT_EQUAL('$', buffer[offset]);
+    TEST_ASSERT_EQUAL(sizeof(buffer) - 1 - strlen("$GPGGA,092751.000,53"), offset);
+
+    offset = sizeof(buffer) - 1;
+    TEST_ASSERT_EQUAL(GPS_PARSE_INCOMPLETE, gps_nmea_parse_next(&ctx, buffer, sizeof(buffer) - 1, &offset, &msg));
+}
+
+/**
+ * @brief The counters of a context add up the outcome of every sentence, a reset restarts them from zero.
+ */
+TEST_CASE("Parser stats: counters per outcome", "[gps_sentence]")
+{
+    const char buffer[] =
+        "noise$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n"   // ok
+        "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76\r\n"        // wrong checksum
+        "$GPGLL,5321.6802,N*39\r\n"                                                         // wrong field count
+        "$GNGBS,170556.00,3.0,2.9,8.3,,,,*5C\r\n"                                           // unsupported
+        "$GPGGA,092751.000\r\n"                                                             // no checksum
+        "$GPGGA,092751.000,9921.6802,N,00630.3371,W,X,8,1.03,61.7,M,55.3,M,,*1A\r\n"        // latitude and quality invalid
+        "$GPGGA,092751.000,53";                                                             // incomplete
+    gps_parser_ctx_t ctx;
+    gps_parser_stats_t stats;
+    gps_nmea_msg_t msgs[4];
+    size_t consumed = 0;
+    gps_parser_init(&ctx);
+
+    TEST_ASSERT_EQUAL(2, gps_nmea_parse_batch(&ctx, buffer, sizeof(buffer) - 1, msgs, 4, &consumed));
+    gps_parser_stats_snapshot(&ctx, &stats);
+    TEST_ASSERT_EQUAL(consumed, stats.value[GPS_STAT_BYTES]);
+    TEST_ASSERT_EQUAL(2, stats.value[GPS_STAT_GGA]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_GLL]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_UNSUPPORTED]);
+    TEST_ASSERT_EQUAL(0, stats.value[GPS_STAT_RMC]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_CHECKSUM_ERRORS]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_FORMAT_ERRORS]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_FIELD_COUNT_ERRORS]);
+    TEST_ASSERT_EQUAL(2, stats.value[GPS_STAT_FIELD_ERRORS]);
+
+    // the rest of the buffer is counted once it is complete, framed sentences count no bytes
+    gps_parser_stats_reset(&ctx);
+    gps_parser_stats_snapshot(&ctx, &stats);
+    for (int i = 0; i < GPS_STAT_COUNT; i++)
+        TEST_ASSERT_EQUAL(0, stats.value[i]);
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, parse_sentence(&ctx, "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43", &msgs[0]));
+    gps_parser_stats_snapshot(&ctx, &stats);
+    TEST_ASSERT_EQUAL(0, stats.value[GPS_STAT_BYTES]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_RMC]);
+
+    TEST_ASSERT_EQUAL_STRING("bytes", gps_parser_stat_name(GPS_STAT_BYTES));
+    TEST_ASSERT_EQUAL_STRING("checksum_errors", gps_parser_stat_name(GPS_STAT_CHECKSUM_ERRORS));
+    TEST_ASSERT_EQUAL_STRING("field_errors", gps_parser_stat_name(GPS_STAT_FIELD_ERRORS));
+    TEST_ASSERT_EQUAL_STRING("", gps_parser_stat_name(GPS_STAT_COUNT));
+}
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_nmea_stream.h"
+
+// Collects the sentences emitted by the framer
+typedef struct {
+    int count;
+    char last[GPS_NMEA_MAX_SENTENCE_LEN + 1];
+} sentence_sink_t;
+
+static void sink_sentence(const char *sentence, size_t length, void *user_ctx)
+{
+    sentence_sink_t *sink = (sentence_sink_t *) user_ctx;
+    TEST_ASSERT_EQUAL(strlen(sentence), length);
+    memcpy(sink->last, sentence, length + 1);
+    sink->count++;
+}
+
+/**
+ * @brief A GGA sentence split over several UART reads is reassembled and emitted once,
+ * when its CRLF arrives.
+ */
+TEST_CASE("Stream: sentence split across reads", "[gps_stream]")
+{
+    const char *gga = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+    size_t gga_length = strlen(gga);
+    sentence_sink_t sink = { 0 };
+    gps_nmea_stream_t stream;
+    gps_nmea_stream_init(&stream, sink_sentence, &sink);
+
+    // feed one byte at a time, nothing may be emitted before the final '\n'
+    for (size_t i = 0; i + 1 < gga_length; i++) {
+        TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed(&stream, gga + i, 1));
+    }
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed(&stream, gga + gga_length - 1, 1));
+    TEST_ASSERT_EQUAL(1, sink.count);
+    TEST_ASSERT_EQUAL_STRING_LEN(gga, sink.last, gga_length - 2);
+
+    // the emitted sentence can be decoded without searching or checksumming again
+    gps_parser_ctx_t ctx;
+    gps_data_parse_t data;
+    gps_parser_init(&ctx);
+    TEST_ASSERT_EQUAL(0, gps_gga_sentence_parse(&ctx, sink.last, strlen(sink.last), &data));
+    TEST_ASSERT_EQUAL_FLOAT(53.36134, data.latitude);
+    TEST_ASSERT_EQUAL_INT(1, data.fix_quality);
+}
+
+/**
+ * @brief Several sentences in one chunk, garbage between them and bad checksums.
+ */
+TEST_CASE("Stream: multiple sentences, noise and bad checksum", "[gps_stream]")
+{
+    const char chunk1[] = "junk,,*43\r\n$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43\r\n$GPGGA,092751.000,53";
+    const char chunk2[] = "21.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76\r\n";
+    sentence_sink_t sink = { 0 };
+    gps_nmea_stream_t stream;
+    gps_nmea_stream_init(&stream, sink_sentence, &sink);
+
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed(&stream, chunk1, strlen(chunk1))); // RMC
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed(&stream, chunk2, strlen(chunk2))); // GGA, second GGA has a wrong checksum
+    TEST_ASSERT_EQUAL(2, sink.count);
+    TEST_ASSERT_EQUAL_STRING("$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75", sink.last);
+
+    // missing checksum and missing CRLF are discarded, a '$' restarts framing
+    const char chunk3[] = "$GPGGA,1,2,3\r\n$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75$GNGBS,170556.00,3.0,2.9,8.3,,,,*5C\r\n";
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed(&stream, chunk3, strlen(chunk3)));
+    TEST_ASSERT_EQUAL_STRING("$GNGBS,170556.00,3.0,2.9,8.3,,,,*5C", sink.last);
+
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed(&stream, NULL, 10));
+}
+
+/**
+ * @brief Sentences longer than GPS_NMEA_MAX_SENTENCE_LEN are dropped without overflowing.
+ */
+TEST_CASE("Stream: oversized sentence", "[gps_stream]")
+{
+    char packet[GPS_NMEA_MAX_SENTENCE_LEN * 2];
+    memset(packet, 'A', sizeof(packet));
+    packet[0] = '$';
+    sentence_sink_t sink = { 0 };
+    gps_nmea_stream_t stream;
+    gps_nmea_stream_init(&stream, sink_sentence, &sink);
+
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed(&stream, packet, sizeof(packet)));
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed(&stream, "*00\r\n", 5));
+    TEST_ASSERT_EQUAL(0, sink.count);
+}
+
+/**
+ * @brief Sentences fed with gps_nmea_stream_feed_at() carry the times of the reads holding their first and last bytes.
+ */
+TEST_CASE("Stream: receive times", "[gps_stream]")
+{
+    const char *gga = "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n";
+    size_t gga_length = strlen(gga);
+    sentence_sink_t sink = { 0 };
+    gps_nmea_stream_t stream;
+    gps_nmea_stream_init(&stream, sink_sentence, &sink);
+
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed_at(&stream, "noise", 5, 500));
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed_at(&stream, gga, 20, 1000));
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed_at(&stream, gga + 20, 30, 2000));
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed_at(&stream, gga + 50, gga_length - 50, 3000));
+    TEST_ASSERT_EQUAL_INT64(1000, stream.rx_time.first_us);
+    TEST_ASSERT_EQUAL_INT64(3000, stream.rx_time.last_us);
+
+    // a whole sentence in one read, then plain feeds leave the times unknown
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed_at(&stream, gga, gga_length, 4000));
+    TEST_ASSERT_EQUAL_INT64(4000, stream.rx_time.first_us);
+    TEST_ASSERT_EQUAL_INT64(4000, stream.rx_time.last_us);
+    TEST_ASSERT_EQUAL(1, gps_nmea_stream_feed(&stream, gga, gga_length));
+    TEST_ASSERT_EQUAL_INT64(0, stream.rx_time.first_us);
+    TEST_ASSERT_EQUAL(3, sink.count);
+}
+
+/**
+ * @brief A stream with a statistics context counts the bytes fed and the sentences it drops.
+ */
+TEST_CASE("Stream: statistics context", "[gps_stream]")
+{
+    const char chunk[] = "junk$GPGGA,1,2,3\r\n"
+                         "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n"
+                         "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*76\r\n"
+                         "$GPGGA,092751.000$GNGBS,170556.00,3.0,2.9,8.3,,,,*5C\r\n";
+    sentence_sink_t sink = { 0 };
+    gps_parser_ctx_t ctx;
+    gps_parser_stats_t stats;
+    gps_nmea_stream_t stream;
+    gps_parser_init(&ctx);
+    gps_nmea_stream_init(&stream, sink_sentence, &sink);
+    TEST_ASSERT_NULL(stream.stats_ctx);
+    stream.stats_ctx = &ctx;
+
+    // no checksum, ok, wrong checksum, interrupted by a '$', ok
+    TEST_ASSERT_EQUAL(0, gps_nmea_stream_feed(&stream, chunk, 30));
+    TEST_ASSERT_EQUAL(2, gps_nmea_stream_feed(&stream, chunk + 30, strlen(chunk) - 30));
+    gps_parser_stats_snapshot(&ctx, &stats);
+    TEST_ASSERT_EQUAL(strlen(chunk), stats.value[GPS_STAT_BYTES]);
+    TEST_ASSERT_EQUAL(1, stats.value[GPS_STAT_CHECKSUM_ERRORS]);
+    TEST_ASSERT_EQUAL(2, stats.value[GPS_STAT_FORMAT_ERRORS]);
+    TEST_ASSERT_EQUAL(0, stats.value[GPS_STAT_GGA]);
+}
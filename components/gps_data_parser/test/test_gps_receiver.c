@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_receiver.h"
+
+#define RECEIVERS   3
+#define EPOCHS      120
+
+// Fixes of one receiver, in the order they were published
+typedef struct {
+    int count;
+    int ordered;
+    int last_second;
+    float latitude;
+} fix_log_t;
+
+static void log_fix(const gps_fix_t *fix, void *user_ctx)
+{
+    fix_log_t *log = (fix_log_t *) user_ctx;
+    int second = fix->time.minute * 60 + fix->time.second;
+    if (log->count > 0 && second != log->last_second + 1)
+        log->ordered = 0;
+    log->last_second = second;
+    log->latitude = fix->latitude;
+    log->count++;
+}
+
+// Writes a GGA of second n of receiver r, with a latitude identifying the receiver
+static int format_gga(char *buffer, size_t size, int r, int n)
+{
+    char body[96];
+    uint8_t checksum = 0;
+    snprintf(body, sizeof(body), "GPGGA,09%02d%02d.000,%02d21.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,",
+             n / 60, n % 60, 50 + r);
+    for (const char *c = body; *c != '\0'; c++)
+        checksum ^= (uint8_t) *c;
+    return snprintf(buffer, size, "$%s*%02X\r\n", body, checksum);
+}
+
+/**
+ * @brief Receivers fed in interleaved small chunks keep fully independent state, polled by the caller or by pool workers,
+ * and every receiver gets its fixes in order. Bytes written between gps_receiver_pool_add() and gps_receiver_pool_start()
+ * wake no worker and are parsed once the pool runs.
+ */
+TEST_CASE("Receiver: independent receivers polled and in a worker pool", "[gps_receiver]")
+{
+    static char storage[RECEIVERS][16384];
+    static gps_receiver_t rx[RECEIVERS];
+    fix_log_t log[RECEIVERS];
+    gps_receiver_pool_t pool;
+    char gga[96];
+
+    for (int pass = 0; pass < 2; pass++){
+        memset(log, 0, sizeof(log));
+        for (int r = 0; r < RECEIVERS; r++){
+            log[r].ordered = 1;
+            TEST_ASSERT_EQUAL(0, gps_receiver_init(&rx[r], storage[r], sizeof(storage[r]), GPS_FIX_SOURCE(GPS_SENTENCE_GGA), log_fix, &log[r]));
+        }
+        if (pass == 1){
+            TEST_ASSERT_EQUAL(0, gps_receiver_pool_init(&pool, 2));
+            for (int r = 0; r < RECEIVERS; r++)
+                TEST_ASSERT_EQUAL(r % 2, gps_receiver_pool_add(&pool, &rx[r]));
+            TEST_ASSERT_EQUAL(-1, gps_receiver_pool_add(&pool, &rx[0]));
+            TEST_ASSERT_NULL(rx[0].worker);
+        }
+
+        // chunks of 7 bytes, every receiver in turn, the sentences of one receiver split at different places
+        for (int n = 0; n < EPOCHS; n++){
+            if (pass == 1 && n == EPOCHS / 2){
+                TEST_ASSERT_EQUAL(0, log[0].count);
+                TEST_ASSERT_EQUAL(0, gps_receiver_pool_start(&pool));
+            }
+            for (int r = 0; r < RECEIVERS; r++){
+                int length = format_gga(gga, sizeof(gga), r, n);
+                for (int i = 0; i < length; i += 7)
+                    TEST_ASSERT_EQUAL((length - i < 7) ? length - i : 7, gps_receiver_write(&rx[r], gga + i, (length - i < 7) ? length - i : 7));
+                if (pass == 0 && (n + r) % 3 == 0)
+                    gps_receiver_poll(&rx[r]);
+            }
+        }
+        if (pass == 0){
+            for (int r = 0; r < RECEIVERS; r++)
+                gps_receiver_poll(&rx[r]);
+        }
+        else{
+            gps_receiver_pool_stop(&pool);
+            TEST_ASSERT_NULL(rx[0].worker);
+            TEST_ASSERT_NULL(rx[0].pool);
+        }
+
+        for (int r = 0; r < RECEIVERS; r++){
+            gps_parser_stats_t stats;
+            // GGA alone completes an epoch
+            TEST_ASSERT_EQUAL(EPOCHS, log[r].count);
+            TEST_ASSERT_EQUAL(1, log[r].ordered);
+            TEST_ASSERT_FLOAT_WITHIN(1e-3, 50 + r + 21.6802 / 60, log[r].latitude);
+            gps_parser_stats_snapshot(&rx[r].ctx, &stats);
+            TEST_ASSERT_EQUAL(EPOCHS, stats.value[GPS_STAT_GGA]);
+            TEST_ASSERT_EQUAL(atomic_load(&rx[r].ring.tail), stats.value[GPS_STAT_BYTES]);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(-1, gps_receiver_pool_init(&pool, 0));
+    TEST_ASSERT_EQUAL(-1, gps_receiver_pool_init(&pool, GPS_RECEIVER_MAX_WORKERS + 1));
+    TEST_ASSERT_EQUAL(-1, gps_receiver_init(&rx[0], storage[0], 1000, GPS_EPOCH_DEFAULT_REQUIRED, NULL, NULL));
+}
@@ -0,0 +1,164 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "gps_data_parser.h"
+#include "gps_track_simplify.h"
+
+#define METRES_PER_E7   0.0111194926
+
+// Collects the indices of the points passed on, the index of a fix is kept in dgps_station_id
+typedef struct {
+    int count;
+    int index[512];
+} point_sink_t;
+
+static void sink_point(const gps_data_parse_t *fix, void *user_ctx)
+{
+    point_sink_t *sink = (point_sink_t *) user_ctx;
+    if (sink->count < 512)
+        sink->index[sink->count] = fix->dgps_station_id;
+    sink->count++;
+}
+
+// A fix at north / east metres from 53.36 N 6.5 W
+static gps_data_parse_t fix_at(int index, double north, double east)
+{
+    gps_data_parse_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.latitude_e7 = 533600000 + (int32_t) lround(north / METRES_PER_E7);
+    fix.longitude_e7 = -65000000 + (int32_t) lround(east / (METRES_PER_E7 * cos(53.36 * M_PI / 180)));
+    fix.dgps_station_id = index;
+    return fix;
+}
+
+// Distance in metres from fix p to the segment from a to b
+static double segment_distance(const gps_data_parse_t *p, const gps_data_parse_t *a, const gps_data_parse_t *b)
+{
+    double scale = cos(53.36 * M_PI / 180);
+    double bx = (b->longitude_e7 - a->longitude_e7) * METRES_PER_E7 * scale, by = (b->latitude_e7 - a->latitude_e7) * METRES_PER_E7;
+    double px = (p->longitude_e7 - a->longitude_e7) * METRES_PER_E7 * scale, py = (p->latitude_e7 - a->latitude_e7) * METRES_PER_E7;
+    double length_squared = bx * bx + by * by;
+    double t = (length_squared > 0) ? (px * bx + py * by) / length_squared : 0;
+    t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    return hypot(px - t * bx, py - t * by);
+}
+
+/**
+ * @brief A straight road with receiver noise is reduced to its end points, a turn adds its corner.
+ */
+TEST_CASE("Track simplify: straight road and turn", "[gps_track_simplify]")
+{
+    point_sink_t sink = { 0 };
+    gps_track_simplify_t simplify;
+
+    gps_track_simplify_init(&simplify, 5.0f, sink_point, &sink);
+    for (int i = 0; i < 100; i++){
+        gps_data_parse_t fix = fix_at(i, i * 8.0 + ((i * 7) % 5) - 2, i * 6.0 + ((i * 3) % 5) - 2);
+        TEST_ASSERT_EQUAL(i == 0, gps_track_simplify_add(&simplify, &fix));
+    }
+    TEST_ASSERT_EQUAL(1, gps_track_simplify_flush(&simplify));
+    TEST_ASSERT_EQUAL(0, gps_track_simplify_flush(&simplify));
+    TEST_ASSERT_EQUAL(2, sink.count);
+    TEST_ASSERT_EQUAL(99, sink.index[1]);
+
+    // 50 fixes east, then 50 north: the corner is kept
+    sink.count = 0;
+    gps_track_simplify_init(&simplify, 2.0f, sink_point, &sink);
+    for (int i = 0; i < 100; i++){
+        gps_data_parse_t fix = (i < 50) ? fix_at(i, 0, i * 10.0) : fix_at(i, (i - 49) * 10.0, 490);
+        gps_track_simplify_add(&simplify, &fix);
+    }
+    gps_track_simplify_flush(&simplify);
+    TEST_ASSERT_EQUAL(3, sink.count);
+    TEST_ASSERT_EQUAL(0, sink.index[0]);
+    TEST_ASSERT_EQUAL(49, sink.index[1]);
+    TEST_ASSERT_EQUAL(99, sink.index[2]);
+    TEST_ASSERT_EQUAL(100, simplify.fixes_in);
+    TEST_ASSERT_EQUAL(3, simplify.points_out);
+}
+
+/**
+ * @brief Every dropped fix of a curved track stays within the tolerance of the simplified track.
+ */
+TEST_CASE("Track simplify: error bound on a curve", "[gps_track_simplify]")
+{
+    static gps_data_parse_t fixes[720];
+    point_sink_t sink = { 0 };
+    gps_track_simplify_t simplify;
+
+    gps_track_simplify_init(&simplify, 3.0f, sink_point, &sink);
+    for (int i = 0; i < 720; i++){
+        double angle = i * M_PI / 360;
+        double radius = 300 + 100 * sin(angle * 3);
+        fixes[i] = fix_at(i, radius * sin(angle), radius * cos(angle));
+        gps_track_simplify_add(&simplify, &fixes[i]);
+    }
+    gps_track_simplify_flush(&simplify);
+    TEST_ASSERT_LESS_THAN(720 / 5, sink.count);
+    TEST_ASSERT_EQUAL(0, sink.index[0]);
+    TEST_ASSERT_EQUAL(719, sink.index[sink.count - 1]);
+
+    for (int k = 0; k + 1 < sink.count; k++){
+        for (int i = sink.index[k]; i <= sink.index[k + 1]; i++)
+            TEST_ASSERT_TRUE(segment_distance(&fixes[i], &fixes[sink.index[k]], &fixes[sink.index[k + 1]]) <= 3.01);
+    }
+}
+
+/**
+ * @brief A track doubling back on itself keeps its turning point.
+ */
+TEST_CASE("Track simplify: out and back", "[gps_track_simplify]")
+{
+    static const double east[] = { 0, 11, 22, 33, 44, 55, 100, 50, 44 };
+    gps_data_parse_t fixes[9];
+    point_sink_t sink = { 0 };
+    gps_track_simplify_t simplify;
+
+    gps_track_simplify_init(&simplify, 5.0f, sink_point, &sink);
+    for (int i = 0; i < 9; i++){
+        fixes[i] = fix_at(i, 0, east[i]);
+        gps_track_simplify_add(&simplify, &fixes[i]);
+    }
+    gps_track_simplify_flush(&simplify);
+    TEST_ASSERT_EQUAL(3, sink.count);
+    TEST_ASSERT_EQUAL(0, sink.index[0]);
+    TEST_ASSERT_EQUAL(6, sink.index[1]);
+    TEST_ASSERT_EQUAL(8, sink.index[2]);
+
+    for (int k = 0; k + 1 < sink.count; k++){
+        for (int i = sink.index[k]; i <= sink.index[k + 1]; i++)
+            TEST_ASSERT_TRUE(segment_distance(&fixes[i], &fixes[sink.index[k]], &fixes[sink.index[k + 1]]) <= 5.01);
+    }
+}
+
+/**
+ * @brief A receiver standing still only passes its first fix, fixes without a position are ignored.
+ */
+TEST_CASE("Track simplify: stationary receiver", "[gps_track_simplify]")
+{
+    point_sink_t sink = { 0 };
+    gps_track_simplify_t simplify;
+    gps_data_parse_t no_fix, gga;
+    gps_parser_ctx_t ctx;
+
+    gps_parser_init(&ctx);
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GNGGA,,,,,,0,00,,,M,,M,,*78\r\n", &no_fix));
+
+    gps_track_simplify_init(&simplify, 5.0f, sink_point, &sink);
+    TEST_ASSERT_EQUAL(0, gps_track_simplify_add(&simplify, &no_fix));
+    for (int i = 0; i < 600; i++){
+        gps_data_parse_t fix = fix_at(i, (((i * 13) % 7) - 3) * 0.5, (((i * 5) % 7) - 3) * 0.5);
+        gps_track_simplify_add(&simplify, &fix);
+    }
+    TEST_ASSERT_EQUAL(0, gps_track_simplify_add(&simplify, &no_fix));
+    TEST_ASSERT_EQUAL(1, sink.count);
+    TEST_ASSERT_EQUAL(600, simplify.fixes_in);
+
+    // float positions are used when no fixed-point position was decoded
+    TEST_ASSERT_EQUAL(GPS_PARSE_OK, gps_data_parse(&ctx, "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n", &gga));
+    TEST_ASSERT_EQUAL(0, gps_track_simplify_add(&simplify, &gga));
+    TEST_ASSERT_EQUAL(1, gps_track_simplify_flush(&simplify));
+    TEST_ASSERT_EQUAL(2, sink.count);
+    TEST_ASSERT_EQUAL(DEFAULT_DGPS_STATION_ID, sink.index[1]);
+}
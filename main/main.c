@@ -15,10 +15,13 @@
 
 
 #include <esp_log.h>
+#include <string.h>
 #include "gps_data_parser.h"
+#include "gps_nmea_sentence.h"
 
 #define TAG "GPS"
 void test(const char * stream, int stream_num);
+void test_batch(const char * stream, int stream_num);
 
 /**
  * @brief Entry point for the application that processes GPS data packets.
@@ -54,6 +57,7 @@ void app_main(void)
 
     const char *stream5 = ",09275,,,,,,,,,,ewrwer,sdfvzx,453453635,41,,,A*43\r\n$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n  $GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n$GPGSV,AIZAZ UABID HASHMI   59,290,20,08,54$GPGSV,3,2,11,02,39,223,16,13,28,070,17,26,SDFJDSNFJ23,252,,04,1SDJFNASJDKFSDJHDS4,186,15*77\r\n $GPGSV,3,3,11,29,09,3JDSAFNJKDASFDSC01,24,16,09,020,,36,,,*76\r\n";// corrupted packet sample but uncorrupted GGA sent by  GPS module to mcu through UART
      test(stream5,5);
+     test_batch(stream5,5);
      sleep(1);
 
    // Now testing  when stream is valid , and it is NMEA sentence and even checksum result is true but some data parameters are missing
@@ -125,3 +129,27 @@ void test(const char* stream, int stream_num)
     free(data);
 
 }
+
+/**
+ * @brief Parses every sentence of a GPS data stream in one pass.
+ *
+ * The function decodes all supported sentences of the stream with `gps_nmea_parse_batch`
+ * and prints the type of each of them.
+ *
+ * @param stream The GPS data stream to parse.
+ */
+void test_batch(const char* stream, int stream_num)
+{
+    static const char *type_names[GPS_SENTENCE_TYPE_COUNT] = { "UNKNOWN", "GGA", "RMC", "GSA", "GSV", "VTG", "GLL" };
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msgs[8];
+    size_t consumed = 0;
+
+    gps_parser_init(&ctx);
+    size_t count = gps_nmea_parse_batch(&ctx, stream, strlen(stream), msgs, 8, &consumed);
+
+    ESP_LOGI(TAG, "stream no. %d: %u sentences decoded, %u bytes consumed", stream_num, (unsigned) count, (unsigned) consumed);
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "stream no. %d sentence %u: %s", stream_num, (unsigned) i, type_names[msgs[i].type]);
+    }
+}
@@ -0,0 +1,257 @@
+/**
+ * @file gps_log_parallel.c
+ * @brief Parallel parse of a log in memory: chunks parsed by worker threads, outcomes merged in order.
+ *
+ * Chunk k is parsed into slot k % slot_count. A worker only takes chunk k once the calling
+ * thread has handed chunk k - slot_count to the callback, and the calling thread waits for the
+ * chunks in order. One mutex guards the slot states; it is taken twice per chunk, so with chunks
+ * of a megabyte the threads spend their time parsing, not waiting for each other.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gps_log_parallel.h"
+
+// Slot states
+enum {
+    SLOT_FREE = 0,
+    SLOT_BUSY,
+    SLOT_DONE,
+};
+
+typedef struct {
+    gps_parse_result_t result;
+    gps_nmea_msg_t msg;
+} parsed_sentence_t;
+
+typedef struct {
+    parsed_sentence_t *sentences;
+    size_t count;
+    size_t capacity;
+    size_t chunk;                   // chunk held by the slot
+    int state;
+
+    // The log ends inside this chunk with an incomplete sentence starting at consumed
+    int ends_log;
+    size_t consumed;
+
+    gps_parser_stats_t stats;
+} chunk_slot_t;
+
+typedef struct {
+    const gps_log_parallel_config_t *config;
+    const char *log;
+    size_t length;
+    size_t chunk_size;
+    size_t chunk_count;
+
+    chunk_slot_t *slots;
+    size_t slot_count;
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    size_t next_chunk;              // next chunk to give to a worker
+    size_t emitted;                 // chunks handed to the callback
+    int stop;                       // no more chunks are needed
+    int failed;                     // a worker ran out of memory
+} parallel_job_t;
+
+// Offset of the first '$' at or after the nominal start of chunk, the end of the log if there is none
+static size_t chunk_boundary (const parallel_job_t *job, size_t chunk)
+{
+    size_t offset = chunk * job->chunk_size;
+    if (chunk == 0 || offset >= job->length)
+        return (chunk == 0) ? 0 : job->length;
+    const char *dollar = memchr (job->log + offset, '$', job->length - offset);
+    return (dollar != NULL) ? (size_t) (dollar - job->log) : job->length;
+}
+
+// Decodes the last dated RMC sentence shortly before start, which a sequential parse would have seen last
+static void date_from_previous_rmc (gps_parser_ctx_t *ctx, const char *log, size_t start)
+{
+    size_t limit = (start > GPS_LOG_PARALLEL_DATE_LOOKBACK) ? start - GPS_LOG_PARALLEL_DATE_LOOKBACK : 0;
+    gps_nmea_msg_t msg;
+
+    for (size_t i = start; i-- > limit;){
+        if (log[i] != '$' || start - i < 7 || memcmp (log + i + 3, "RMC,", 4) != 0)
+            continue;
+        size_t offset = i;
+        if (gps_nmea_parse_next (ctx, log, start, &offset, &msg) >= GPS_PARSE_OK && msg.data.rmc.date.day != DEFAULT_DATE)
+            return;
+    }
+}
+
+static parsed_sentence_t * slot_append (chunk_slot_t *slot)
+{
+    if (slot->count == slot->capacity){
+        size_t capacity = (slot->capacity != 0) ? slot->capacity * 2 : 1024;
+        parsed_sentence_t *sentences = realloc (slot->sentences, capacity * sizeof (*sentences));
+        if (sentences == NULL)
+            return NULL;
+        slot->sentences = sentences;
+        slot->capacity = capacity;
+    }
+    return &slot->sentences[slot->count];
+}
+
+// Parses every sentence starting in chunk into slot, returns -1 if memory runs out
+static int parse_chunk (const parallel_job_t *job, gps_parser_ctx_t *ctx, chunk_slot_t *slot, size_t chunk)
+{
+    size_t end = chunk_boundary (job, chunk + 1);
+    size_t offset = chunk_boundary (job, chunk);
+
+    gps_parser_init (ctx);
+    date_from_previous_rmc (ctx, job->log, offset);
+    gps_parser_stats_reset (ctx);
+    slot->count = 0;
+    slot->ends_log = 0;
+    slot->consumed = end;
+
+    while (offset < end){
+        parsed_sentence_t *sentence = slot_append (slot);
+        if (sentence == NULL)
+            return -1;
+
+        gps_parse_result_t result = gps_nmea_parse_next (ctx, job->log, end, &offset, &sentence->msg);
+        if (result == GPS_PARSE_INCOMPLETE && offset < job->length && offset < end){
+            // cut by the boundary: the '$' starting the next chunk interrupts it, as in a sequential parse
+            result = gps_nmea_parse_next (ctx, job->log, job->length, &offset, &sentence->msg);
+        }
+        if (result == GPS_PARSE_INCOMPLETE){
+            slot->ends_log = (end == job->length || offset < end);
+            slot->consumed = offset;
+            break;
+        }
+        sentence->result = result;
+        slot->count++;
+    }
+    gps_parser_stats_snapshot (ctx, &slot->stats);
+    return 0;
+}
+
+static void * worker_thread (void *arg)
+{
+    parallel_job_t *job = (parallel_job_t *) arg;
+    gps_parser_ctx_t ctx;
+
+    pthread_mutex_lock (&job->lock);
+    for (;;)
+    {
+        // the slot of the next chunk is free once the chunk before it in that slot was emitted
+        while (!job->stop && job->next_chunk < job->chunk_count && job->next_chunk - job->emitted >= job->slot_count)
+            pthread_cond_wait (&job->changed, &job->lock);
+        if (job->stop || job->next_chunk >= job->chunk_count)
+            break;
+
+        size_t chunk = job->next_chunk++;
+        chunk_slot_t *slot = &job->slots[chunk % job->slot_count];
+        slot->chunk = chunk;
+        slot->state = SLOT_BUSY;
+        pthread_mutex_unlock (&job->lock);
+
+        int status = parse_chunk (job, &ctx, slot, chunk);
+
+        pthread_mutex_lock (&job->lock);
+        slot->state = SLOT_DONE;
+        if (status != 0)
+            job->failed = job->stop = 1;
+        pthread_cond_broadcast (&job->changed);
+    }
+    pthread_mutex_unlock (&job->lock);
+    return NULL;
+}
+
+// Hands the chunks to the callback in order as the workers complete them, returns -1 if a worker failed
+static int emit_chunks (parallel_job_t *job, gps_parser_stats_t *stats, size_t *consumed)
+{
+    for (size_t chunk = 0; chunk < job->chunk_count; chunk++){
+        chunk_slot_t *slot = &job->slots[chunk % job->slot_count];
+
+        pthread_mutex_lock (&job->lock);
+        while (!job->failed && (slot->state != SLOT_DONE || slot->chunk != chunk))
+            pthread_cond_wait (&job->changed, &job->lock);
+        int failed = job->failed;
+        pthread_mutex_unlock (&job->lock);
+        if (failed)
+            return -1;
+
+        if (job->config->callback != NULL){
+            for (size_t i = 0; i < slot->count; i++)
+                job->config->callback (slot->sentences[i].result, &slot->sentences[i].msg, job->config->user_ctx);
+        }
+        for (int i = 0; i < GPS_STAT_COUNT; i++)
+            stats->value[i] += slot->stats.value[i];
+        *consumed = slot->consumed;
+        int ends_log = slot->ends_log;
+
+        // an incomplete sentence ends the log, as it ends a sequential parse
+        pthread_mutex_lock (&job->lock);
+        slot->state = SLOT_FREE;
+        job->emitted++;
+        job->stop |= ends_log;
+        pthread_cond_broadcast (&job->changed);
+        pthread_mutex_unlock (&job->lock);
+        if (ends_log)
+            break;
+    }
+    return 0;
+}
+
+int gps_log_parse_parallel (const gps_log_parallel_config_t *config, const char *log, size_t length,
+                            gps_parser_stats_t *stats, size_t *consumed)
+{
+    parallel_job_t job = { .config = config, .log = log, .length = length };
+    gps_parser_stats_t total = { { 0 } };
+    size_t end = length;
+    pthread_t threads[64];
+    size_t started = 0;
+    int status;
+
+    size_t thread_count = config->threads;
+    if (thread_count == 0){
+        long online = sysconf (_SC_NPROCESSORS_ONLN);
+        thread_count = (online > 0) ? (size_t) online : 1;
+    }
+    if (thread_count > sizeof (threads) / sizeof (threads[0]))
+        thread_count = sizeof (threads) / sizeof (threads[0]);
+
+    job.chunk_size = (config->chunk_size != 0) ? config->chunk_size : GPS_LOG_PARALLEL_CHUNK_SIZE;
+    job.chunk_count = (length + job.chunk_size - 1) / job.chunk_size;
+    job.slot_count = 2 * thread_count;
+    job.slots = calloc (job.slot_count, sizeof (*job.slots));
+    if (job.slots == NULL)
+        return -1;
+    pthread_mutex_init (&job.lock, NULL);
+    pthread_cond_init (&job.changed, NULL);
+
+    for (; started < thread_count; started++){
+        if (pthread_create (&threads[started], NULL, worker_thread, &job) != 0)
+            break;
+    }
+    status = (started > 0) ? emit_chunks (&job, &total, &end) : -1;
+
+    pthread_mutex_lock (&job.lock);
+    job.stop = 1;
+    pthread_cond_broadcast (&job.changed);
+    pthread_mutex_unlock (&job.lock);
+    for (size_t i = 0; i < started; i++)
+        pthread_join (threads[i], NULL);
+
+    for (size_t i = 0; i < job.slot_count; i++)
+        free (job.slots[i].sentences);
+    free (job.slots);
+    pthread_cond_destroy (&job.changed);
+    pthread_mutex_destroy (&job.lock);
+
+    if (stats != NULL)
+        *stats = total;
+    if (consumed != NULL)
+        *consumed = end;
+    return status;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file gps_log_parallel.h
+ * @brief Host-side parallel parse of a large NMEA log held in memory, e.g. a memory mapped capture.
+ *
+ * The log is cut into chunks of about chunk_size bytes, each starting at a '$'. Worker threads
+ * take the chunks in turn and parse each one with gps_nmea_parse_next() into a private list of
+ * outcomes, with a parser context per thread. The calling thread hands the outcomes to the
+ * callback chunk after chunk, so the callback sees exactly the sequence a single
+ * gps_nmea_parse_next() loop over the whole log would return, while the workers parse ahead.
+ * At most two chunks per worker are held at a time, so memory does not grow with the log.
+ *
+ * A sentence cut by a chunk boundary is finished the way the sequential loop finishes it: it is
+ * interrupted by the '$' starting the next chunk. Before its first sentence, every chunk
+ * decodes the last RMC sentence before it, so that utc_ms is dated as in a sequential parse.
+ */
+#ifndef GPS_LOG_PARALLEL_H
+#define GPS_LOG_PARALLEL_H
+
+#include <stddef.h>
+
+#include "gps_data_parser.h"
+#include "gps_nmea_sentence.h"
+
+#define GPS_LOG_PARALLEL_CHUNK_SIZE     (1u << 20)      // default chunk size in bytes
+#define GPS_LOG_PARALLEL_DATE_LOOKBACK  (64u << 10)     // bytes searched back from a chunk for its RMC
+
+/**
+ * @brief Called on the calling thread for every sentence of the log, in log order.
+ *
+ * @param result Outcome of the sentence, as returned by gps_nmea_parse_next().
+ * @param msg The decoded sentence when result is not negative, only valid during the call.
+ * @param user_ctx The user_ctx of the configuration.
+ */
+typedef void (*gps_log_parallel_cb_t)(gps_parse_result_t result, const gps_nmea_msg_t *msg, void *user_ctx);
+
+typedef struct {
+    size_t threads;                     // worker threads, 0 for one per online CPU
+    size_t chunk_size;                  // bytes per chunk, 0 for GPS_LOG_PARALLEL_CHUNK_SIZE
+    gps_log_parallel_cb_t callback;     // may be NULL to only count
+    void *user_ctx;
+} gps_log_parallel_config_t;
+
+/**
+ * @brief Parses a whole log on several threads.
+ *
+ * @param config Threads, chunk size and callback.
+ * @param log The log, not necessarily NUL-terminated.
+ * @param length Length of log in bytes.
+ * @param stats Receives the counters of all the parser contexts added up, may be NULL.
+ * @param consumed Receives the offset of the incomplete sentence ending the log, length if
+ *                 there is none, may be NULL.
+ *
+ * @return 0 on success, -1 if a thread or memory could not be allocated. The callback may then
+ *         have seen the sentences of the first chunks only.
+ */
+int gps_log_parse_parallel(const gps_log_parallel_config_t *config, const char *log, size_t length,
+                           gps_parser_stats_t *stats, size_t *consumed);
+
+#endif  // GPS_LOG_PARALLEL_H
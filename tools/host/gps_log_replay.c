@@ -0,0 +1,255 @@
+/**
+ * @file gps_log_replay.c
+ * @brief Replays a raw NMEA capture through the parser, in place from a memory mapping.
+ *
+ * The log is mapped read-only and walked with gps_nmea_parse_next(), so no line is copied
+ * before the parser sees it. Decoded fixes can be printed as CSV and a summary with the
+ * throughput and the outcome of every sentence (by rejection class and by type) is written
+ * to stderr. Replay can be paced at real-time or N times real-time using the UTC time of the
+ * GGA, RMC and GLL sentences, to load-test downstream consumers. With --threads the log is
+ * parsed by gps_log_parse_parallel() on several threads, the outcomes still in log order.
+ *
+ * Usage: gps_log_replay [--print] [--realtime | --speed N] [--threads N [--chunk BYTES]] FILE
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gps_data_parser.h"
+#include "gps_log_parallel.h"
+#include "gps_nmea_sentence.h"
+
+#define MS_PER_DAY          86400000LL
+#define MAX_REPLAY_GAP_MS   60000LL     // longer gaps in the log (receiver off, log spliced) are not waited for
+
+// Index of a gps_parse_result_t in the outcome counters
+#define RESULT_INDEX(result)    ((result) - GPS_PARSE_ERR_UNSUPPORTED)
+#define RESULT_COUNT            (GPS_PARSE_INVALID_FIELD - GPS_PARSE_ERR_UNSUPPORTED + 1)
+
+typedef struct {
+    double speed;                   // 0 replays as fast as possible
+    int64_t log_ms;                 // log time elapsed since the first timed sentence
+    int last_time_ms;               // time of day of the last timed sentence, -1 before the first one
+    struct timespec start;          // wall clock time of the first timed sentence
+} replay_pacer_t;
+
+typedef struct {
+    replay_pacer_t pacer;
+    int print;
+    uint64_t results[RESULT_COUNT];
+    uint64_t types[GPS_SENTENCE_TYPE_COUNT];
+} replay_t;
+
+static const char *s_result_names[RESULT_COUNT] = {
+    [RESULT_INDEX (GPS_PARSE_ERR_UNSUPPORTED)] = "unsupported",
+    [RESULT_INDEX (GPS_PARSE_ERR_FIELD_COUNT)] = "field count",
+    [RESULT_INDEX (GPS_PARSE_ERR_CHECKSUM)] = "checksum",
+    [RESULT_INDEX (GPS_PARSE_ERR_FORMAT)] = "format",
+    [RESULT_INDEX (GPS_PARSE_OK)] = "ok",
+    [RESULT_INDEX (GPS_PARSE_INVALID_FIELD)] = "invalid field",
+};
+
+static const char *s_type_names[GPS_SENTENCE_TYPE_COUNT] = { "UNKNOWN", "GGA", "RMC", "GSA", "GSV", "VTG", "GLL" };
+
+static double seconds_since (const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Returns the time of day of a timed sentence in milliseconds, -1 for other sentences or an invalid time
+static int sentence_time_ms (const gps_nmea_msg_t *msg)
+{
+    const gps_time_t *time;
+
+    switch (msg->type){
+        case GPS_SENTENCE_GGA: time = &msg->data.gga.time; break;
+        case GPS_SENTENCE_RMC: time = &msg->data.rmc.time; break;
+        case GPS_SENTENCE_GLL: time = &msg->data.gll.time; break;
+        default: return -1;
+    }
+    if (time->hour == DEFAULT_GPS_TIME_HR)
+        return -1;
+    return ((time->hour * 60 + time->minute) * 60 + time->second) * 1000 + time->millisecond;
+}
+
+// Sleeps until the wall clock has caught up with the log time of msg divided by the speed
+static void pace (replay_pacer_t *pacer, const gps_nmea_msg_t *msg)
+{
+    int time_ms = sentence_time_ms (msg);
+    if (pacer->speed <= 0 || time_ms < 0)
+        return;
+
+    if (pacer->last_time_ms < 0){
+        clock_gettime (CLOCK_MONOTONIC, &pacer->start);
+        pacer->last_time_ms = time_ms;
+        return;
+    }
+
+    int64_t delta = time_ms - pacer->last_time_ms;
+    if (delta < 0)
+        delta += MS_PER_DAY;	// midnight
+    pacer->last_time_ms = time_ms;
+    if (delta == 0)
+        return;
+    if (delta > MAX_REPLAY_GAP_MS){
+        // restart the schedule after a gap instead of stalling
+        clock_gettime (CLOCK_MONOTONIC, &pacer->start);
+        pacer->log_ms = 0;
+        return;
+    }
+    pacer->log_ms += delta;
+
+    int64_t wall_ns = (int64_t) ((double) pacer->log_ms * 1e6 / pacer->speed);
+    struct timespec target = pacer->start;
+    target.tv_sec += (time_t) (wall_ns / 1000000000);
+    target.tv_nsec += (long) (wall_ns % 1000000000);
+    if (target.tv_nsec >= 1000000000){
+        target.tv_sec++;
+        target.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) == EINTR)
+        ;
+}
+
+// Prints a decoded position as one CSV line
+static void print_fix (const gps_nmea_msg_t *msg)
+{
+    if (msg->type == GPS_SENTENCE_GGA){
+        const gps_data_parse_t *gga = &msg->data.gga;
+        printf ("GGA,%02u:%02u:%02u.%03u,%.7f,%.7f,%.2f,%d,%d,%.2f\n",
+                gga->time.hour, gga->time.minute, gga->time.second, gga->time.millisecond,
+                gga->latitude, gga->longitude, gga->altitude, gga->fix_quality, gga->num_satellites, gga->hdop);
+    }
+    else if (msg->type == GPS_SENTENCE_RMC){
+        const gps_rmc_t *rmc = &msg->data.rmc;
+        printf ("RMC,%02u:%02u:%02u.%03u,%04u-%02u-%02u,%c,%.7f,%.7f,%.2f,%.2f\n",
+                rmc->time.hour, rmc->time.minute, rmc->time.second, rmc->time.millisecond,
+                rmc->date.year, rmc->date.month, rmc->date.day, rmc->status,
+                rmc->latitude, rmc->longitude, rmc->speed_knots, rmc->course);
+    }
+}
+
+// Counts, paces and prints the outcome of one sentence, in log order
+static void replay_sentence (gps_parse_result_t result, const gps_nmea_msg_t *msg, void *user_ctx)
+{
+    replay_t *replay = (replay_t *) user_ctx;
+
+    replay->results[RESULT_INDEX (result)]++;
+    if (result < GPS_PARSE_OK)
+        return;
+    replay->types[msg->type]++;
+    pace (&replay->pacer, msg);
+    if (replay->print)
+        print_fix (msg);
+}
+
+static void usage (const char *program)
+{
+    fprintf (stderr, "usage: %s [--print] [--realtime | --speed N] [--threads N [--chunk BYTES]] FILE\n", program);
+}
+
+int main (int argc, char **argv)
+{
+    const char *path = NULL;
+    replay_t replay = { .pacer = { .speed = 0, .log_ms = 0, .last_time_ms = -1 } };
+    gps_log_parallel_config_t parallel = { .callback = replay_sentence, .user_ctx = &replay };
+    int threaded = 0;
+
+    for (int i = 1; i < argc; i++){
+        if (strcmp (argv[i], "--print") == 0)
+            replay.print = 1;
+        else if (strcmp (argv[i], "--realtime") == 0)
+            replay.pacer.speed = 1;
+        else if (strcmp (argv[i], "--speed") == 0 && i + 1 < argc)
+            replay.pacer.speed = strtod (argv[++i], NULL);
+        else if (strcmp (argv[i], "--threads") == 0 && i + 1 < argc){
+            threaded = 1;
+            parallel.threads = strtoul (argv[++i], NULL, 10);     // 0: one per CPU
+        }
+        else if (strcmp (argv[i], "--chunk") == 0 && i + 1 < argc)
+            parallel.chunk_size = strtoul (argv[++i], NULL, 10);
+        else if (argv[i][0] != '-' && path == NULL)
+            path = argv[i];
+        else{
+            usage (argv[0]);
+            return 2;
+        }
+    }
+    if (path == NULL){
+        usage (argv[0]);
+        return 2;
+    }
+
+    int fd = open (path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat (fd, &st) != 0){
+        perror (path);
+        return 1;
+    }
+    size_t length = (size_t) st.st_size;
+    const char *log = NULL;
+    if (length > 0){
+        log = mmap (NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (log == MAP_FAILED){
+            perror ("mmap");
+            return 1;
+        }
+        posix_madvise ((void *) log, length, POSIX_MADV_SEQUENTIAL);
+    }
+
+    gps_parser_ctx_t ctx;
+    gps_nmea_msg_t msg;
+    size_t offset = 0;
+    struct timespec start;
+
+    gps_parser_init (&ctx);
+    clock_gettime (CLOCK_MONOTONIC, &start);
+
+    if (threaded){
+        if (gps_log_parse_parallel (&parallel, log, length, NULL, &offset) != 0){
+            fprintf (stderr, "%s: out of threads or memory\n", path);
+            return 1;
+        }
+    }
+    else{
+        for (;;){
+            gps_parse_result_t result = gps_nmea_parse_next (&ctx, log, length, &offset, &msg);
+            if (result == GPS_PARSE_INCOMPLETE)
+                break;
+            replay_sentence (result, &msg, &replay);
+        }
+    }
+
+    double elapsed = seconds_since (&start);
+    uint64_t sentences = 0;
+    for (int i = 0; i < RESULT_COUNT; i++)
+        sentences += replay.results[i];
+
+    fflush (stdout);
+    fprintf (stderr, "%s: %zu bytes, %llu sentences in %.3f s\n", path, length, (unsigned long long) sentences, elapsed);
+    if (elapsed > 0)
+        fprintf (stderr, "throughput: %.1f MB/s, %.0f sentences/s\n", (double) length / elapsed / 1e6, (double) sentences / elapsed);
+    for (int i = RESULT_COUNT - 1; i >= 0; i--)
+        fprintf (stderr, "  %-14s %llu\n", s_result_names[i], (unsigned long long) replay.results[i]);
+    for (int i = 1; i < GPS_SENTENCE_TYPE_COUNT; i++)
+        fprintf (stderr, "  %-14s %llu\n", s_type_names[i], (unsigned long long) replay.types[i]);
+    if (offset < length)
+        fprintf (stderr, "  %zu trailing bytes of an incomplete sentence\n", length - offset);
+
+    if (log != NULL)
+        munmap ((void *) log, length);
+    close (fd);
+    return 0;
+}
@@ -0,0 +1,476 @@
+/**
+ * @file gps_parser_bench.c
+ * @brief Host microbenchmark of the GPS data parser and its helpers.
+ *
+ * Every case runs one function over every item of a corpus (whole UART streams for the
+ * parsers, single sentences or fields for the helpers) and is repeated until it has run
+ * for at least the minimum time. Heap allocations made while timing are counted by
+ * wrapping malloc, calloc and realloc at link time (see CMakeLists.txt).
+ *
+ * Usage: gps_parser_bench [--quick] [--csv] [--min-time MS] [--filter TEXT]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gps_data_parser.h"
+#include "gps_geo.h"
+#include "gps_geofence.h"
+#include "gps_gga_view.h"
+#include "gps_nmea_scan.h"
+#include "gps_nmea_sentence.h"
+#include "gps_nmea_stream.h"
+
+//====================================================================================================================================================================================================================================================================
+//                         Heap allocation counting (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc)
+//====================================================================================================================================================================================================================================================================
+
+static uint64_t s_allocations;
+
+void *__real_malloc (size_t size);
+void *__real_calloc (size_t count, size_t size);
+void *__real_realloc (void *ptr, size_t size);
+
+void *__wrap_malloc (size_t size)
+{
+    s_allocations++;
+    return __real_malloc (size);
+}
+
+void *__wrap_calloc (size_t count, size_t size)
+{
+    s_allocations++;
+    return __real_calloc (count, size);
+}
+
+void *__wrap_realloc (void *ptr, size_t size)
+{
+    s_allocations++;
+    return __real_realloc (ptr, size);
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Corpora
+//====================================================================================================================================================================================================================================================================
+
+// Complete, valid streams (stream2 and stream4 of main/main.c and other talkers)
+static const char *s_clean[] = {
+    "$GPGGA,002153.000,1585.7149,N,07737.2052,E,1,4,5.57,333.2,M,-88.5,M,,*70\r\n",
+    "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43\r\n$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n",
+    "$GPGGA,123456.257,2358.5623,N,12345.6719,E,1,08,1.0,120.83,M,0.0,M,18,934*6B\r\n",
+    "$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*6B\r\n",
+};
+
+// Valid framing and checksum, fields missing (stream1 and stream6-9)
+static const char *s_partial[] = {
+    "$GPGGA,,,,13258.3334,W,,8,1.03,,M,,M,,*31\r\n",
+    "$GPGGA,,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,3,123*62\r\n",
+    "$GPGGA,,,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*46\r\n",
+    "$GPGGA,,,N,,W,1,8,1.03,61.7,M,55.2,M,,*58\r\n",
+    "$GPGGA,,,N,,W,1,8,1.03,,M,55.2,M,,*46\r\n",
+};
+
+// Noise, corrupted fields, bad checksums and NULL (stream3, stream5 and stream10-12)
+static const char *s_corrupted[] = {
+    NULL,
+    ",09275,,,,,,,,,,ewrwer,sdfvzx,453453635,41,,,A*43\r\n$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75\r\n  $GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n$GPGSV,AIZAZ UABID HASHMI   59,290,20,08,54$GPGSV,3,2,11,02,39,223,16,13,28,070,17,26,SDFJDSNFJ23,252,,04,1SDJFNASJDKFSDJHDS4,186,15*77\r\n $GPGSV,3,3,11,29,09,3JDSAFNJKDASFDSC01,24,16,09,020,,36,,,*76\r\n",
+    "$GPGGA,123456.235,aaaa1as7,N,,W,1,8,1.03,61.7,M,55.2,M,,*51\r\n",
+    ",,,$$%%&^*(*(@,,,,4531313372,W,0.02,31.66,280511,,,A*43\r\n$GPGGA,065551.680,5321.6802,S,00630.3371,E,1,85,,,,554.3,M,,*30\r\n$GPGSA,A,3,10,07,05##(())(,1.38*0A\r%^&*()_+n$GPGSV,,./??3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30*70\r",
+    "$GPGGA,abcdefgh,,N,12345.67,E,1,08,1.0,10.0,M,0.0,M,18,ABC*09\r\n",
+};
+
+// One second of receiver output with every supported sentence type
+static const char *s_epoch[] = {
+    "$GNRMC,092751.000,A,5321.6802,N,00630.3371,W,0.02,31.66,280511,,,A*5F\r\n"
+    "$GNVTG,31.66,T,,M,0.02,N,0.04,K,A*17\r\n"
+    "$GNGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*6B\r\n"
+    "$GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*14\r\n"
+    "$GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30*70\r\n"
+    "$GPGSV,3,2,11,02,39,223,19,13,28,070,17,26,23,252,,04,14,186,14*79\r\n"
+    "$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76\r\n"
+    "$GNGLL,5321.6802,N,00630.3371,W,092751.000,A,A*57\r\n",
+};
+
+// Sentences without CRLF, as passed to check_sum_evaluation() and the stream callback
+static const char *s_sentences[] = {
+    "$GPGGA,002153.000,1585.7149,N,07737.2052,E,1,4,5.57,333.2,M,-88.5,M,,*70",
+    "$GPGGA,092751.000,5321.6802,N,00630.3371,W,1,8,1.03,61.7,M,55.3,M,,*75",
+    "$GPGGA,123456.257,2358.5623,N,12345.6719,E,1,08,1.0,120.83,M,0.0,M,18,934*6B",
+    "$GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30*70",
+};
+
+// One op of the geodesic cases is one pass over a 1024-fix track, the item only names it
+#define TRACK_FIXES 1024
+static const char *s_track[] = { "1024 fixes" };
+// One op of the geofence cases is the same track against the number of fences in the item
+static const char *s_fences_few[] = { "100" };
+static const char *s_fences_many[] = { "5000" };
+
+static const char *s_times[] = { "092751.000", "123456.257", "002153.00", "", "abcdefgh", "25:61:99" };
+static const char *s_latitudes[] = { "5321.6802", "2358.5623", "1585.7149", "", "aaaa1as7", "9634.1004" };
+static const char *s_longitudes[] = { "00630.3371", "12345.6719", "07737.2052", "", "12345.67", "19634.1525" };
+static const char *s_numbers[] = { "1.03", "61.7", "-88.5", "", "ABC", "120.83" };
+
+//====================================================================================================================================================================================================================================================================
+//                         Benchmarked operations, one call per corpus item
+//====================================================================================================================================================================================================================================================================
+
+static volatile int32_t s_sink;     // keeps results alive so calls are not optimised out
+static gps_parser_ctx_t s_ctx;
+static gps_nmea_stream_t s_stream;
+static gps_nmea_msg_t s_msgs[16];
+
+static void bench_gps_data_parser (const char *item)
+{
+    gps_data_parse_t *data = gps_data_parser (item);
+    s_sink += data->num_satellites;
+    free (data);
+}
+
+static void bench_gps_data_parse (const char *item)
+{
+    gps_data_parse_t data;
+    s_sink += gps_data_parse (&s_ctx, item, &data);
+}
+
+static void bench_gps_data_parse_fixed_point (const char *item)
+{
+    gps_data_parse_t data;
+    s_ctx.decode_flags = GPS_DECODE_FIXED_POINT;
+    s_sink += gps_data_parse (&s_ctx, item, &data);
+    s_ctx.decode_flags = GPS_DECODE_FLOAT;
+}
+
+static void bench_gps_data_parse_position (const char *item)
+{
+    gps_data_parse_t data;
+    s_ctx.gga_fields = GPS_GGA_FIELD_LATITUDE | GPS_GGA_FIELD_LONGITUDE;
+    s_sink += gps_data_parse (&s_ctx, item, &data);
+    s_ctx.gga_fields = GPS_GGA_FIELD_ALL;
+}
+
+static void bench_gps_nmea_parse_batch (const char *item)
+{
+    if (item != NULL)
+        s_sink += (int32_t) gps_nmea_parse_batch (&s_ctx, item, strlen (item), s_msgs, 16, NULL);
+}
+
+static void stream_sink (const char *sentence, size_t length, void *user_ctx)
+{
+    (void) user_ctx;
+    s_sink += (int32_t) length + sentence[1];
+}
+
+static void bench_gps_nmea_stream_feed (const char *item)
+{
+    if (item != NULL)
+        s_sink += (int32_t) gps_nmea_stream_feed (&s_stream, item, strlen (item));
+}
+
+static void bench_gps_gga_sentence_parse (const char *item)
+{
+    gps_data_parse_t data;
+    s_sink += gps_gga_sentence_parse (&s_ctx, item, strlen (item), &data);
+}
+
+// What a position-only consumer reads: latitude, longitude and fix quality
+static void bench_gps_gga_view_position (const char *item)
+{
+    gps_gga_view_t view;
+    if (gps_gga_view_init (&view, item, strlen (item)) == GPS_PARSE_OK)
+        s_sink += (int32_t) gps_gga_view_latitude (&view) + (int32_t) gps_gga_view_longitude (&view) + gps_gga_view_fix_quality (&view);
+}
+
+static float s_track_latitude[TRACK_FIXES], s_track_longitude[TRACK_FIXES], s_track_out[TRACK_FIXES];
+
+// A wandering 1 Hz track, built on first use
+static const float * track_latitude (void)
+{
+    if (s_track_latitude[0] == 0){
+        for (int i = 0; i < TRACK_FIXES; i++){
+            s_track_latitude[i] = 53.36f + 0.0001f * (float) i + 0.00002f * (float) (i % 7);
+            s_track_longitude[i] = -6.5f + 0.00015f * (float) i - 0.00003f * (float) (i % 5);
+        }
+    }
+    return s_track_latitude;
+}
+
+static void bench_gps_geo_track_segments (const char *item)
+{
+    (void) item;
+    gps_geo_track_t track = { track_latitude (), s_track_longitude, NULL, TRACK_FIXES };
+    gps_geo_track_segments (&track, s_track_out);
+    s_sink += (int32_t) s_track_out[TRACK_FIXES / 2];
+}
+
+static void bench_gps_geo_track_bearings (const char *item)
+{
+    (void) item;
+    gps_geo_track_t track = { track_latitude (), s_track_longitude, NULL, TRACK_FIXES };
+    gps_geo_track_bearings (&track, s_track_out);
+    s_sink += (int32_t) s_track_out[TRACK_FIXES / 2];
+}
+
+#define MAX_FENCES 5000
+static gps_geofence_point_t s_fence_squares[MAX_FENCES][4];
+static uint8_t s_fence_storage[2][GPS_GEOFENCE_STORAGE_SIZE (MAX_FENCES)];
+static gps_geofence_t s_geofences[2];
+
+// Squares and circles of 20 to 200 m spread over the track area, built on first use
+static gps_geofence_t * bench_geofence (int fences)
+{
+    gps_geofence_t *geofence = &s_geofences[fences > 100];
+    uint32_t random = 1;
+
+    if (geofence->built)
+        return geofence;
+    gps_geofence_init (geofence, s_fence_storage[fences > 100], sizeof (s_fence_storage[0]), (size_t) fences, NULL, NULL);
+    for (int i = 0; i < fences; i++){
+        random = random * 1664525u + 1013904223u;
+        int32_t latitude = 533600000 + (int32_t) ((random >> 8) % 1100000);
+        random = random * 1664525u + 1013904223u;
+        int32_t longitude = -65000000 + (int32_t) ((random >> 8) % 1600000);
+        int32_t size = 2000 + (int32_t) ((random >> 8) % 18000);
+        if (i % 2 == 0){
+            gps_geofence_add_circle (geofence, latitude, longitude, (float) size * 0.01f);
+            continue;
+        }
+        s_fence_squares[i][0] = (gps_geofence_point_t) { latitude, longitude };
+        s_fence_squares[i][1] = (gps_geofence_point_t) { latitude, longitude + size };
+        s_fence_squares[i][2] = (gps_geofence_point_t) { latitude + size, longitude + size };
+        s_fence_squares[i][3] = (gps_geofence_point_t) { latitude + size, longitude };
+        gps_geofence_add_polygon (geofence, s_fence_squares[i], 4);
+    }
+    gps_geofence_build (geofence);
+    return geofence;
+}
+
+static void bench_gps_geofence_update (const char *item)
+{
+    gps_geofence_t *geofence = bench_geofence (atoi (item));
+    const float *latitude = track_latitude ();
+    gps_data_parse_t fix = { 0 };
+
+    for (int i = 0; i < TRACK_FIXES; i++){
+        fix.latitude_e7 = (int32_t) (latitude[i] * 1e7f);
+        fix.longitude_e7 = (int32_t) (s_track_longitude[i] * 1e7f);
+        s_sink += gps_geofence_update (geofence, &fix);
+    }
+}
+
+// The scalar double precision haversine the kernels replace
+static void bench_libm_haversine (const char *item)
+{
+    (void) item;
+    const float *latitude = track_latitude ();
+    for (int i = 0; i + 1 < TRACK_FIXES; i++){
+        double half_latitude = (latitude[i + 1] - latitude[i]) * (3.14159265358979 / 360);
+        double half_longitude = (s_track_longitude[i + 1] - s_track_longitude[i]) * (3.14159265358979 / 360);
+        double a = sin (half_latitude) * sin (half_latitude)
+                 + cos (latitude[i] * (3.14159265358979 / 180)) * cos (latitude[i + 1] * (3.14159265358979 / 180)) * sin (half_longitude) * sin (half_longitude);
+        s_track_out[i] = (float) (2 * GPS_GEO_EARTH_RADIUS * asin (sqrt (a)));
+    }
+    s_sink += (int32_t) s_track_out[TRACK_FIXES / 2];
+}
+
+static void bench_gga_sentence_format_validity_check (const char *item)
+{
+    if (item != NULL)
+        s_sink += gga_sentence_format_validity_check_public (item);
+}
+
+static void bench_check_stream_NULL_Empty (const char *item)
+{
+    s_sink += check_stream_NULL_Empty_public (item);
+}
+
+static void bench_check_sum_evaluation (const char *item)
+{
+    s_sink += check_sum_evaluation_public (item);
+}
+
+static void bench_gps_nmea_scan_checksum (const char *item)
+{
+    uint8_t checksum;
+    s_sink += (int32_t) gps_nmea_scan_checksum (item + 1, strlen (item) - 1, &checksum) + checksum;
+}
+
+static void bench_is_valid_time (const char *item)
+{
+    s_sink += is_valid_time_public (item);
+}
+
+static void bench_is_valid_numeric_latitude (const char *item)
+{
+    s_sink += is_valid_numeric_public (item, 4);
+}
+
+static void bench_is_valid_numeric_longitude (const char *item)
+{
+    s_sink += is_valid_numeric_public (item, 5);
+}
+
+static void bench_is_valid_number (const char *item)
+{
+    s_sink += is_valid_number_public (item);
+}
+
+static void bench_longitude_latitude_parser (const char *item)
+{
+    s_sink += (int32_t) longitude_latitude_parser_public (item);
+}
+
+static void bench_longitude_latitude_fixed_point_parser (const char *item)
+{
+    s_sink += longitude_latitude_fixed_point_parser_public (item);
+}
+
+static void bench_decimal_fixed_point_parser (const char *item)
+{
+    int32_t value = 0;
+    s_sink += decimal_fixed_point_parser_public (item, 3, 1, &value) + value;
+}
+
+//====================================================================================================================================================================================================================================================================
+//                         Driver
+//====================================================================================================================================================================================================================================================================
+
+#define CORPUS(items)   items, sizeof (items) / sizeof ((items)[0])
+
+typedef struct {
+    const char *name;
+    const char *corpus;
+    void (*run) (const char *item);
+    const char * const *items;
+    size_t count;
+} bench_case_t;
+
+static const bench_case_t s_cases[] = {
+    { "gps_data_parser", "clean", bench_gps_data_parser, CORPUS (s_clean) },
+    { "gps_data_parser", "partial", bench_gps_data_parser, CORPUS (s_partial) },
+    { "gps_data_parser", "corrupted", bench_gps_data_parser, CORPUS (s_corrupted) },
+    { "gps_data_parse", "clean", bench_gps_data_parse, CORPUS (s_clean) },
+    { "gps_data_parse", "partial", bench_gps_data_parse, CORPUS (s_partial) },
+    { "gps_data_parse", "corrupted", bench_gps_data_parse, CORPUS (s_corrupted) },
+    { "gps_data_parse/fixed_point", "clean", bench_gps_data_parse_fixed_point, CORPUS (s_clean) },
+    { "gps_data_parse/position", "clean", bench_gps_data_parse_position, CORPUS (s_clean) },
+    { "gps_nmea_parse_batch", "epoch", bench_gps_nmea_parse_batch, CORPUS (s_epoch) },
+    { "gps_nmea_parse_batch", "corrupted", bench_gps_nmea_parse_batch, CORPUS (s_corrupted) },
+    { "gps_nmea_stream_feed", "epoch", bench_gps_nmea_stream_feed, CORPUS (s_epoch) },
+    { "gps_nmea_stream_feed", "corrupted", bench_gps_nmea_stream_feed, CORPUS (s_corrupted) },
+    { "gps_gga_sentence_parse", "sentences", bench_gps_gga_sentence_parse, CORPUS (s_sentences) },
+    { "gps_gga_view/position", "sentences", bench_gps_gga_view_position, CORPUS (s_sentences) },
+    { "gps_geo_track_segments", "track", bench_gps_geo_track_segments, CORPUS (s_track) },
+    { "gps_geo_track_bearings", "track", bench_gps_geo_track_bearings, CORPUS (s_track) },
+    { "gps_geofence_update", "fences100", bench_gps_geofence_update, CORPUS (s_fences_few) },
+    { "gps_geofence_update", "fences5000", bench_gps_geofence_update, CORPUS (s_fences_many) },
+    { "libm_haversine", "track", bench_libm_haversine, CORPUS (s_track) },
+    { "gga_sentence_format_validity_check", "clean", bench_gga_sentence_format_validity_check, CORPUS (s_clean) },
+    { "gga_sentence_format_validity_check", "corrupted", bench_gga_sentence_format_validity_check, CORPUS (s_corrupted) },
+    { "check_stream_NULL_Empty", "corrupted", bench_check_stream_NULL_Empty, CORPUS (s_corrupted) },
+    { "check_sum_evaluation", "sentences", bench_check_sum_evaluation, CORPUS (s_sentences) },
+    { "gps_nmea_scan_checksum", "sentences", bench_gps_nmea_scan_checksum, CORPUS (s_sentences) },
+    { "is_valid_time", "times", bench_is_valid_time, CORPUS (s_times) },
+    { "is_valid_numeric/latitude", "latitudes", bench_is_valid_numeric_latitude, CORPUS (s_latitudes) },
+    { "is_valid_numeric/longitude", "longitudes", bench_is_valid_numeric_longitude, CORPUS (s_longitudes) },
+    { "is_valid_number", "numbers", bench_is_valid_number, CORPUS (s_numbers) },
+    { "longitude_latitude_parser", "latitudes", bench_longitude_latitude_parser, s_latitudes, 3 },   // valid inputs only
+    { "longitude_latitude_fixed_point_parser", "latitudes", bench_longitude_latitude_fixed_point_parser, s_latitudes, 3 },
+    { "decimal_fixed_point_parser", "numbers", bench_decimal_fixed_point_parser, CORPUS (s_numbers) },
+};
+
+static uint64_t now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Runs a case for at least min_time_ns and prints one result line
+static void run_case (const bench_case_t *c, uint64_t min_time_ns, int csv)
+{
+    size_t bytes_per_pass = 0;
+    for (size_t i = 0; i < c->count; i++)
+        bytes_per_pass += (c->items[i] != NULL) ? strlen (c->items[i]) : 0;
+
+    uint64_t passes = 1;
+    uint64_t elapsed = 0;
+    uint64_t allocations = 0;
+    for (;;){
+        gps_parser_init (&s_ctx);
+        gps_nmea_stream_init (&s_stream, stream_sink, NULL);
+
+        uint64_t allocations_before = s_allocations;
+        uint64_t start = now_ns ();
+        for (uint64_t p = 0; p < passes; p++){
+            for (size_t i = 0; i < c->count; i++)
+                c->run (c->items[i]);
+        }
+        elapsed = now_ns () - start;
+        allocations = s_allocations - allocations_before;
+
+        if (elapsed >= min_time_ns || passes >= (UINT64_C (1) << 40))
+            break;
+        // aim slightly past the target from the measured rate, at least doubling
+        uint64_t estimate = (elapsed > 0) ? passes * min_time_ns / elapsed + passes / 8 : passes * 16;
+        passes = (estimate > 2 * passes) ? estimate : 2 * passes;
+    }
+
+    double ops = (double) passes * (double) c->count;
+    double seconds = (double) elapsed / 1e9;
+    double ns_per_op = (double) elapsed / ops;
+    double ops_per_s = ops / seconds;
+    double bytes_per_s = (double) passes * (double) bytes_per_pass / seconds;
+    double allocs_per_op = (double) allocations / ops;
+
+    if (csv)
+        printf ("%s,%s,%.1f,%.0f,%.0f,%.2f\n", c->name, c->corpus, ns_per_op, ops_per_s, bytes_per_s, allocs_per_op);
+    else
+        printf ("%-40s %-11s %10.1f %14.0f %14.0f %10.2f\n", c->name, c->corpus, ns_per_op, ops_per_s, bytes_per_s, allocs_per_op);
+}
+
+static void usage (const char *program)
+{
+    fprintf (stderr, "usage: %s [--quick] [--csv] [--min-time MS] [--filter TEXT]\n", program);
+}
+
+int main (int argc, char **argv)
+{
+    uint64_t min_time_ns = 300 * UINT64_C (1000000);
+    const char *filter = NULL;
+    int csv = 0;
+
+    for (int i = 1; i < argc; i++){
+        if (strcmp (argv[i], "--quick") == 0)
+            min_time_ns = 5 * UINT64_C (1000000);
+        else if (strcmp (argv[i], "--csv") == 0)
+            csv = 1;
+        else if (strcmp (argv[i], "--min-time") == 0 && i + 1 < argc)
+            min_time_ns = strtoull (argv[++i], NULL, 10) * UINT64_C (1000000);
+        else if (strcmp (argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else{
+            usage (argv[0]);
+            return 2;
+        }
+    }
+
+    // an op is one corpus item: a UART stream for the parsers, a sentence or a field for the helpers
+    if (csv)
+        printf ("benchmark,corpus,ns_per_op,ops_per_s,bytes_per_s,allocs_per_op\n");
+    else
+        printf ("%-40s %-11s %10s %14s %14s %10s\n", "benchmark", "corpus", "ns/op", "ops/s", "bytes/s", "allocs/op");
+
+    for (size_t i = 0; i < sizeof (s_cases) / sizeof (s_cases[0]); i++){
+        if (filter == NULL || strstr (s_cases[i].name, filter) != NULL)
+            run_case (&s_cases[i], min_time_ns, csv);
+    }
+
+    return 0;
+}